@@ -0,0 +1,568 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * AES-128/256 in CTR and GCM modes, encryption only.
+ *
+ * The portable code uses the usual 32-bit T-tables (computed on first use
+ * from the S-box) and 4-bit tables for GHASH. On x86 and x86-64, when the
+ * compiler knows about them, there are AES-NI and PCLMULQDQ versions; the
+ * caller decides whether to use them by passing AES_USE_* flags.
+ */
+
+#include <string.h>
+#include <aes.h>
+
+#if (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define AES_HAVE_X86_INTRINSICS
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#define AES_TARGET __attribute__((target("sse2,ssse3,aes,pclmul")))
+#endif
+
+#define GET_U32(p) (((guint32)(p)[0] << 24) | ((guint32)(p)[1] << 16) | \
+                    ((guint32)(p)[2] << 8) | ((guint32)(p)[3]))
+#define PUT_U32(p, v) do {		\
+    (p)[0] = (guchar)((v) >> 24);	\
+    (p)[1] = (guchar)((v) >> 16);	\
+    (p)[2] = (guchar)((v) >> 8);	\
+    (p)[3] = (guchar)(v);		\
+  } while (0)
+#define GET_U64(p) (((guint64)GET_U32(p) << 32) | GET_U32((p) + 4))
+#define PUT_U64(p, v) do {		\
+    PUT_U32((p), (guint32)((v) >> 32));	\
+    PUT_U32((p) + 4, (guint32)(v));	\
+  } while (0)
+
+static guchar sbox[256];
+static guint32 Te0[256], Te1[256], Te2[256], Te3[256];
+static gboolean tables_ready = FALSE;
+
+static guchar xtime(guchar x)
+{
+    return (guchar)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static void aes_tables_init(void)
+{
+    guchar p = 1, q = 1, s;
+    gint i;
+
+    if (tables_ready)
+        return;
+
+    /* walk the multiplicative group with generator 3 to build the S-box */
+    do {
+        p = p ^ xtime(p);
+
+        q ^= q << 1;
+        q ^= q << 2;
+        q ^= q << 4;
+        if (q & 0x80)
+            q ^= 0x09;
+
+        s = q ^ ((q << 1) | (q >> 7)) ^ ((q << 2) | (q >> 6)) ^
+            ((q << 3) | (q >> 5)) ^ ((q << 4) | (q >> 4));
+        sbox[p] = s ^ 0x63;
+    } while (p != 1);
+    sbox[0] = 0x63;
+
+    for (i = 0; i < 256; i++) {
+        guchar s1 = sbox[i], s2 = xtime(s1), s3 = s2 ^ s1;
+
+        Te0[i] = ((guint32)s2 << 24) | ((guint32)s1 << 16) |
+                 ((guint32)s1 << 8) | s3;
+        Te1[i] = (Te0[i] >> 8) | (Te0[i] << 24);
+        Te2[i] = (Te0[i] >> 16) | (Te0[i] << 16);
+        Te3[i] = (Te0[i] >> 24) | (Te0[i] << 8);
+    }
+
+    tables_ready = TRUE;
+}
+
+gint aes_get_supported_flags(void)
+{
+#ifdef AES_HAVE_X86_INTRINSICS
+    return AES_USE_AESNI | AES_USE_PCLMUL;
+#else
+    return 0;
+#endif
+}
+
+void aes_init(AES_CTX *ctx, const guchar *key, gint key_bits, gint flags)
+{
+    guint32 *rk = ctx->rk, temp, rcon = 1;
+    gint i, nk = key_bits / 32, total;
+
+    aes_tables_init();
+
+    ctx->rounds = nk + 6;
+    ctx->flags = flags & aes_get_supported_flags();
+    total = 4 * (ctx->rounds + 1);
+
+    for (i = 0; i < nk; i++)
+        rk[i] = GET_U32(key + 4 * i);
+
+    for (i = nk; i < total; i++) {
+        temp = rk[i - 1];
+
+        if (i % nk == 0) {
+            temp = ((guint32)sbox[(temp >> 16) & 0xff] << 24) |
+                   ((guint32)sbox[(temp >> 8) & 0xff] << 16) |
+                   ((guint32)sbox[temp & 0xff] << 8) |
+                   ((guint32)sbox[temp >> 24]);
+            temp ^= rcon << 24;
+            rcon = xtime(rcon);
+        } else if (nk > 6 && i % nk == 4) {
+            temp = ((guint32)sbox[temp >> 24] << 24) |
+                   ((guint32)sbox[(temp >> 16) & 0xff] << 16) |
+                   ((guint32)sbox[(temp >> 8) & 0xff] << 8) |
+                   ((guint32)sbox[temp & 0xff]);
+        }
+
+        rk[i] = rk[i - nk] ^ temp;
+    }
+
+    for (i = 0; i < total; i++)
+        PUT_U32(&ctx->rk_bytes[i / 4][4 * (i % 4)], rk[i]);
+}
+
+static void aes_encrypt_block_tables(AES_CTX *ctx, const guchar in[16],
+                                     guchar out[16])
+{
+    const guint32 *rk = ctx->rk;
+    guint32 s0, s1, s2, s3, t0, t1, t2, t3;
+    gint r;
+
+    s0 = GET_U32(in) ^ rk[0];
+    s1 = GET_U32(in + 4) ^ rk[1];
+    s2 = GET_U32(in + 8) ^ rk[2];
+    s3 = GET_U32(in + 12) ^ rk[3];
+
+    for (r = 1; r < ctx->rounds; r++) {
+        rk += 4;
+        t0 = Te0[s0 >> 24] ^ Te1[(s1 >> 16) & 0xff] ^
+             Te2[(s2 >> 8) & 0xff] ^ Te3[s3 & 0xff] ^ rk[0];
+        t1 = Te0[s1 >> 24] ^ Te1[(s2 >> 16) & 0xff] ^
+             Te2[(s3 >> 8) & 0xff] ^ Te3[s0 & 0xff] ^ rk[1];
+        t2 = Te0[s2 >> 24] ^ Te1[(s3 >> 16) & 0xff] ^
+             Te2[(s0 >> 8) & 0xff] ^ Te3[s1 & 0xff] ^ rk[2];
+        t3 = Te0[s3 >> 24] ^ Te1[(s0 >> 16) & 0xff] ^
+             Te2[(s1 >> 8) & 0xff] ^ Te3[s2 & 0xff] ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    rk += 4;
+    t0 = ((guint32)sbox[s0 >> 24] << 24) ^ ((guint32)sbox[(s1 >> 16) & 0xff] << 16) ^
+         ((guint32)sbox[(s2 >> 8) & 0xff] << 8) ^ sbox[s3 & 0xff] ^ rk[0];
+    t1 = ((guint32)sbox[s1 >> 24] << 24) ^ ((guint32)sbox[(s2 >> 16) & 0xff] << 16) ^
+         ((guint32)sbox[(s3 >> 8) & 0xff] << 8) ^ sbox[s0 & 0xff] ^ rk[1];
+    t2 = ((guint32)sbox[s2 >> 24] << 24) ^ ((guint32)sbox[(s3 >> 16) & 0xff] << 16) ^
+         ((guint32)sbox[(s0 >> 8) & 0xff] << 8) ^ sbox[s1 & 0xff] ^ rk[2];
+    t3 = ((guint32)sbox[s3 >> 24] << 24) ^ ((guint32)sbox[(s0 >> 16) & 0xff] << 16) ^
+         ((guint32)sbox[(s1 >> 8) & 0xff] << 8) ^ sbox[s2 & 0xff] ^ rk[3];
+
+    PUT_U32(out, t0);
+    PUT_U32(out + 4, t1);
+    PUT_U32(out + 8, t2);
+    PUT_U32(out + 12, t3);
+}
+
+/* big-endian increment of the last 32 bits, as in GCM's inc32() */
+static void ctr_increment(guchar counter[16])
+{
+    gint i;
+
+    for (i = 15; i >= 12; i--) {
+        if (++counter[i])
+            break;
+    }
+}
+
+static void aes_ctr_crypt_tables(AES_CTX *ctx, guchar counter[16],
+                                 const guchar *in, guchar *out, gsize len)
+{
+    guchar keystream[16];
+    gsize i, n;
+
+    while (len > 0) {
+        aes_encrypt_block_tables(ctx, counter, keystream);
+        ctr_increment(counter);
+
+        n = len < 16 ? len : 16;
+        for (i = 0; i < n; i++)
+            out[i] = in[i] ^ keystream[i];
+
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+#ifdef AES_HAVE_X86_INTRINSICS
+static AES_TARGET __m128i aesni_encrypt(AES_CTX *ctx, __m128i block)
+{
+    const __m128i *rk = (const __m128i *) ctx->rk_bytes;
+    gint r;
+
+    block = _mm_xor_si128(block, _mm_loadu_si128(&rk[0]));
+    for (r = 1; r < ctx->rounds; r++)
+        block = _mm_aesenc_si128(block, _mm_loadu_si128(&rk[r]));
+
+    return _mm_aesenclast_si128(block, _mm_loadu_si128(&rk[ctx->rounds]));
+}
+
+static AES_TARGET void aes_encrypt_block_aesni(AES_CTX *ctx,
+                                               const guchar in[16],
+                                               guchar out[16])
+{
+    __m128i block = _mm_loadu_si128((const __m128i *) in);
+
+    _mm_storeu_si128((__m128i *) out, aesni_encrypt(ctx, block));
+}
+
+static AES_TARGET void aes_ctr_crypt_aesni(AES_CTX *ctx, guchar counter[16],
+                                           const guchar *in, guchar *out,
+                                           gsize len)
+{
+    const __m128i *rk = (const __m128i *) ctx->rk_bytes;
+    __m128i ctr, b0, b1, b2, b3, k;
+    guchar keystream[16];
+    gsize i, n;
+    gint r;
+
+    /* four blocks at a time keeps the AES unit busy */
+    while (len >= 64) {
+        ctr = _mm_loadu_si128((const __m128i *) counter);
+        b0 = ctr;
+        ctr_increment(counter);
+        b1 = _mm_loadu_si128((const __m128i *) counter);
+        ctr_increment(counter);
+        b2 = _mm_loadu_si128((const __m128i *) counter);
+        ctr_increment(counter);
+        b3 = _mm_loadu_si128((const __m128i *) counter);
+        ctr_increment(counter);
+
+        k = _mm_loadu_si128(&rk[0]);
+        b0 = _mm_xor_si128(b0, k);
+        b1 = _mm_xor_si128(b1, k);
+        b2 = _mm_xor_si128(b2, k);
+        b3 = _mm_xor_si128(b3, k);
+        for (r = 1; r < ctx->rounds; r++) {
+            k = _mm_loadu_si128(&rk[r]);
+            b0 = _mm_aesenc_si128(b0, k);
+            b1 = _mm_aesenc_si128(b1, k);
+            b2 = _mm_aesenc_si128(b2, k);
+            b3 = _mm_aesenc_si128(b3, k);
+        }
+        k = _mm_loadu_si128(&rk[ctx->rounds]);
+        b0 = _mm_aesenclast_si128(b0, k);
+        b1 = _mm_aesenclast_si128(b1, k);
+        b2 = _mm_aesenclast_si128(b2, k);
+        b3 = _mm_aesenclast_si128(b3, k);
+
+        _mm_storeu_si128((__m128i *) out,
+                         _mm_xor_si128(b0, _mm_loadu_si128((const __m128i *) in)));
+        _mm_storeu_si128((__m128i *) (out + 16),
+                         _mm_xor_si128(b1, _mm_loadu_si128((const __m128i *) (in + 16))));
+        _mm_storeu_si128((__m128i *) (out + 32),
+                         _mm_xor_si128(b2, _mm_loadu_si128((const __m128i *) (in + 32))));
+        _mm_storeu_si128((__m128i *) (out + 48),
+                         _mm_xor_si128(b3, _mm_loadu_si128((const __m128i *) (in + 48))));
+
+        in += 64;
+        out += 64;
+        len -= 64;
+    }
+
+    while (len > 0) {
+        aes_encrypt_block_aesni(ctx, counter, keystream);
+        ctr_increment(counter);
+
+        n = len < 16 ? len : 16;
+        for (i = 0; i < n; i++)
+            out[i] = in[i] ^ keystream[i];
+
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+#endif	/* AES_HAVE_X86_INTRINSICS */
+
+void aes_encrypt_block(AES_CTX *ctx, const guchar in[16], guchar out[16])
+{
+#ifdef AES_HAVE_X86_INTRINSICS
+    if (ctx->flags & AES_USE_AESNI) {
+        aes_encrypt_block_aesni(ctx, in, out);
+        return;
+    }
+#endif
+
+    aes_encrypt_block_tables(ctx, in, out);
+}
+
+void aes_ctr_crypt(AES_CTX *ctx, guchar counter[16],
+                   const guchar *in, guchar *out, gsize len)
+{
+#ifdef AES_HAVE_X86_INTRINSICS
+    if (ctx->flags & AES_USE_AESNI) {
+        aes_ctr_crypt_aesni(ctx, counter, in, out, len);
+        return;
+    }
+#endif
+
+    aes_ctr_crypt_tables(ctx, counter, in, out, len);
+}
+
+/*
+ * GHASH, the portable way: Shoup's method with 4-bit tables.
+ */
+static const guint64 last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static void ghash_tables_init(AES_GCM_CTX *ctx)
+{
+    guint64 vh, vl;
+    gint i, j;
+
+    vh = GET_U64(ctx->H);
+    vl = GET_U64(ctx->H + 8);
+
+    ctx->HL[8] = vl;
+    ctx->HH[8] = vh;
+    ctx->HL[0] = ctx->HH[0] = 0;
+
+    for (i = 4; i > 0; i >>= 1) {
+        guint32 T = (guint32)(vl & 1) * 0xe1000000U;
+
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ ((guint64) T << 32);
+
+        ctx->HL[i] = vl;
+        ctx->HH[i] = vh;
+    }
+
+    for (i = 2; i <= 8; i *= 2) {
+        vh = ctx->HH[i];
+        vl = ctx->HL[i];
+
+        for (j = 1; j < i; j++) {
+            ctx->HH[i + j] = vh ^ ctx->HH[j];
+            ctx->HL[i + j] = vl ^ ctx->HL[j];
+        }
+    }
+}
+
+/* x = x * H */
+static void ghash_mult_tables(AES_GCM_CTX *ctx, guchar x[16])
+{
+    guint64 zh, zl;
+    guchar lo, hi, rem;
+    gint i;
+
+    lo = x[15] & 0xf;
+    zh = ctx->HH[lo];
+    zl = ctx->HL[lo];
+
+    for (i = 15; i >= 0; i--) {
+        lo = x[i] & 0xf;
+        hi = (x[i] >> 4) & 0xf;
+
+        if (i != 15) {
+            rem = (guchar)(zl & 0xf);
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (last4[rem] << 48);
+            zh ^= ctx->HH[lo];
+            zl ^= ctx->HL[lo];
+        }
+
+        rem = (guchar)(zl & 0xf);
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ (last4[rem] << 48);
+        zh ^= ctx->HH[hi];
+        zl ^= ctx->HL[hi];
+    }
+
+    PUT_U64(x, zh);
+    PUT_U64(x + 8, zl);
+}
+
+#ifdef AES_HAVE_X86_INTRINSICS
+/*
+ * Carry-less multiplication in GF(2^128), operands and result in
+ * reflected (byte-swapped) form; see Intel's "Carry-Less Multiplication
+ * and Its Usage for Computing the GCM Mode" white paper.
+ */
+static AES_TARGET __m128i ghash_clmul(__m128i a, __m128i b)
+{
+    __m128i t2, t3, t4, t5, t6, t7, t8, t9;
+
+    t3 = _mm_clmulepi64_si128(a, b, 0x00);
+    t4 = _mm_clmulepi64_si128(a, b, 0x10);
+    t5 = _mm_clmulepi64_si128(a, b, 0x01);
+    t6 = _mm_clmulepi64_si128(a, b, 0x11);
+
+    t4 = _mm_xor_si128(t4, t5);
+    t5 = _mm_slli_si128(t4, 8);
+    t4 = _mm_srli_si128(t4, 8);
+    t3 = _mm_xor_si128(t3, t5);
+    t6 = _mm_xor_si128(t6, t4);
+
+    /* shift the 256-bit product left by one bit */
+    t7 = _mm_srli_epi32(t3, 31);
+    t8 = _mm_srli_epi32(t6, 31);
+    t3 = _mm_slli_epi32(t3, 1);
+    t6 = _mm_slli_epi32(t6, 1);
+    t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    t3 = _mm_or_si128(t3, t7);
+    t6 = _mm_or_si128(t6, t8);
+    t6 = _mm_or_si128(t6, t9);
+
+    /* reduce modulo x^128 + x^7 + x^2 + x + 1 */
+    t7 = _mm_slli_epi32(t3, 31);
+    t8 = _mm_slli_epi32(t3, 30);
+    t9 = _mm_slli_epi32(t3, 25);
+    t7 = _mm_xor_si128(t7, t8);
+    t7 = _mm_xor_si128(t7, t9);
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    t3 = _mm_xor_si128(t3, t7);
+
+    t2 = _mm_srli_epi32(t3, 1);
+    t4 = _mm_srli_epi32(t3, 2);
+    t5 = _mm_srli_epi32(t3, 7);
+    t2 = _mm_xor_si128(t2, t4);
+    t2 = _mm_xor_si128(t2, t5);
+    t2 = _mm_xor_si128(t2, t8);
+    t3 = _mm_xor_si128(t3, t2);
+
+    return _mm_xor_si128(t6, t3);
+}
+
+static AES_TARGET void ghash_update_clmul(AES_GCM_CTX *ctx, guchar y[16],
+                                          const guchar *data, gsize len)
+{
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                       8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i h, x, d;
+    guchar block[16];
+
+    h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) ctx->H), bswap);
+    x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) y), bswap);
+
+    while (len > 0) {
+        if (len >= 16) {
+            d = _mm_loadu_si128((const __m128i *) data);
+            data += 16;
+            len -= 16;
+        } else {
+            memset(block, 0, sizeof(block));
+            memcpy(block, data, len);
+            d = _mm_loadu_si128((const __m128i *) block);
+            len = 0;
+        }
+
+        x = _mm_xor_si128(x, _mm_shuffle_epi8(d, bswap));
+        x = ghash_clmul(x, h);
+    }
+
+    _mm_storeu_si128((__m128i *) y, _mm_shuffle_epi8(x, bswap));
+}
+#endif	/* AES_HAVE_X86_INTRINSICS */
+
+/* y = (y ^ data) * H, for each (zero-padded) 16-byte block of data */
+static void ghash_update(AES_GCM_CTX *ctx, guchar y[16],
+                         const guchar *data, gsize len)
+{
+    gsize i, n;
+
+#ifdef AES_HAVE_X86_INTRINSICS
+    if (ctx->aes.flags & AES_USE_PCLMUL) {
+        ghash_update_clmul(ctx, y, data, len);
+        return;
+    }
+#endif
+
+    while (len > 0) {
+        n = len < 16 ? len : 16;
+        for (i = 0; i < n; i++)
+            y[i] ^= data[i];
+
+        ghash_mult_tables(ctx, y);
+
+        data += n;
+        len -= n;
+    }
+}
+
+void aes_gcm_init(AES_GCM_CTX *ctx, const guchar *key, gint key_bits,
+                  gint flags)
+{
+    guchar zero[16];
+
+    memset(zero, 0, sizeof(zero));
+
+    aes_init(&ctx->aes, key, key_bits, flags);
+    aes_encrypt_block(&ctx->aes, zero, ctx->H);
+    ghash_tables_init(ctx);
+}
+
+void aes_gcm_encrypt(AES_GCM_CTX *ctx,
+                     const guchar *iv, gsize iv_len,
+                     const guchar *aad, gsize aad_len,
+                     const guchar *in, guchar *out, gsize len,
+                     guchar tag[16])
+{
+    guchar j0[16], counter[16], y[16], lengths[16], ek_j0[16];
+    gint i;
+
+    memset(j0, 0, sizeof(j0));
+    if (iv_len == 12) {
+        memcpy(j0, iv, 12);
+        j0[15] = 1;
+    } else {
+        memset(lengths, 0, sizeof(lengths));
+        PUT_U64(lengths + 8, (guint64) iv_len * 8);
+
+        ghash_update(ctx, j0, iv, iv_len);
+        ghash_update(ctx, j0, lengths, 16);
+    }
+
+    memcpy(counter, j0, 16);
+    ctr_increment(counter);
+    aes_ctr_crypt(&ctx->aes, counter, in, out, len);
+
+    memset(y, 0, sizeof(y));
+    ghash_update(ctx, y, aad, aad_len);
+    ghash_update(ctx, y, out, len);
+
+    PUT_U64(lengths, (guint64) aad_len * 8);
+    PUT_U64(lengths + 8, (guint64) len * 8);
+    ghash_update(ctx, y, lengths, 16);
+
+    aes_encrypt_block(&ctx->aes, j0, ek_j0);
+    for (i = 0; i < 16; i++)
+        tag[i] = y[i] ^ ek_j0[i];
+}
@@ -0,0 +1,58 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __AES_H__
+#define __AES_H__
+
+#include <glib.h>
+
+/* flags for aes_init() and aes_gcm_init() */
+enum {
+    AES_USE_AESNI  = 1 << 0,
+    AES_USE_PCLMUL = 1 << 1
+};
+
+typedef struct {
+    guint32 rk[60];		/* expanded encryption key */
+    guchar  rk_bytes[15][16];	/* same, in the byte order AES-NI expects */
+    gint    rounds;
+    gint    flags;
+} AES_CTX;
+
+typedef struct {
+    AES_CTX aes;
+    guchar  H[16];		/* hash subkey, E(K, 0^128) */
+    guint64 HL[16], HH[16];	/* 4-bit multiplication tables for H */
+} AES_GCM_CTX;
+
+gint aes_get_supported_flags(void);
+
+void aes_init(AES_CTX *ctx, const guchar *key, gint key_bits, gint flags);
+void aes_encrypt_block(AES_CTX *ctx, const guchar in[16], guchar out[16]);
+void aes_ctr_crypt(AES_CTX *ctx, guchar counter[16],
+                   const guchar *in, guchar *out, gsize len);
+
+void aes_gcm_init(AES_GCM_CTX *ctx, const guchar *key, gint key_bits,
+                  gint flags);
+void aes_gcm_encrypt(AES_GCM_CTX *ctx,
+                     const guchar *iv, gsize iv_len,
+                     const guchar *aad, gsize aad_len,
+                     const guchar *in, guchar *out, gsize len,
+                     guchar tag[16]);
+
+#endif	/* __AES_H__ */
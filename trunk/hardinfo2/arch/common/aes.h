@@ -0,0 +1,301 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <aes.h>
+
+#define AES_BENCHMARK_BUFFER_SIZE	(1024 * 1024)
+
+typedef struct _AESBenchmark AESBenchmark;
+
+struct _AESBenchmark {
+    gint key_bits;
+    gboolean gcm;
+    gint flags;
+    gdouble duration;
+    gint buffers;
+};
+
+/* FIPS-197 C.1/C.3, SP 800-38A F.5.1/F.5.5, and GCM spec test cases 4/16 */
+static const struct {
+    gint key_bits;
+    gboolean gcm;
+    const gchar *key, *iv, *aad, *plaintext, *ciphertext, *tag;
+} aes_test_vectors[] = {
+    { 128, FALSE, "000102030405060708090a0b0c0d0e0f",
+      "00112233445566778899aabbccddeeff", NULL,
+      "00000000000000000000000000000000",
+      "69c4e0d86a7b0430d8cdb78070b4c55a", NULL },
+    { 256, FALSE,
+      "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+      "00112233445566778899aabbccddeeff", NULL,
+      "00000000000000000000000000000000",
+      "8ea2b7ca516745bfeafc49904b496089", NULL },
+    { 128, FALSE, "2b7e151628aed2a6abf7158809cf4f3c",
+      "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", NULL,
+      "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+      "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+      "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+      "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee",
+      NULL },
+    { 256, FALSE,
+      "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",
+      "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", NULL,
+      "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+      "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+      "601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+      "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6",
+      NULL },
+    { 128, TRUE, "feffe9928665731c6d6a8f9467308308",
+      "cafebabefacedbaddecaf888",
+      "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+      "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+      "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+      "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+      "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+      "5bc94fbc3221a5db94fae95ae7121a47" },
+    { 256, TRUE,
+      "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+      "cafebabefacedbaddecaf888",
+      "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+      "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+      "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+      "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+      "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+      "76fc6ece0f4e1768cddf8853bb2d551b" },
+};
+
+static gsize aes_hex_decode(const gchar * hex, guchar * out)
+{
+    gsize i, len = hex ? strlen(hex) / 2 : 0;
+
+    for (i = 0; i < len; i++)
+	out[i] = (g_ascii_xdigit_value(hex[2 * i]) << 4) |
+	    g_ascii_xdigit_value(hex[2 * i + 1]);
+
+    return len;
+}
+
+static gboolean aes_self_test(gint flags)
+{
+    guchar key[32], iv[16], aad[32], plaintext[64], expected[64],
+	output[64], tag[16], expected_tag[16];
+    gsize len, aad_len, iv_len;
+    gint i;
+
+    for (i = 0; i < G_N_ELEMENTS(aes_test_vectors); i++) {
+	aes_hex_decode(aes_test_vectors[i].key, key);
+	iv_len = aes_hex_decode(aes_test_vectors[i].iv, iv);
+	aad_len = aes_hex_decode(aes_test_vectors[i].aad, aad);
+	len = aes_hex_decode(aes_test_vectors[i].plaintext, plaintext);
+	aes_hex_decode(aes_test_vectors[i].ciphertext, expected);
+
+	if (aes_test_vectors[i].gcm) {
+	    AES_GCM_CTX ctx;
+
+	    aes_hex_decode(aes_test_vectors[i].tag, expected_tag);
+	    aes_gcm_init(&ctx, key, aes_test_vectors[i].key_bits, flags);
+	    aes_gcm_encrypt(&ctx, iv, iv_len, aad, aad_len, plaintext,
+			    output, len, tag);
+
+	    if (memcmp(tag, expected_tag, 16))
+		return FALSE;
+	} else {
+	    AES_CTX ctx;
+
+	    /* the FIPS-197 single-block vectors become CTR with a zero plaintext */
+	    aes_init(&ctx, key, aes_test_vectors[i].key_bits, flags);
+	    aes_ctr_crypt(&ctx, iv, plaintext, output, len);
+	}
+
+	if (memcmp(output, expected, len))
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void aes_benchmark_worker(gint thread_number, gpointer data)
+{
+    AESBenchmark *ab = (AESBenchmark *) data;
+    AES_CTX ctx;
+    AES_GCM_CTX gcm_ctx;
+    GTimer *timer;
+    guchar key[32], iv[16], tag[16], *buffer;
+    gint i, buffers = 0;
+
+    for (i = 0; i < sizeof(key); i++)
+	key[i] = (guchar) (i * 7 + thread_number);
+    memset(iv, 0, sizeof(iv));
+    iv[0] = (guchar) thread_number;
+
+    buffer = g_malloc(AES_BENCHMARK_BUFFER_SIZE);
+    for (i = 0; i < AES_BENCHMARK_BUFFER_SIZE; i++)
+	buffer[i] = (guchar) (i * 31);
+
+    if (ab->gcm)
+	aes_gcm_init(&gcm_ctx, key, ab->key_bits, ab->flags);
+    else
+	aes_init(&ctx, key, ab->key_bits, ab->flags);
+
+    timer = g_timer_new();
+    g_timer_start(timer);
+    while (g_timer_elapsed(timer, NULL) < ab->duration) {
+	if (ab->gcm)
+	    aes_gcm_encrypt(&gcm_ctx, iv, 12, NULL, 0, buffer, buffer,
+			    AES_BENCHMARK_BUFFER_SIZE, tag);
+	else
+	    aes_ctr_crypt(&ctx, iv, buffer, buffer,
+			  AES_BENCHMARK_BUFFER_SIZE);
+
+	buffers++;
+    }
+    g_timer_destroy(timer);
+    g_free(buffer);
+
+    g_atomic_int_add(&ab->buffers, buffers);
+}
+
+static gdouble aes_benchmark_run(gint n_threads, gint key_bits, gboolean gcm,
+				 gint flags)
+{
+    AESBenchmark ab;
+    gdouble elapsed;
+
+    ab.key_bits = key_bits;
+    ab.gcm = gcm;
+    ab.flags = flags;
+    ab.duration = 0.3;
+    ab.buffers = 0;
+
+    elapsed = benchmark_parallel(n_threads, aes_benchmark_worker, &ab);
+
+    if (elapsed < 0)
+	return -1;
+
+    /* the buffer is 1 MiB, so this is MiB/s */
+    return elapsed > 0 ? ab.buffers / elapsed : 0;
+}
+
+static gboolean aes_processor_has_flag(gchar ** flags, const gchar * flag)
+{
+    gint i;
+
+    for (i = 0; flags[i]; i++) {
+	if (g_str_equal(flags[i], flag))
+	    return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* what the processor advertises; the build may not support all of it */
+static gint aes_get_processor_flags(void)
+{
+    gchar *processor_flags, **flags;
+    gint hw_flags = 0;
+
+    processor_flags = module_call_method("devices::getProcessorFlags");
+    flags = g_strsplit(processor_flags ? processor_flags : "", " ", 0);
+    if (aes_processor_has_flag(flags, "aes"))
+	hw_flags |= AES_USE_AESNI;
+    if (aes_processor_has_flag(flags, "pclmulqdq"))
+	hw_flags |= AES_USE_PCLMUL;
+
+    g_strfreev(flags);
+    g_free(processor_flags);
+
+    return hw_flags;
+}
+
+static void
+benchmark_aes(void)
+{
+    static const gint key_sizes[] = { 128, 256 };
+    gchar *details;
+    gint hw_flags, n_impls, impl, n_threads, i, step = 0;
+    gboolean gcm;
+    gdouble result = 0;
+
+    shell_view_set_enabled(FALSE);
+    shell_status_update("Performing AES benchmark...");
+
+    n_threads = benchmark_get_n_threads();
+
+    /* the hardware path is only used if the processor says it can */
+    hw_flags = aes_get_processor_flags();
+
+    details = g_strdup_printf("[Hardware Acceleration]\n"
+			      "AES-NI=%s\n"
+			      "PCLMULQDQ=%s\n"
+			      "Compiled In=%s\n",
+			      (hw_flags & AES_USE_AESNI) ? "Advertised by the processor"
+			      : "Not advertised by the processor",
+			      (hw_flags & AES_USE_PCLMUL) ? "Advertised by the processor"
+			      : "Not advertised by the processor",
+			      aes_get_supported_flags() ? "Yes" : "No");
+
+    hw_flags &= aes_get_supported_flags();
+    n_impls = hw_flags ? 2 : 1;
+
+    for (impl = 0; impl < n_impls; impl++) {
+	gint impl_flags = impl ? hw_flags : 0;
+
+	details = h_strdup_cprintf("[%s]\n", details,
+				   impl ? "Hardware (AES-NI)" : "Portable (T-tables)");
+
+	if (!aes_self_test(impl_flags)) {
+	    details = h_strdup_cprintf("Test Vectors=Failed\n", details);
+	    step += 2 * G_N_ELEMENTS(key_sizes);
+	    continue;
+	}
+	details = h_strdup_cprintf("Test Vectors=Passed\n", details);
+
+	for (i = 0; i < G_N_ELEMENTS(key_sizes); i++) {
+	    for (gcm = FALSE; gcm <= TRUE; gcm++) {
+		gdouble single, all;
+
+		shell_status_set_percentage(100 * step++ /
+					    (n_impls * 2 * G_N_ELEMENTS(key_sizes)));
+
+		single = aes_benchmark_run(1, key_sizes[i], gcm, impl_flags);
+		all = aes_benchmark_run(n_threads, key_sizes[i], gcm, impl_flags);
+
+		if (single < 0 || all < 0) {
+		    details = h_strdup_cprintf("AES-%d-%s=Could not create "
+					       "threads\n", details,
+					       key_sizes[i], gcm ? "GCM" : "CTR");
+		    continue;
+		}
+
+		details = h_strdup_cprintf("AES-%d-%s=%.1f MiB/s (1 thread), "
+					   "%.1f MiB/s (%d threads)\n",
+					   details, key_sizes[i],
+					   gcm ? "GCM" : "CTR", single, all,
+					   n_threads);
+
+		/* headline: AES-128-GCM, one thread, fastest working path */
+		if (key_sizes[i] == 128 && gcm)
+		    result = single;
+	    }
+	}
+    }
+
+    benchmark_set_details("CPU AES", details);
+
+    bench_results[BENCHMARK_AES] = result;
+}
@@ -22,33 +22,31 @@ static void
 benchmark_fish(void)
 {
     BLOWFISH_CTX ctx;
-    GTimer *timer = g_timer_new();
+    GTimer *timer;
     gdouble elapsed = 0;
-    gchar src[65536], *tmpsrc;
+    Corpus *corpus;
     glong srclen = 65536;
     unsigned long L, R;
     int i;
 
-    tmpsrc = src;
-
     L = 0xBEBACAFE;
     R = 0xDEADBEEF;
 
-    gchar *bdata_path;
-    
-    bdata_path = g_build_filename(params.path_data, "benchmark.data", NULL);
-    if (!g_file_get_contents(bdata_path, &tmpsrc, NULL, NULL)) {
-        g_free(bdata_path);
+    corpus = corpus_get(CORPUS_FILE, 0, CORPUS_PREFAULT);
+    if (!corpus || corpus->size < srclen) {
+        corpus_release(corpus);
         return;
-    }     
-    
+    }
+
+    timer = g_timer_new();
+
     shell_view_set_enabled(FALSE);
     shell_status_update("Performing Blowfish benchmark...");
     
     for (i = 0; i <= 50000; i++) { 
         g_timer_start(timer);
 
-        Blowfish_Init(&ctx, (unsigned char*)tmpsrc, srclen);
+        Blowfish_Init(&ctx, (unsigned char*)corpus->data, srclen);
         Blowfish_Encrypt(&ctx, &L, &R);
         Blowfish_Decrypt(&ctx, &L, &R);
         
@@ -59,7 +57,7 @@ benchmark_fish(void)
     }
     
     g_timer_destroy(timer);
-    g_free(bdata_path);
+    corpus_release(corpus);
     
     bench_results[BENCHMARK_BLOWFISH] = elapsed;
 }
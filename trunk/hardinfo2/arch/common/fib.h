@@ -46,3 +46,129 @@ benchmark_fib(void)
     
     bench_results[BENCHMARK_FIB] = elapsed;
 }
+
+/*
+ * Task-parallel Fibonacci: every call above the cutoff spawns fib(n - 1)
+ * on the work-stealing pool and computes fib(n - 2) itself. A low cutoff
+ * makes the tasks tiny, so the run mostly measures spawn, steal and
+ * synchronisation overhead.
+ */
+
+#include <workpool.h>
+
+#define PFIB_N			42
+#define PFIB_RESULT		267914296UL
+#define PFIB_CUTOFF_COARSE	24
+#define PFIB_CUTOFF_FINE	12
+
+typedef struct _PFibTask PFibTask;
+
+struct _PFibTask {
+    gulong n, cutoff;
+    gulong result;
+};
+
+static void pfib_task(WorkPoolWorker * worker, gpointer data)
+{
+    PFibTask *task = (PFibTask *) data;
+    PFibTask left, right;
+    WorkPoolGroup group;
+
+    if (task->n <= task->cutoff) {
+	task->result = fib(task->n);
+	return;
+    }
+
+    left.n = task->n - 1;
+    left.cutoff = task->cutoff;
+    right.n = task->n - 2;
+    right.cutoff = task->cutoff;
+
+    work_pool_group_init(&group);
+    work_pool_spawn(worker, &group, pfib_task, &left);
+    pfib_task(worker, &right);
+    work_pool_sync(worker, &group);
+
+    task->result = left.result + right.result;
+}
+
+/* returns the elapsed time, or a negative number if the result is wrong */
+static gdouble pfib_run(gint n_threads, gulong cutoff,
+			guint64 * tasks, guint64 * steals)
+{
+    WorkPool *pool = work_pool_new(n_threads);
+    GTimer *timer = g_timer_new();
+    PFibTask task = { PFIB_N, cutoff, 0 };
+    gdouble elapsed;
+
+    g_timer_start(timer);
+    work_pool_run(pool, pfib_task, &task);
+    g_timer_stop(timer);
+    elapsed = g_timer_elapsed(timer, NULL);
+
+    *tasks = work_pool_get_tasks(pool);
+    *steals = work_pool_get_steals(pool);
+
+    g_timer_destroy(timer);
+    work_pool_free(pool);
+
+    return task.result == PFIB_RESULT ? elapsed : -1;
+}
+
+static void
+benchmark_pfib(void)
+{
+    static const gulong cutoffs[] = { PFIB_CUTOFF_COARSE, PFIB_CUTOFF_FINE };
+    gdouble single, all = 0;
+    guint64 tasks, steals;
+    gint n_threads, i;
+    gchar *details, *status;
+
+    shell_view_set_enabled(FALSE);
+
+    n_threads = benchmark_get_n_threads();
+    details = g_strdup_printf("[Configuration]\n"
+			      "Problem=fib(%d)\n"
+			      "Threads=%d\n", PFIB_N, n_threads);
+
+    for (i = 0; i < G_N_ELEMENTS(cutoffs); i++) {
+	status = g_strdup_printf("Calculating fib(%d), cutoff %lu, one thread...",
+				 PFIB_N, cutoffs[i]);
+	shell_status_update(status);
+	shell_status_set_percentage(50 * i);
+	g_free(status);
+
+	single = pfib_run(1, cutoffs[i], &tasks, &steals);
+
+	status = g_strdup_printf("Calculating fib(%d), cutoff %lu, %d threads...",
+				 PFIB_N, cutoffs[i], n_threads);
+	shell_status_update(status);
+	shell_status_set_percentage(50 * i + 25);
+	g_free(status);
+
+	all = pfib_run(n_threads, cutoffs[i], &tasks, &steals);
+
+	details = h_strdup_cprintf("[Cutoff at fib(%lu)]\n", details,
+				   cutoffs[i]);
+	if (single < 0 || all < 0) {
+	    details = h_strdup_cprintf("Result=Wrong\n", details);
+	    all = 0;
+	    continue;
+	}
+
+	details = h_strdup_cprintf("Single Thread=%.3f s\n"
+				   "All Cores=%.3f s\n"
+				   "Speedup=%.2fx\n"
+				   "Tasks=%" G_GUINT64_FORMAT "\n"
+				   "Steals=%" G_GUINT64_FORMAT "\n"
+				   "Steal Ratio=%.3f%%\n",
+				   details, single, all, single / all,
+				   tasks, steals,
+				   tasks ? 100.0 * steals / tasks : 0.0);
+    }
+
+    benchmark_set_details("CPU Fibonacci (Parallel)", details);
+
+    /* the score is the all-core time with fine-grained tasks */
+    bench_results[BENCHMARK_PFIB] = all;
+}
@@ -0,0 +1,354 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * The system's OpenSSL libcrypto against the bundled implementations,
+ * over the same input. The library is loaded at run time, like zlib, and
+ * only through the EVP interface, which is stable across versions.
+ */
+
+#define LIBCRYPTO_DURATION		0.5
+#define LIBCRYPTO_EVP_CTRL_GCM_GET_TAG	0x10
+
+static gpointer (*crypto_md_ctx_new) (void) = NULL;
+static void (*crypto_md_ctx_free) (gpointer ctx) = NULL;
+static gint (*crypto_digest_init) (gpointer ctx, gconstpointer type,
+				   gpointer engine) = NULL;
+static gint (*crypto_digest_update) (gpointer ctx, gconstpointer data,
+				     gsize len) = NULL;
+static gint (*crypto_digest_final) (gpointer ctx, guchar * md,
+				    guint * len) = NULL;
+static gconstpointer (*crypto_md5) (void) = NULL;
+static gconstpointer (*crypto_sha1) (void) = NULL;
+static gconstpointer (*crypto_sha256) (void) = NULL;
+
+static gpointer (*crypto_cipher_ctx_new) (void) = NULL;
+static void (*crypto_cipher_ctx_free) (gpointer ctx) = NULL;
+static gint (*crypto_cipher_ctx_ctrl) (gpointer ctx, gint type, gint arg,
+				       gpointer ptr) = NULL;
+static gint (*crypto_encrypt_init) (gpointer ctx, gconstpointer cipher,
+				    gpointer engine, const guchar * key,
+				    const guchar * iv) = NULL;
+static gint (*crypto_encrypt_update) (gpointer ctx, guchar * out,
+				      gint * outlen, const guchar * in,
+				      gint inlen) = NULL;
+static gint (*crypto_encrypt_final) (gpointer ctx, guchar * out,
+				     gint * outlen) = NULL;
+static gconstpointer (*crypto_aes_128_gcm) (void) = NULL;
+
+static const gchar *(*crypto_version) (gint type) = NULL;
+
+/* OpenSSL 1.1 renamed a few of these; the old name comes second */
+static const struct {
+    const gchar *name, *old_name;
+    gpointer *symbol;
+} libcrypto_symbols[] = {
+    {"EVP_MD_CTX_new", "EVP_MD_CTX_create", (gpointer *) & crypto_md_ctx_new},
+    {"EVP_MD_CTX_free", "EVP_MD_CTX_destroy", (gpointer *) & crypto_md_ctx_free},
+    {"EVP_DigestInit_ex", NULL, (gpointer *) & crypto_digest_init},
+    {"EVP_DigestUpdate", NULL, (gpointer *) & crypto_digest_update},
+    {"EVP_DigestFinal_ex", NULL, (gpointer *) & crypto_digest_final},
+    {"EVP_md5", NULL, (gpointer *) & crypto_md5},
+    {"EVP_sha1", NULL, (gpointer *) & crypto_sha1},
+    {"EVP_sha256", NULL, (gpointer *) & crypto_sha256},
+    {"EVP_CIPHER_CTX_new", NULL, (gpointer *) & crypto_cipher_ctx_new},
+    {"EVP_CIPHER_CTX_free", NULL, (gpointer *) & crypto_cipher_ctx_free},
+    {"EVP_CIPHER_CTX_ctrl", NULL, (gpointer *) & crypto_cipher_ctx_ctrl},
+    {"EVP_EncryptInit_ex", NULL, (gpointer *) & crypto_encrypt_init},
+    {"EVP_EncryptUpdate", NULL, (gpointer *) & crypto_encrypt_update},
+    {"EVP_EncryptFinal_ex", NULL, (gpointer *) & crypto_encrypt_final},
+    {"EVP_aes_128_gcm", NULL, (gpointer *) & crypto_aes_128_gcm},
+    {NULL, NULL, NULL}
+};
+
+static gboolean
+libcrypto_load(void)
+{
+    static const gchar *names[] = {
+	"libcrypto.so.3",
+	"libcrypto.so.1.1",
+	"libcrypto.so.1.0.0",
+	"libcrypto",
+	"/usr/lib/libcrypto.so",
+	NULL
+    };
+    GModule *libcrypto = NULL;
+    gint i;
+
+    if (crypto_md_ctx_new)
+	return TRUE;
+
+    for (i = 0; names[i] && !libcrypto; i++)
+	libcrypto = g_module_open(names[i], G_MODULE_BIND_LAZY);
+
+    if (!libcrypto) {
+	DEBUG("cannot load libcrypto: %s", g_module_error());
+	return FALSE;
+    }
+
+    for (i = 0; libcrypto_symbols[i].name; i++) {
+	if (g_module_symbol(libcrypto, libcrypto_symbols[i].name,
+			    libcrypto_symbols[i].symbol))
+	    continue;
+
+	if (libcrypto_symbols[i].old_name
+	    && g_module_symbol(libcrypto, libcrypto_symbols[i].old_name,
+			       libcrypto_symbols[i].symbol))
+	    continue;
+
+	for (i = 0; libcrypto_symbols[i].name; i++)
+	    *libcrypto_symbols[i].symbol = NULL;
+
+	g_module_close(libcrypto);
+	return FALSE;
+    }
+
+    /* only for the details; SSLeay_version is the pre-1.1 name */
+    if (!g_module_symbol(libcrypto, "OpenSSL_version",
+			 (gpointer) & crypto_version))
+	g_module_symbol(libcrypto, "SSLeay_version",
+			(gpointer) & crypto_version);
+
+    return TRUE;
+}
+
+typedef enum {
+    LIBCRYPTO_MD5,
+    LIBCRYPTO_SHA1,
+    LIBCRYPTO_SHA256,
+    LIBCRYPTO_AES_128_GCM,
+    LIBCRYPTO_N_ALGORITHMS
+} LibcryptoAlgorithm;
+
+static const gchar *libcrypto_algorithm_names[] = {
+    "MD5",
+    "SHA-1",
+    "SHA-256",
+    "AES-128-GCM"
+};
+
+/*
+ * Runs one algorithm over the input for LIBCRYPTO_DURATION seconds and
+ * returns MiB/s, or 0 if it cannot; the last digest or tag goes to out.
+ */
+static gdouble
+libcrypto_run(LibcryptoAlgorithm algorithm, gboolean library,
+	      const guchar * data, gsize len, guchar * scratch,
+	      guchar out[32])
+{
+    static const guchar key[16] = "hardinfo-bench!";
+    static const guchar iv[12] = "libcrypto-iv";
+    GTimer *timer;
+    gpointer ctx = NULL;
+    gconstpointer type = NULL;
+    AES_GCM_CTX gcm;
+    struct MD5Context md5;
+    SHA1_CTX sha1;
+    gdouble elapsed;
+    gint64 bytes = 0;
+    guint digest_len;
+    gint outlen;
+
+    if (library) {
+	switch (algorithm) {
+	case LIBCRYPTO_MD5:
+	    type = crypto_md5();
+	    break;
+	case LIBCRYPTO_SHA1:
+	    type = crypto_sha1();
+	    break;
+	case LIBCRYPTO_SHA256:
+	    type = crypto_sha256();
+	    break;
+	case LIBCRYPTO_AES_128_GCM:
+	    type = crypto_aes_128_gcm();
+	    break;
+	default:
+	    return 0;
+	}
+
+	if (!type)
+	    return 0;
+
+	if (algorithm == LIBCRYPTO_AES_128_GCM) {
+	    ctx = crypto_cipher_ctx_new();
+	    if (ctx && !crypto_encrypt_init(ctx, type, NULL, key, NULL)) {
+		crypto_cipher_ctx_free(ctx);
+		ctx = NULL;
+	    }
+	} else {
+	    ctx = crypto_md_ctx_new();
+	}
+
+	if (!ctx)
+	    return 0;
+    } else {
+	switch (algorithm) {
+	case LIBCRYPTO_AES_128_GCM:
+	    aes_gcm_init(&gcm, key, 128,
+			 aes_get_processor_flags() & aes_get_supported_flags());
+	    break;
+	case LIBCRYPTO_SHA1:
+	    /* SHA1Transform works in place, so it gets a private copy */
+	    memcpy(scratch, data, len);
+	    break;
+	case LIBCRYPTO_SHA256:
+	    /* nothing bundled to compare with */
+	    return 0;
+	default:
+	    break;
+	}
+    }
+
+    timer = g_timer_new();
+    g_timer_start(timer);
+
+    while (g_timer_elapsed(timer, NULL) < LIBCRYPTO_DURATION) {
+	if (library && algorithm == LIBCRYPTO_AES_128_GCM) {
+	    crypto_encrypt_init(ctx, NULL, NULL, NULL, iv);
+	    crypto_encrypt_update(ctx, scratch, &outlen, data, len);
+	    crypto_encrypt_final(ctx, scratch + outlen, &outlen);
+	    crypto_cipher_ctx_ctrl(ctx, LIBCRYPTO_EVP_CTRL_GCM_GET_TAG, 16,
+				   out);
+	} else if (library) {
+	    crypto_digest_init(ctx, type, NULL);
+	    crypto_digest_update(ctx, data, len);
+	    crypto_digest_final(ctx, out, &digest_len);
+	} else {
+	    switch (algorithm) {
+	    case LIBCRYPTO_MD5:
+		MD5Init(&md5);
+		MD5Update(&md5, (guchar *) data, len);
+		MD5Final(out, &md5);
+		break;
+	    case LIBCRYPTO_SHA1:
+		SHA1Init(&sha1);
+		SHA1Update(&sha1, scratch, len);
+		SHA1Final(out, &sha1);
+		break;
+	    default:
+		aes_gcm_encrypt(&gcm, iv, sizeof(iv), NULL, 0, data, scratch,
+				len, out);
+	    }
+	}
+
+	bytes += len;
+    }
+
+    g_timer_stop(timer);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    /* the copy has been scrambled by now: digest the real input again */
+    if (!library && algorithm == LIBCRYPTO_SHA1) {
+	memcpy(scratch, data, len);
+	SHA1Init(&sha1);
+	SHA1Update(&sha1, scratch, len);
+	SHA1Final(out, &sha1);
+    }
+
+    if (ctx) {
+	if (algorithm == LIBCRYPTO_AES_128_GCM)
+	    crypto_cipher_ctx_free(ctx);
+	else
+	    crypto_md_ctx_free(ctx);
+    }
+
+    return elapsed > 0 ? bytes / elapsed / (1024 * 1024) : 0;
+}
+
+static void
+benchmark_libcrypto(void)
+{
+    static const gsize out_len[] = { 16, 20, 32, 16 };
+    Corpus *corpus;
+    gchar *details;
+    guchar *scratch, bundled_out[32], library_out[32];
+    gdouble bundled, library, log_sum = 0;
+    gsize srclen = 65536;
+    gint i, n_results = 0;
+
+    if (!libcrypto_load()) {
+	benchmark_skip("libcrypto not found");
+	return;
+    }
+
+    corpus = corpus_get(CORPUS_FILE, 0, CORPUS_PREFAULT);
+    if (!corpus || corpus->size < srclen) {
+	corpus_release(corpus);
+	return;
+    }
+
+    shell_view_set_enabled(FALSE);
+
+    /* GCM needs somewhere to put the ciphertext, and a block of slack */
+    scratch = g_malloc(srclen + 16);
+
+    details = g_strdup_printf("[Library]\n"
+			      "Version=%s\n"
+			      "Input=%" G_GSIZE_FORMAT " bytes of benchmark.data\n"
+			      "[Bundled / Library]\n",
+			      crypto_version ? crypto_version(0) : "Unknown",
+			      srclen);
+
+    for (i = 0; i < LIBCRYPTO_N_ALGORITHMS; i++) {
+	gchar *status;
+
+	status = g_strdup_printf("Running %s...", libcrypto_algorithm_names[i]);
+	shell_status_update(status);
+	shell_status_set_percentage(100 * i / LIBCRYPTO_N_ALGORITHMS);
+	g_free(status);
+
+	bundled = libcrypto_run(i, FALSE, corpus->data, srclen, scratch,
+				bundled_out);
+	library = libcrypto_run(i, TRUE, corpus->data, srclen, scratch,
+				library_out);
+
+	if (bundled > 0)
+	    details = h_strdup_cprintf("%s=%.1f MiB/s / ", details,
+				       libcrypto_algorithm_names[i], bundled);
+	else
+	    details = h_strdup_cprintf("%s=Not bundled / ", details,
+				       libcrypto_algorithm_names[i]);
+
+	if (library > 0) {
+	    details = h_strdup_cprintf("%.1f MiB/s", details, library);
+
+	    log_sum += log(library);
+	    n_results++;
+	} else {
+	    details = h_strdup_cprintf("Not available", details);
+	}
+
+	/* both must agree on the digest or tag, or one of them is broken */
+	if (bundled > 0 && library > 0
+	    && memcmp(bundled_out, library_out, out_len[i]))
+	    details = h_strdup_cprintf(" (results differ!)", details);
+
+	details = h_strdup_cprintf("\n", details);
+    }
+
+    g_free(scratch);
+    corpus_release(corpus);
+
+    benchmark_set_details("CPU Crypto Library", details);
+
+    /* the library's geometric mean, so one algorithm cannot dominate */
+    bench_results[BENCHMARK_LIBCRYPTO] = n_results ?
+	exp(log_sum / n_results) : 0;
+}
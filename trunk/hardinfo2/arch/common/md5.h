@@ -24,21 +24,19 @@ benchmark_md5(void)
     struct MD5Context ctx;
     guchar checksum[16];
     int i;
-    GTimer *timer = g_timer_new();
+    GTimer *timer;
     gdouble elapsed = 0;
-    gchar src[65536], *tmpsrc;
+    Corpus *corpus;
     glong srclen = 65536;
 
-    tmpsrc = src;
-
-    gchar *bdata_path;
-    
-    bdata_path = g_build_filename(params.path_data, "benchmark.data", NULL);
-    if (!g_file_get_contents(bdata_path, &tmpsrc, NULL, NULL)) {
-        g_free(bdata_path);
+    corpus = corpus_get(CORPUS_FILE, 0, CORPUS_PREFAULT);
+    if (!corpus || corpus->size < srclen) {
+        corpus_release(corpus);
         return;
-    }     
-    
+    }
+
+    timer = g_timer_new();
+
     shell_view_set_enabled(FALSE);
     shell_status_update("Generating MD5 sum for 312MiB of data...");
     
@@ -46,7 +44,7 @@ benchmark_md5(void)
         g_timer_start(timer);
 
         MD5Init(&ctx);
-        MD5Update(&ctx, (guchar*)tmpsrc, srclen);
+        MD5Update(&ctx, (guchar*)corpus->data, srclen);
         MD5Final(checksum, &ctx);
         
         g_timer_stop(timer);
@@ -56,7 +54,7 @@ benchmark_md5(void)
     }
     
     g_timer_destroy(timer);
-    g_free(bdata_path);
+    corpus_release(corpus);
     
     bench_results[BENCHMARK_MD5] = 312.0 / elapsed;
 }
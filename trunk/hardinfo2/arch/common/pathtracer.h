@@ -0,0 +1,573 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * A small path tracer: a few hundred spheres on a checkered floor under a
+ * sky, diffuse and mirror materials, some lights. Spheres live in a BVH;
+ * the image is rendered in tiles on the work-stealing pool. Everything is
+ * seeded per pixel, so the image doesn't depend on the tile schedule and
+ * its checksum can be used to check the result.
+ */
+
+#include <math.h>
+#include <workpool.h>
+
+#define PT_WIDTH	256
+#define PT_HEIGHT	192
+#define PT_SAMPLES	8
+#define PT_MAX_DEPTH	5
+#define PT_TILE_SIZE	16
+#define PT_GRID		20
+
+/*
+ * FNV-1a of the 8-bit image, as rendered with SSE2 double arithmetic;
+ * x87 extended precision rounds differently, so it is only enforced on
+ * x86-64.
+ */
+#define PT_REFERENCE_CHECKSUM	0x1888cd41
+
+enum {
+    PT_DIFFUSE,
+    PT_MIRROR,
+    PT_LIGHT
+};
+
+typedef struct {
+    gdouble x, y, z;
+} PTVec;
+
+typedef struct {
+    PTVec center, color;
+    gdouble radius;
+    gint material;
+} PTSphere;
+
+typedef struct {
+    PTVec min, max;
+    gint first;			/* first sphere (leaf) or right child */
+    gint count;			/* spheres in a leaf, 0 for inner nodes */
+} PTNode;
+
+typedef struct {
+    PTSphere *spheres;
+    gint n_spheres;
+    PTNode *nodes;
+    gint n_nodes;
+
+    guchar *image;
+    guint64 *tile_rays;
+    gint tiles_x, tiles_y;
+} PTScene;
+
+typedef struct {
+    PTScene *scene;
+    gint first_tile, n_tiles;
+} PTTileRange;
+
+static inline PTVec pt_vec(gdouble x, gdouble y, gdouble z)
+{
+    PTVec v = { x, y, z };
+    return v;
+}
+
+static inline PTVec pt_add(PTVec a, PTVec b)
+{
+    return pt_vec(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+static inline PTVec pt_sub(PTVec a, PTVec b)
+{
+    return pt_vec(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+static inline PTVec pt_mul(PTVec a, PTVec b)
+{
+    return pt_vec(a.x * b.x, a.y * b.y, a.z * b.z);
+}
+
+static inline PTVec pt_scale(PTVec a, gdouble s)
+{
+    return pt_vec(a.x * s, a.y * s, a.z * s);
+}
+
+static inline gdouble pt_dot(PTVec a, PTVec b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline PTVec pt_cross(PTVec a, PTVec b)
+{
+    return pt_vec(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+		  a.x * b.y - a.y * b.x);
+}
+
+static inline PTVec pt_normalize(PTVec a)
+{
+    return pt_scale(a, 1.0 / sqrt(pt_dot(a, a)));
+}
+
+static inline gdouble pt_axis(PTVec v, gint axis)
+{
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static inline guint32 pt_random(guint32 * state)
+{
+    /* xorshift32 */
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+static inline gdouble pt_random_double(guint32 * state)
+{
+    return (pt_random(state) >> 8) * (1.0 / 16777216.0);
+}
+
+static gint pt_sphere_compare(gconstpointer a, gconstpointer b,
+			      gpointer data)
+{
+    gint axis = GPOINTER_TO_INT(data);
+    gdouble ca = pt_axis(((const PTSphere *) a)->center, axis);
+    gdouble cb = pt_axis(((const PTSphere *) b)->center, axis);
+
+    return ca < cb ? -1 : (ca > cb ? 1 : 0);
+}
+
+static gint pt_bvh_build(PTScene * scene, gint first, gint count)
+{
+    PTNode *node;
+    PTVec cmin, cmax;
+    gint index, i, axis, half;
+
+    index = scene->n_nodes++;
+    node = &scene->nodes[index];
+
+    node->min = pt_vec(1e30, 1e30, 1e30);
+    node->max = pt_vec(-1e30, -1e30, -1e30);
+    cmin = node->min;
+    cmax = node->max;
+
+    for (i = first; i < first + count; i++) {
+	PTSphere *s = &scene->spheres[i];
+	PTVec r = pt_vec(s->radius, s->radius, s->radius);
+	PTVec lo = pt_sub(s->center, r), hi = pt_add(s->center, r);
+
+	node->min = pt_vec(MIN(node->min.x, lo.x), MIN(node->min.y, lo.y),
+			   MIN(node->min.z, lo.z));
+	node->max = pt_vec(MAX(node->max.x, hi.x), MAX(node->max.y, hi.y),
+			   MAX(node->max.z, hi.z));
+	cmin = pt_vec(MIN(cmin.x, s->center.x), MIN(cmin.y, s->center.y),
+		      MIN(cmin.z, s->center.z));
+	cmax = pt_vec(MAX(cmax.x, s->center.x), MAX(cmax.y, s->center.y),
+		      MAX(cmax.z, s->center.z));
+    }
+
+    if (count <= 2) {
+	node->first = first;
+	node->count = count;
+	return index;
+    }
+
+    /* median split along the axis where the centers spread the most */
+    axis = 0;
+    if (cmax.y - cmin.y > pt_axis(cmax, axis) - pt_axis(cmin, axis))
+	axis = 1;
+    if (cmax.z - cmin.z > pt_axis(cmax, axis) - pt_axis(cmin, axis))
+	axis = 2;
+
+    g_qsort_with_data(scene->spheres + first, count, sizeof(PTSphere),
+		      pt_sphere_compare, GINT_TO_POINTER(axis));
+
+    half = count / 2;
+    node->count = 0;
+    pt_bvh_build(scene, first, half);	/* left child is index + 1 */
+    i = pt_bvh_build(scene, first + half, count - half);
+    scene->nodes[index].first = i;
+
+    return index;
+}
+
+static void pt_scene_init(PTScene * scene)
+{
+    guint32 seed = 0xdecafbad;
+    gint x, z, n = 0;
+
+    scene->spheres = g_new0(PTSphere, PT_GRID * PT_GRID);
+    for (z = 0; z < PT_GRID; z++) {
+	for (x = 0; x < PT_GRID; x++) {
+	    PTSphere *s = &scene->spheres[n++];
+	    guint32 kind = pt_random(&seed) % 20;
+
+	    s->radius = 0.15 + 0.3 * pt_random_double(&seed);
+	    s->center = pt_vec(x - PT_GRID / 2 + 0.6 * pt_random_double(&seed),
+			       s->radius + 0.5 * pt_random_double(&seed),
+			       -z - 2.0 + 0.6 * pt_random_double(&seed));
+	    s->color = pt_vec(0.2 + 0.7 * pt_random_double(&seed),
+			      0.2 + 0.7 * pt_random_double(&seed),
+			      0.2 + 0.7 * pt_random_double(&seed));
+
+	    if (kind == 0) {
+		s->material = PT_LIGHT;
+		s->color = pt_scale(s->color, 6.0);
+	    } else if (kind < 5) {
+		s->material = PT_MIRROR;
+	    } else {
+		s->material = PT_DIFFUSE;
+	    }
+	}
+    }
+    scene->n_spheres = n;
+
+    scene->nodes = g_new0(PTNode, 2 * n);
+    scene->n_nodes = 0;
+    pt_bvh_build(scene, 0, n);
+}
+
+static inline gboolean pt_box_hit(const PTNode * node, PTVec origin,
+				  PTVec inv_dir, gdouble t_max)
+{
+    gdouble t0, t1, tmin = 0, tmax = t_max;
+
+    t0 = (node->min.x - origin.x) * inv_dir.x;
+    t1 = (node->max.x - origin.x) * inv_dir.x;
+    tmin = MAX(tmin, MIN(t0, t1));
+    tmax = MIN(tmax, MAX(t0, t1));
+
+    t0 = (node->min.y - origin.y) * inv_dir.y;
+    t1 = (node->max.y - origin.y) * inv_dir.y;
+    tmin = MAX(tmin, MIN(t0, t1));
+    tmax = MIN(tmax, MAX(t0, t1));
+
+    t0 = (node->min.z - origin.z) * inv_dir.z;
+    t1 = (node->max.z - origin.z) * inv_dir.z;
+    tmin = MAX(tmin, MIN(t0, t1));
+    tmax = MIN(tmax, MAX(t0, t1));
+
+    return tmin <= tmax;
+}
+
+/* returns the nearest sphere hit, or NULL; *t is updated */
+static PTSphere *pt_intersect(PTScene * scene, PTVec origin, PTVec dir,
+			      gdouble * t)
+{
+    PTSphere *hit = NULL;
+    PTVec inv_dir = pt_vec(1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z);
+    gint stack[64], sp = 0, i;
+
+    stack[sp++] = 0;
+    while (sp > 0) {
+	const PTNode *node = &scene->nodes[stack[--sp]];
+
+	if (!pt_box_hit(node, origin, inv_dir, *t))
+	    continue;
+
+	if (node->count == 0) {
+	    stack[sp++] = node->first;
+	    stack[sp++] = (gint) (node - scene->nodes) + 1;
+	    continue;
+	}
+
+	for (i = node->first; i < node->first + node->count; i++) {
+	    PTSphere *s = &scene->spheres[i];
+	    PTVec oc = pt_sub(origin, s->center);
+	    gdouble b = pt_dot(oc, dir);
+	    gdouble c = pt_dot(oc, oc) - s->radius * s->radius;
+	    gdouble disc = b * b - c, root;
+
+	    if (disc < 0)
+		continue;
+
+	    disc = sqrt(disc);
+	    root = -b - disc;
+	    if (root < 1e-6)
+		root = -b + disc;
+
+	    if (root > 1e-6 && root < *t) {
+		*t = root;
+		hit = s;
+	    }
+	}
+    }
+
+    return hit;
+}
+
+static PTVec pt_trace(PTScene * scene, PTVec origin, PTVec dir,
+		      guint32 * seed, guint64 * rays)
+{
+    PTVec radiance = pt_vec(0, 0, 0), throughput = pt_vec(1, 1, 1);
+    gint depth;
+
+    for (depth = 0; depth < PT_MAX_DEPTH; depth++) {
+	PTSphere *sphere;
+	PTVec point, normal, color;
+	gdouble t = 1e30;
+	gint material;
+
+	(*rays)++;
+
+	sphere = pt_intersect(scene, origin, dir, &t);
+
+	/* the floor, y = 0 */
+	if (dir.y < 0) {
+	    gdouble tf = -origin.y / dir.y;
+
+	    if (tf > 1e-6 && tf < t) {
+		t = tf;
+		sphere = NULL;
+		point = pt_add(origin, pt_scale(dir, t));
+		normal = pt_vec(0, 1, 0);
+		material = PT_DIFFUSE;
+		color = (((gint) floor(point.x) + (gint) floor(point.z)) & 1) ?
+		    pt_vec(0.8, 0.8, 0.8) : pt_vec(0.3, 0.3, 0.35);
+		goto shade;
+	    }
+	}
+
+	if (!sphere) {
+	    /* sky */
+	    gdouble k = 0.5 * (dir.y + 1.0);
+
+	    color = pt_add(pt_scale(pt_vec(1.0, 1.0, 1.0), 1.0 - k),
+			   pt_scale(pt_vec(0.5, 0.7, 1.0), k));
+	    radiance = pt_add(radiance, pt_mul(throughput, color));
+	    break;
+	}
+
+	point = pt_add(origin, pt_scale(dir, t));
+	normal = pt_scale(pt_sub(point, sphere->center), 1.0 / sphere->radius);
+	material = sphere->material;
+	color = sphere->color;
+
+      shade:
+	if (material == PT_LIGHT) {
+	    radiance = pt_add(radiance, pt_mul(throughput, color));
+	    break;
+	}
+
+	throughput = pt_mul(throughput, color);
+	origin = pt_add(point, pt_scale(normal, 1e-4));
+
+	if (material == PT_MIRROR) {
+	    dir = pt_sub(dir, pt_scale(normal, 2 * pt_dot(dir, normal)));
+	} else {
+	    /* cosine-weighted direction around the normal */
+	    gdouble r1 = 2 * M_PI * pt_random_double(seed);
+	    gdouble r2 = pt_random_double(seed), r2s = sqrt(r2);
+	    PTVec u, v;
+
+	    u = pt_normalize(pt_cross(fabs(normal.x) > 0.1 ?
+				      pt_vec(0, 1, 0) : pt_vec(1, 0, 0),
+				      normal));
+	    v = pt_cross(normal, u);
+	    dir = pt_normalize(pt_add(pt_add(pt_scale(u, cos(r1) * r2s),
+					     pt_scale(v, sin(r1) * r2s)),
+				      pt_scale(normal, sqrt(1 - r2))));
+	}
+    }
+
+    return radiance;
+}
+
+static void pt_render_tile(PTScene * scene, gint tile)
+{
+    PTVec eye = pt_vec(0, 3.0, 4.0), forward, right, up;
+    gint tx = tile % scene->tiles_x, ty = tile / scene->tiles_x;
+    gint x, y, s;
+    guint64 rays = 0;
+
+    forward = pt_normalize(pt_sub(pt_vec(0, 0.5, -PT_GRID / 2), eye));
+    right = pt_normalize(pt_cross(forward, pt_vec(0, 1, 0)));
+    up = pt_cross(right, forward);
+
+    for (y = ty * PT_TILE_SIZE; y < MIN((ty + 1) * PT_TILE_SIZE, PT_HEIGHT); y++) {
+	for (x = tx * PT_TILE_SIZE; x < MIN((tx + 1) * PT_TILE_SIZE, PT_WIDTH); x++) {
+	    PTVec sum = pt_vec(0, 0, 0);
+	    guint32 seed = (guint32) (y * PT_WIDTH + x) * 2654435761U + 1;
+	    guchar *pixel = &scene->image[3 * (y * PT_WIDTH + x)];
+
+	    for (s = 0; s < PT_SAMPLES; s++) {
+		gdouble px = (x + pt_random_double(&seed)) / PT_WIDTH - 0.5;
+		gdouble py = (y + pt_random_double(&seed)) / PT_HEIGHT - 0.5;
+		PTVec dir;
+
+		dir = pt_normalize(pt_add(forward,
+					  pt_add(pt_scale(right, px * 1.2),
+						 pt_scale(up, -py * 0.9))));
+		sum = pt_add(sum, pt_trace(scene, eye, dir, &seed, &rays));
+	    }
+
+	    /* average, gamma 2 and quantize */
+	    sum = pt_scale(sum, 1.0 / PT_SAMPLES);
+	    pixel[0] = (guchar) (255 * sqrt(CLAMP(sum.x, 0, 1)));
+	    pixel[1] = (guchar) (255 * sqrt(CLAMP(sum.y, 0, 1)));
+	    pixel[2] = (guchar) (255 * sqrt(CLAMP(sum.z, 0, 1)));
+	}
+    }
+
+    scene->tile_rays[tile] = rays;
+}
+
+/* splits the tile range in halves, so that thieves take big chunks */
+static void pt_render_tiles(WorkPoolWorker * worker, gpointer data)
+{
+    PTTileRange *range = (PTTileRange *) data;
+    PTTileRange halves[2];
+    WorkPoolGroup group;
+
+    if (range->n_tiles == 1) {
+	pt_render_tile(range->scene, range->first_tile);
+	return;
+    }
+
+    halves[0].scene = halves[1].scene = range->scene;
+    halves[0].first_tile = range->first_tile;
+    halves[0].n_tiles = range->n_tiles / 2;
+    halves[1].first_tile = range->first_tile + halves[0].n_tiles;
+    halves[1].n_tiles = range->n_tiles - halves[0].n_tiles;
+
+    work_pool_group_init(&group);
+    work_pool_spawn(worker, &group, pt_render_tiles, &halves[1]);
+    pt_render_tiles(worker, &halves[0]);
+    work_pool_sync(worker, &group);
+}
+
+static guint32 pt_image_checksum(PTScene * scene)
+{
+    guint32 hash = 2166136261U;
+    gint i;
+
+    for (i = 0; i < 3 * PT_WIDTH * PT_HEIGHT; i++) {
+	hash ^= scene->image[i];
+	hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/* renders the image with n_threads workers; returns the elapsed time */
+static gdouble pt_render(PTScene * scene, gint n_threads, guint64 * rays,
+			 guint64 * steals, guint32 * checksum)
+{
+    WorkPool *pool;
+    PTTileRange all;
+    GTimer *timer;
+    gdouble elapsed;
+    gint i;
+
+    memset(scene->image, 0, 3 * PT_WIDTH * PT_HEIGHT);
+    all.scene = scene;
+    all.first_tile = 0;
+    all.n_tiles = scene->tiles_x * scene->tiles_y;
+
+    pool = work_pool_new(n_threads);
+
+    timer = g_timer_new();
+    g_timer_start(timer);
+    work_pool_run(pool, pt_render_tiles, &all);
+    g_timer_stop(timer);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    *steals = work_pool_get_steals(pool);
+    work_pool_free(pool);
+
+    *rays = 0;
+    for (i = 0; i < all.n_tiles; i++)
+	*rays += scene->tile_rays[i];
+    *checksum = pt_image_checksum(scene);
+
+    return elapsed;
+}
+
+static void
+benchmark_pathtrace(void)
+{
+    PTScene scene;
+    guint64 rays, steals;
+    guint32 checksum, checksum_all;
+    gdouble single, all, elapsed;
+    gint n_threads;
+    gboolean ok;
+    gchar *status;
+
+    shell_view_set_enabled(FALSE);
+    shell_status_update("Building scene...");
+
+    memset(&scene, 0, sizeof(scene));
+    pt_scene_init(&scene);
+    scene.tiles_x = (PT_WIDTH + PT_TILE_SIZE - 1) / PT_TILE_SIZE;
+    scene.tiles_y = (PT_HEIGHT + PT_TILE_SIZE - 1) / PT_TILE_SIZE;
+    scene.image = g_malloc(3 * PT_WIDTH * PT_HEIGHT);
+    scene.tile_rays = g_new0(guint64, scene.tiles_x * scene.tiles_y);
+
+    n_threads = benchmark_get_n_threads();
+
+    shell_status_update("Path tracing with one thread...");
+    shell_status_set_percentage(0);
+    elapsed = pt_render(&scene, 1, &rays, &steals, &checksum);
+    single = rays / elapsed / 1000000.0;
+
+    status = g_strdup_printf("Path tracing with %d threads...", n_threads);
+    shell_status_update(status);
+    shell_status_set_percentage(50);
+    g_free(status);
+    elapsed = pt_render(&scene, n_threads, &rays, &steals, &checksum_all);
+    all = rays / elapsed / 1000000.0;
+
+    /* the image must not depend on the number of threads */
+    ok = checksum == checksum_all;
+#if defined(__x86_64__)
+    ok = ok && checksum == PT_REFERENCE_CHECKSUM;
+#endif
+
+    benchmark_set_details("FPU Path Tracing",
+			  g_strdup_printf("[Scene]\n"
+					  "Spheres=%d\n"
+					  "BVH Nodes=%d\n"
+					  "Image=%dx%d, %d samples per pixel\n"
+					  "Tiles=%d (%dx%d pixels)\n"
+					  "[Results]\n"
+					  "1 thread=%.2f Mrays/s\n"
+					  "%d threads=%.2f Mrays/s (%.2fx)\n"
+					  "Rays per Image=%" G_GUINT64_FORMAT "\n"
+					  "Steals=%" G_GUINT64_FORMAT "\n"
+					  "[Verification]\n"
+					  "Image Checksum=0x%08x\n"
+					  "Reference Checksum=0x%08x\n"
+					  "Result=%s\n",
+					  scene.n_spheres, scene.n_nodes,
+					  PT_WIDTH, PT_HEIGHT, PT_SAMPLES,
+					  scene.tiles_x * scene.tiles_y,
+					  PT_TILE_SIZE, PT_TILE_SIZE,
+					  single, n_threads, all,
+					  single > 0 ? all / single : 0,
+					  rays, steals, checksum_all,
+					  PT_REFERENCE_CHECKSUM,
+					  ok ? "Correct" : "Incorrect image"));
+
+    g_free(scene.spheres);
+    g_free(scene.nodes);
+    g_free(scene.image);
+    g_free(scene.tile_rays);
+
+    bench_results[BENCHMARK_PATHTRACE] = ok ? all : 0;
+}
@@ -0,0 +1,213 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <unistd.h>
+#include <spawn.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+typedef enum {
+    PROCSPAWN_FORK,
+    PROCSPAWN_SPAWN,
+    PROCSPAWN_THREAD,
+    PROCSPAWN_N_METHODS
+} ProcSpawnMethod;
+
+static const gchar *procspawn_method_names[] = {
+    "fork+wait",
+    "posix_spawn+exec",
+    "pthread_create+join"
+};
+
+typedef struct _ProcSpawnData ProcSpawnData;
+
+struct _ProcSpawnData {
+    ProcSpawnMethod method;
+    gchar *true_path;
+    gdouble duration;
+    gint operations;
+};
+
+static gpointer procspawn_thread_func(gpointer data)
+{
+    return data;
+}
+
+static gboolean procspawn_do(ProcSpawnMethod method, gchar * true_path)
+{
+    pthread_t thread;
+    pid_t pid;
+    int status;
+
+    switch (method) {
+    case PROCSPAWN_FORK:
+	if ((pid = fork()) == 0)
+	    _exit(0);
+	if (pid < 0)
+	    return FALSE;
+
+	return waitpid(pid, &status, 0) == pid;
+    case PROCSPAWN_SPAWN:
+	{
+	    char *argv[] = { true_path, NULL };
+
+	    if (posix_spawn(&pid, true_path, NULL, NULL, argv, environ) != 0)
+		return FALSE;
+
+	    return waitpid(pid, &status, 0) == pid;
+	}
+    case PROCSPAWN_THREAD:
+	if (pthread_create(&thread, NULL, procspawn_thread_func, NULL) != 0)
+	    return FALSE;
+
+	return pthread_join(thread, NULL) == 0;
+    default:
+	return FALSE;
+    }
+}
+
+static void procspawn_worker(gint thread_number, gpointer data)
+{
+    ProcSpawnData *psd = (ProcSpawnData *) data;
+    GTimer *timer = g_timer_new();
+    gint operations = 0;
+
+    g_timer_start(timer);
+    while (g_timer_elapsed(timer, NULL) < psd->duration) {
+	if (!procspawn_do(psd->method, psd->true_path))
+	    break;
+
+	operations++;
+    }
+    g_timer_destroy(timer);
+
+    g_atomic_int_add(&psd->operations, operations);
+}
+
+static void
+benchmark_procspawn(void)
+{
+    /* fork() copies the page tables, so it gets slower as the parent grows */
+    static const gint ballast_mib[] = { 0, 64, 256 };
+    ProcSpawnData psd;
+    gchar *groups[PROCSPAWN_N_METHODS];
+    gchar *ballast, *details;
+    gdouble base_rate[PROCSPAWN_N_METHODS], log_sum = 0;
+    gint n_threads, n_rates = 0, n_steps = 0, step = 0;
+    gint i, method, threads;
+    guint64 max_ballast;
+
+    shell_view_set_enabled(FALSE);
+
+    n_threads = benchmark_get_n_threads();
+    max_ballast = benchmark_get_available_memory() / 4;
+    psd.true_path = g_find_program_in_path("true");
+    psd.duration = 0.25;
+
+    for (threads = 1; threads;
+	 threads = benchmark_next_thread_count(threads, n_threads))
+	n_steps++;
+    n_steps *= G_N_ELEMENTS(ballast_mib) * PROCSPAWN_N_METHODS;
+
+    for (method = 0; method < PROCSPAWN_N_METHODS; method++) {
+	groups[method] = g_strdup_printf("[%s]\n",
+					 procspawn_method_names[method]);
+	base_rate[method] = 0;
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(ballast_mib); i++) {
+	gsize ballast_size = (gsize) ballast_mib[i] * 1024 * 1024;
+
+	if (ballast_size > max_ballast)
+	    break;
+
+	ballast = NULL;
+	if (ballast_size) {
+	    if (!(ballast = g_try_malloc(ballast_size)))
+		break;
+
+	    /* touch every page, so it is really part of the resident set */
+	    memset(ballast, 0x5a, ballast_size);
+	}
+
+	for (method = 0; method < PROCSPAWN_N_METHODS; method++) {
+	    for (threads = 1; threads;
+		 threads = benchmark_next_thread_count(threads, n_threads)) {
+		gdouble elapsed, rate;
+		gchar *status;
+
+		status = g_strdup_printf("Measuring %s with %d MiB of ballast, "
+					 "%d thread(s)...",
+					 procspawn_method_names[method],
+					 ballast_mib[i], threads);
+		shell_status_update(status);
+		g_free(status);
+		shell_status_set_percentage(100 * step++ / n_steps);
+
+		if (method == PROCSPAWN_SPAWN && !psd.true_path) {
+		    groups[method] =
+			h_strdup_cprintf("Parent RSS +%d MiB, %d thread(s)=Not available\n",
+					 groups[method], ballast_mib[i], threads);
+		    continue;
+		}
+
+		psd.method = method;
+		psd.operations = 0;
+		elapsed = benchmark_parallel(threads, procspawn_worker, &psd);
+		if (elapsed < 0) {
+		    groups[method] =
+			h_strdup_cprintf("Parent RSS +%d MiB, %d thread(s)=Could not create threads\n",
+					 groups[method], ballast_mib[i], threads);
+		    continue;
+		}
+
+		rate = elapsed > 0 ? psd.operations / elapsed : 0;
+
+		if (i == 0 && threads == 1)
+		    base_rate[method] = rate;
+
+		groups[method] =
+		    h_strdup_cprintf("Parent RSS +%d MiB, %d thread(s)=%.1f/s\n",
+				     groups[method], ballast_mib[i], threads,
+				     rate);
+	    }
+	}
+
+	g_free(ballast);
+    }
+
+    details = g_strdup("");
+    for (method = 0; method < PROCSPAWN_N_METHODS; method++) {
+	details = h_strconcat(details, groups[method], NULL);
+	g_free(groups[method]);
+
+	if (base_rate[method] > 0) {
+	    log_sum += log(base_rate[method]);
+	    n_rates++;
+	}
+    }
+    benchmark_set_details("CPU Process Creation", details);
+
+    g_free(psd.true_path);
+
+    /* single thread, no ballast: geometric mean of the creation rates */
+    bench_results[BENCHMARK_PROCSPAWN] = n_rates ? exp(log_sum / n_rates) : 0;
+}
@@ -0,0 +1,357 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * SMT interference: runs pairs of kernels on two hardware threads of the
+ * same core and on two different cores, and compares both against each
+ * kernel running alone. The sibling pair comes from the sysfs topology.
+ */
+
+#define SMT_DURATION		0.5
+#define SMT_CHUNK		4096
+#define SMT_CHASE_ENTRIES	(8 * 1024 * 1024)
+
+typedef enum {
+    SMT_KERNEL_INTEGER,
+    SMT_KERNEL_FLOAT,
+    SMT_KERNEL_MEMORY,
+    SMT_N_KERNELS
+} SmtKernel;
+
+static const gchar *smt_kernel_names[] = {
+    "Integer",
+    "Floating Point",
+    "Memory"
+};
+
+/* kernel pairs that are measured, as in int+int, fp+fp and int+mem */
+static const SmtKernel smt_pairs[][2] = {
+    {SMT_KERNEL_INTEGER, SMT_KERNEL_INTEGER},
+    {SMT_KERNEL_FLOAT, SMT_KERNEL_FLOAT},
+    {SMT_KERNEL_INTEGER, SMT_KERNEL_MEMORY}
+};
+
+typedef struct _SmtJob SmtJob;
+
+struct _SmtJob {
+    gint n_threads;
+    gint cpu[2];
+    SmtKernel kernel[2];
+    guint32 *chase;
+
+    volatile gint ready;
+    gboolean pinned[2];
+    gdouble rate[2];
+    volatile guint64 sink;
+};
+
+static gboolean smt_set_affinity(gint cpu)
+{
+    CpuMask cpus;
+
+    if (cpu < 0 || cpu >= CPU_MASK_MAX_CPUS)
+	return FALSE;
+
+    cpu_mask_clear(&cpus);
+    cpu_mask_set(&cpus, cpu);
+
+    return cpu_mask_set_affinity(&cpus);
+}
+
+static gboolean smt_read_cpu_list(const gchar * path, CpuMask * cpus)
+{
+    gchar *contents;
+    gboolean ok;
+
+    if (!g_file_get_contents(path, &contents, NULL, NULL))
+	return FALSE;
+
+    ok = cpu_mask_parse(cpus, contents) > 0;
+    g_free(contents);
+
+    return ok;
+}
+
+/*
+ * Finds two sibling threads of one core, and another CPU on a different
+ * core. Either of sibling or other is set to -1 if there is none.
+ */
+static void smt_find_cpus(gint * cpu, gint * sibling, gint * other)
+{
+    CpuMask siblings, online;
+    gchar *path;
+    gint i, j;
+
+    *cpu = *sibling = *other = -1;
+
+    for (i = 0; i < CPU_MASK_MAX_CPUS && *sibling < 0; i++) {
+	path = g_strdup_printf("/sys/devices/system/cpu/cpu%d/topology/"
+			       "thread_siblings_list", i);
+	if (smt_read_cpu_list(path, &siblings)) {
+	    if (*cpu < 0)
+		*cpu = i;
+
+	    for (j = 0; j < CPU_MASK_MAX_CPUS; j++) {
+		if (cpu_mask_is_set(&siblings, j) && j != i) {
+		    *cpu = i;
+		    *sibling = j;
+		    break;
+		}
+	    }
+	}
+	g_free(path);
+    }
+
+    if (*cpu < 0)
+	return;
+
+    path = g_strdup_printf("/sys/devices/system/cpu/cpu%d/topology/"
+			   "thread_siblings_list", *cpu);
+    smt_read_cpu_list(path, &siblings);
+    g_free(path);
+
+    if (!smt_read_cpu_list("/sys/devices/system/cpu/online", &online))
+	return;
+
+    for (i = 0; i < CPU_MASK_MAX_CPUS; i++) {
+	if (cpu_mask_is_set(&online, i) && !cpu_mask_is_set(&siblings, i)) {
+	    *other = i;
+	    break;
+	}
+    }
+}
+
+static guint64 smt_run_integer(guint64 x)
+{
+    gint i;
+
+    for (i = 0; i < SMT_CHUNK; i++) {
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	x *= G_GUINT64_CONSTANT(0x9e3779b97f4a7c15);
+    }
+
+    return x;
+}
+
+static guint64 smt_run_float(guint64 x)
+{
+    gdouble a = 1.0, b = 2.0, c = 3.0, d = 4.0;
+    gint i;
+
+    /* four independent multiply-add chains */
+    for (i = 0; i < SMT_CHUNK; i++) {
+	a = a * 0.999999 + 0.000001;
+	b = b * 0.999999 + 0.000002;
+	c = c * 0.999999 + 0.000003;
+	d = d * 0.999999 + 0.000004;
+    }
+
+    return x + (guint64) (a + b + c + d);
+}
+
+static guint64 smt_run_memory(guint32 * chase, guint64 x)
+{
+    guint32 index = (guint32) x % SMT_CHASE_ENTRIES;
+    gint i;
+
+    for (i = 0; i < SMT_CHUNK / 16; i++)
+	index = chase[index];
+
+    return index;
+}
+
+static void smt_worker(gint thread_number, gpointer data)
+{
+    SmtJob *job = (SmtJob *) data;
+    GTimer *timer = g_timer_new();
+    guint64 x = thread_number + 1, operations = 0;
+    gdouble elapsed;
+
+    job->pinned[thread_number] = smt_set_affinity(job->cpu[thread_number]);
+
+    /* start all threads together, once they are on their CPUs */
+    g_atomic_int_inc(&job->ready);
+    while (g_atomic_int_get(&job->ready) < job->n_threads);
+
+    g_timer_start(timer);
+    do {
+	switch (job->kernel[thread_number]) {
+	case SMT_KERNEL_INTEGER:
+	    x = smt_run_integer(x);
+	    operations += SMT_CHUNK;
+	    break;
+	case SMT_KERNEL_FLOAT:
+	    x = smt_run_float(x);
+	    operations += SMT_CHUNK;
+	    break;
+	case SMT_KERNEL_MEMORY:
+	    x = smt_run_memory(job->chase, x);
+	    operations += SMT_CHUNK / 16;
+	    break;
+	default:
+	    break;
+	}
+    } while ((elapsed = g_timer_elapsed(timer, NULL)) < SMT_DURATION);
+
+    job->sink += x;
+    job->rate[thread_number] = operations / elapsed;
+
+    g_timer_destroy(timer);
+}
+
+/*
+ * Runs one or two kernels, pinned; returns FALSE if the threads could not
+ * be created or pinned.
+ */
+static gboolean smt_run(SmtJob * job, gint n_threads,
+			SmtKernel kernel_a, gint cpu_a,
+			SmtKernel kernel_b, gint cpu_b)
+{
+    job->n_threads = n_threads;
+    job->ready = 0;
+    job->kernel[0] = kernel_a;
+    job->cpu[0] = cpu_a;
+    job->kernel[1] = kernel_b;
+    job->cpu[1] = cpu_b;
+    job->pinned[0] = job->pinned[1] = TRUE;
+
+    if (benchmark_parallel(n_threads, smt_worker, job) < 0)
+	return FALSE;
+
+    return job->pinned[0] && job->pinned[1];
+}
+
+static void
+benchmark_smt(void)
+{
+    SmtJob job = { 0 };
+    gdouble solo[SMT_N_KERNELS], smt[2], separate[2], yield, log_sum = 0;
+    gint cpu, sibling, other, i, step = 0;
+    gchar *details, *status;
+    guint32 j, k, swap;
+    guint64 seed = 1;
+
+    shell_view_set_enabled(FALSE);
+    shell_status_update("Reading processor topology...");
+
+    smt_find_cpus(&cpu, &sibling, &other);
+    if (sibling < 0) {
+	benchmark_set_details("CPU SMT Interference",
+			      g_strdup("[SMT Interference]\n"
+				       "Status=No SMT siblings found\n"));
+	bench_results[BENCHMARK_SMT] = 0;
+	return;
+    }
+
+    shell_status_update("Preparing memory kernel...");
+
+    /* a single random cycle (Sattolo's algorithm), so every load misses */
+    job.chase = g_new(guint32, SMT_CHASE_ENTRIES);
+    for (j = 0; j < SMT_CHASE_ENTRIES; j++)
+	job.chase[j] = j;
+    for (j = SMT_CHASE_ENTRIES - 1; j > 0; j--) {
+	seed = seed * G_GUINT64_CONSTANT(6364136223846793005) + 1442695040888963407;
+	k = (guint32) ((seed >> 33) % j);
+	swap = job.chase[j];
+	job.chase[j] = job.chase[k];
+	job.chase[k] = swap;
+    }
+
+    details = g_strdup_printf("[Topology]\n"
+			      "SMT Siblings=CPU%d + CPU%d\n", cpu, sibling);
+    if (other >= 0)
+	details = h_strdup_cprintf("Separate Cores=CPU%d + CPU%d\n",
+				   details, cpu, other);
+    else
+	details = h_strdup_cprintf("Separate Cores=None (comparing with one "
+				   "thread alone)\n", details);
+
+    for (i = 0; i < SMT_N_KERNELS; i++) {
+	status = g_strdup_printf("Running %s kernel alone...",
+				 smt_kernel_names[i]);
+	shell_status_update(status);
+	shell_status_set_percentage(100 * step++ / (SMT_N_KERNELS + 6));
+	g_free(status);
+
+	if (!smt_run(&job, 1, i, cpu, i, cpu))
+	    goto fail;
+	solo[i] = job.rate[0];
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(smt_pairs); i++) {
+	SmtKernel a = smt_pairs[i][0], b = smt_pairs[i][1];
+
+	status = g_strdup_printf("Running %s + %s on SMT siblings...",
+				 smt_kernel_names[a], smt_kernel_names[b]);
+	shell_status_update(status);
+	shell_status_set_percentage(100 * step++ / (SMT_N_KERNELS + 6));
+	g_free(status);
+
+	if (!smt_run(&job, 2, a, cpu, b, sibling))
+	    goto fail;
+	smt[0] = job.rate[0];
+	smt[1] = job.rate[1];
+
+	if (other >= 0) {
+	    status = g_strdup_printf("Running %s + %s on separate cores...",
+				     smt_kernel_names[a], smt_kernel_names[b]);
+	    shell_status_update(status);
+	    g_free(status);
+
+	    if (!smt_run(&job, 2, a, cpu, b, other))
+		goto fail;
+	    separate[0] = job.rate[0];
+	    separate[1] = job.rate[1];
+	} else {
+	    separate[0] = solo[a];
+	    separate[1] = solo[b];
+	}
+	shell_status_set_percentage(100 * step++ / (SMT_N_KERNELS + 6));
+
+	/* how much two siblings get done, relative to one thread alone */
+	yield = smt[0] / solo[a] + smt[1] / solo[b];
+	log_sum += log(yield);
+
+	details = h_strdup_cprintf("[%s + %s]\n"
+				   "CPU%d %s Yield=%.1f%% of separate-core rate\n"
+				   "CPU%d %s Yield=%.1f%% of separate-core rate\n"
+				   "Combined Throughput=%.2fx one thread\n",
+				   details,
+				   smt_kernel_names[a], smt_kernel_names[b],
+				   cpu, smt_kernel_names[a],
+				   100.0 * smt[0] / separate[0],
+				   sibling, smt_kernel_names[b],
+				   100.0 * smt[1] / separate[1], yield);
+    }
+
+    g_free(job.chase);
+    benchmark_set_details("CPU SMT Interference", details);
+
+    bench_results[BENCHMARK_SMT] = exp(log_sum / G_N_ELEMENTS(smt_pairs));
+    return;
+
+fail:
+    details = h_strdup_cprintf("[SMT Interference]\n"
+			       "Status=Could not run threads on the chosen CPUs\n",
+			       details);
+    g_free(job.chase);
+    benchmark_set_details("CPU SMT Interference", details);
+    bench_results[BENCHMARK_SMT] = 0;
+}
@@ -0,0 +1,574 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Integer workloads over 64-bit keys: a parallel LSD radix sort, a parallel
+ * quicksort on the work-stealing pool, and an open-addressing hash map fed
+ * with a Zipf-like key stream. Array sizes go from L2-resident to a few
+ * GiB, as far as memory and a time budget allow.
+ */
+
+#include <math.h>
+#include <workpool.h>
+
+#define SORT_QUICKSORT_CUTOFF	16384
+#define SORT_MIN_TIME		0.2
+#define SORT_TIME_BUDGET	30.0
+
+/* what sort_run_workload() returns when it could not finish */
+#define SORT_FAILED		-1
+#define SORT_NO_THREADS		-2
+
+#define HASH_EMPTY		G_GUINT64_CONSTANT(0)
+#define HASH_TOMBSTONE		G_GUINT64_CONSTANT(0xffffffffffffffff)
+
+enum {
+    SORT_WORKLOAD_RADIX,
+    SORT_WORKLOAD_QUICKSORT,
+    SORT_WORKLOAD_HASH,
+    SORT_N_WORKLOADS
+};
+
+static const gchar *sort_workload_names[] = {
+    "Radix Sort",
+    "Quicksort",
+    "Hash Map"
+};
+
+typedef struct _SortBarrier SortBarrier;
+typedef struct _SortJob SortJob;
+typedef struct _SortRange SortRange;
+
+struct _SortBarrier {
+    GMutex *lock;
+    GCond *cond;
+    gint count, waiting, generation;
+};
+
+struct _SortJob {
+    guint64 *keys, *tmp;
+    gsize n;
+    gint n_threads;
+    SortBarrier barrier;
+    gsize (*histograms)[256];
+};
+
+struct _SortRange {
+    guint64 *keys;
+    gsize n;
+};
+
+static inline guint64 sort_random(guint64 * state)
+{
+    /* xorshift64* */
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+
+    return *state * G_GUINT64_CONSTANT(2685821657736338717);
+}
+
+static inline guint64 sort_mix(guint64 x)
+{
+    x ^= x >> 33;
+    x *= G_GUINT64_CONSTANT(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    x *= G_GUINT64_CONSTANT(0xc4ceb9fe1a85ec53);
+    x ^= x >> 33;
+
+    return x;
+}
+
+static void sort_barrier_init(SortBarrier * barrier, gint count)
+{
+    barrier->lock = g_mutex_new();
+    barrier->cond = g_cond_new();
+    barrier->count = count;
+    barrier->waiting = 0;
+    barrier->generation = 0;
+}
+
+static void sort_barrier_free(SortBarrier * barrier)
+{
+    g_mutex_free(barrier->lock);
+    g_cond_free(barrier->cond);
+}
+
+static void sort_barrier_wait(SortBarrier * barrier)
+{
+    gint generation;
+
+    g_mutex_lock(barrier->lock);
+    generation = barrier->generation;
+    if (++barrier->waiting == barrier->count) {
+	barrier->waiting = 0;
+	barrier->generation++;
+	g_cond_broadcast(barrier->cond);
+    } else {
+	while (generation == barrier->generation)
+	    g_cond_wait(barrier->cond, barrier->lock);
+    }
+    g_mutex_unlock(barrier->lock);
+}
+
+/*
+ * One radix sort thread: eight passes of eight bits. Each pass counts the
+ * digits in this thread's slice, then thread 0 turns all the counts into
+ * output offsets, and every thread scatters its slice.
+ */
+static void sort_radix_worker(gint thread_number, gpointer data)
+{
+    SortJob *job = (SortJob *) data;
+    gsize first = job->n * thread_number / job->n_threads;
+    gsize last = job->n * (thread_number + 1) / job->n_threads;
+    gsize *histogram = job->histograms[thread_number];
+    guint64 *src = job->keys, *dst = job->tmp, *swap;
+    gint shift, digit, t;
+    gsize i;
+
+    for (shift = 0; shift < 64; shift += 8) {
+	memset(histogram, 0, 256 * sizeof(gsize));
+	for (i = first; i < last; i++)
+	    histogram[(src[i] >> shift) & 0xff]++;
+
+	sort_barrier_wait(&job->barrier);
+
+	if (thread_number == 0) {
+	    gsize offset = 0, count;
+
+	    for (digit = 0; digit < 256; digit++) {
+		for (t = 0; t < job->n_threads; t++) {
+		    count = job->histograms[t][digit];
+		    job->histograms[t][digit] = offset;
+		    offset += count;
+		}
+	    }
+	}
+
+	sort_barrier_wait(&job->barrier);
+
+	for (i = first; i < last; i++)
+	    dst[histogram[(src[i] >> shift) & 0xff]++] = src[i];
+
+	sort_barrier_wait(&job->barrier);
+
+	swap = src;
+	src = dst;
+	dst = swap;
+    }
+}
+
+/* returns FALSE if the threads could not be created */
+static gboolean sort_radix(guint64 * keys, guint64 * tmp, gsize n,
+			   gint n_threads)
+{
+    SortJob job;
+    gboolean started;
+
+    job.keys = keys;
+    job.tmp = tmp;
+    job.n = n;
+    job.n_threads = n_threads;
+    job.histograms = g_malloc(n_threads * sizeof(*job.histograms));
+    sort_barrier_init(&job.barrier, n_threads);
+
+    /* an even number of passes leaves the result back in keys */
+    started = benchmark_parallel(n_threads, sort_radix_worker, &job) >= 0;
+
+    sort_barrier_free(&job.barrier);
+    g_free(job.histograms);
+
+    return started;
+}
+
+static void sort_insertion(guint64 * keys, gsize n)
+{
+    gsize i, j;
+    guint64 key;
+
+    for (i = 1; i < n; i++) {
+	key = keys[i];
+	for (j = i; j > 0 && keys[j - 1] > key; j--)
+	    keys[j] = keys[j - 1];
+	keys[j] = key;
+    }
+}
+
+/* Hoare partition around the median of three; returns the split point */
+static gsize sort_partition(guint64 * keys, gsize n)
+{
+    guint64 a = keys[0], b = keys[n / 2], c = keys[n - 1], pivot, swap;
+    gsize i = 0, j = n - 1;
+
+    pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+    for (;;) {
+	while (keys[i] < pivot)
+	    i++;
+	while (keys[j] > pivot)
+	    j--;
+	if (i >= j)
+	    return j + 1;
+
+	swap = keys[i];
+	keys[i++] = keys[j];
+	keys[j--] = swap;
+    }
+}
+
+static void sort_quick_sequential(guint64 * keys, gsize n)
+{
+    gsize split;
+
+    while (n > 16) {
+	split = sort_partition(keys, n);
+
+	/* recurse into the smaller side, loop on the larger one */
+	if (split < n - split) {
+	    sort_quick_sequential(keys, split);
+	    keys += split;
+	    n -= split;
+	} else {
+	    sort_quick_sequential(keys + split, n - split);
+	    n = split;
+	}
+    }
+
+    sort_insertion(keys, n);
+}
+
+static void sort_quick_task(WorkPoolWorker * worker, gpointer data)
+{
+    SortRange *range = (SortRange *) data;
+    SortRange left;
+    WorkPoolGroup group;
+    gsize split;
+
+    if (range->n <= SORT_QUICKSORT_CUTOFF) {
+	sort_quick_sequential(range->keys, range->n);
+	return;
+    }
+
+    split = sort_partition(range->keys, range->n);
+    left.keys = range->keys;
+    left.n = split;
+
+    work_pool_group_init(&group);
+    work_pool_spawn(worker, &group, sort_quick_task, &left);
+    {
+	SortRange right = { range->keys + split, range->n - split };
+	sort_quick_task(worker, &right);
+    }
+    work_pool_sync(worker, &group);
+}
+
+static gboolean sort_is_sorted(guint64 * keys, gsize n)
+{
+    gsize i;
+
+    for (i = 1; i < n; i++) {
+	if (keys[i - 1] > keys[i])
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Fills keys with a Zipf-like stream (exponent ~0.99) over n distinct
+ * values, by inverting the continuous power law; ranks are then hashed so
+ * hot keys are spread over the table.
+ */
+static void sort_fill_zipf(guint64 * keys, gsize n, guint64 seed)
+{
+    const gdouble s = 0.99;
+    gdouble top = pow((gdouble) n, 1.0 - s) - 1.0;
+    guint64 key;
+    gsize i;
+
+    for (i = 0; i < n; i++) {
+	gdouble u = (sort_random(&seed) >> 11) * (1.0 / 9007199254740992.0);
+	guint64 rank = (guint64) pow(top * u + 1.0, 1.0 / (1.0 - s));
+
+	key = sort_mix(rank + 1);
+	if (key == HASH_EMPTY || key == HASH_TOMBSTONE)
+	    key = 2;
+	keys[i] = key;
+    }
+}
+
+typedef struct _HashJob HashJob;
+
+struct _HashJob {
+    guint64 *keys;		/* one Zipf stream, split between threads */
+    gsize n;
+    gint n_threads;
+    gboolean failed;
+};
+
+static void sort_hash_worker(gint thread_number, gpointer data)
+{
+    HashJob *job = (HashJob *) data;
+    gsize first = job->n * thread_number / job->n_threads;
+    gsize n = job->n * (thread_number + 1) / job->n_threads - first;
+    guint64 *keys = job->keys + first, *table_keys, *table_values;
+    gsize capacity = 16, mask, i, slot, found = 0, deleted = 0;
+
+    /* at most n distinct keys: keep the load factor at or below 1/2 */
+    while (capacity < 2 * n)
+	capacity <<= 1;
+    mask = capacity - 1;
+
+    table_keys = g_new0(guint64, capacity);
+    table_values = g_new0(guint64, capacity);
+
+    /* insert, or count a repeated key */
+    for (i = 0; i < n; i++) {
+	guint64 key = keys[i];
+	gsize tombstone = capacity;
+
+	for (slot = sort_mix(key) & mask;; slot = (slot + 1) & mask) {
+	    if (table_keys[slot] == key) {
+		table_values[slot]++;
+		break;
+	    }
+	    if (table_keys[slot] == HASH_TOMBSTONE && tombstone == capacity)
+		tombstone = slot;
+	    if (table_keys[slot] == HASH_EMPTY) {
+		if (tombstone != capacity)
+		    slot = tombstone;
+		table_keys[slot] = key;
+		table_values[slot] = 1;
+		break;
+	    }
+	}
+    }
+
+    /* look every key up again, in a scattered order */
+    for (i = 0; i < n; i++) {
+	guint64 key = keys[(i * 40503) % n];
+
+	for (slot = sort_mix(key) & mask;; slot = (slot + 1) & mask) {
+	    if (table_keys[slot] == key) {
+		found++;
+		break;
+	    }
+	    if (table_keys[slot] == HASH_EMPTY)
+		break;
+	}
+    }
+
+    /* delete the first half of the stream */
+    for (i = 0; i < n / 2; i++) {
+	guint64 key = keys[i];
+
+	for (slot = sort_mix(key) & mask;; slot = (slot + 1) & mask) {
+	    if (table_keys[slot] == key) {
+		table_keys[slot] = HASH_TOMBSTONE;
+		deleted++;
+		break;
+	    }
+	    if (table_keys[slot] == HASH_EMPTY)
+		break;
+	}
+    }
+
+    if (found != n)
+	job->failed = TRUE;
+
+    g_free(table_keys);
+    g_free(table_values);
+}
+
+/*
+ * Runs one workload over n keys with n_threads threads, repeating it
+ * until at least SORT_MIN_TIME has been measured. Returns million keys
+ * (hash map operations) per second, SORT_FAILED if the result was wrong
+ * or SORT_NO_THREADS if the threads could not be created.
+ */
+static gdouble sort_run_workload(gint workload, guint64 * pristine,
+				 guint64 * keys, guint64 * tmp, gsize n,
+				 gint n_threads)
+{
+    GTimer *timer = g_timer_new();
+    gdouble elapsed = 0;
+    guint64 operations = 0;
+    gboolean ok = TRUE, started = TRUE;
+
+    do {
+	memcpy(keys, pristine, n * sizeof(guint64));
+
+	g_timer_start(timer);
+	switch (workload) {
+	case SORT_WORKLOAD_RADIX:
+	    started = sort_radix(keys, tmp, n, n_threads);
+	    operations += n;
+	    break;
+	case SORT_WORKLOAD_QUICKSORT:
+	    {
+		WorkPool *pool = work_pool_new(n_threads);
+		SortRange all = { keys, n };
+
+		work_pool_run(pool, sort_quick_task, &all);
+		work_pool_free(pool);
+		operations += n;
+	    }
+	    break;
+	case SORT_WORKLOAD_HASH:
+	    {
+		HashJob job = { keys, n, n_threads, FALSE };
+
+		started = benchmark_parallel(n_threads, sort_hash_worker,
+					     &job) >= 0;
+		ok = ok && !job.failed;
+		operations += n + n + n / 2;
+	    }
+	    break;
+	}
+	g_timer_stop(timer);
+	elapsed += g_timer_elapsed(timer, NULL);
+
+	if (workload != SORT_WORKLOAD_HASH)
+	    ok = ok && sort_is_sorted(keys, n);
+    } while (started && ok && elapsed < SORT_MIN_TIME);
+
+    g_timer_destroy(timer);
+
+    if (!started)
+	return SORT_NO_THREADS;
+
+    return ok ? operations / elapsed / 1000000.0 : SORT_FAILED;
+}
+
+static void
+benchmark_sorting(void)
+{
+    /* array sizes in KiB: L2, L3, then DRAM */
+    static const gsize sizes_kib[] = {
+	256, 4 * 1024, 64 * 1024, 1024 * 1024, 4 * 1024 * 1024
+    };
+    guint64 *pristine, *keys, *tmp, available, seed;
+    gdouble rate, log_sum, headline = 0, spent = 0;
+    gint n_threads, workload, i;
+    gchar *details, *status;
+    GTimer *timer;
+
+    shell_view_set_enabled(FALSE);
+
+    n_threads = benchmark_get_n_threads();
+    available = benchmark_get_available_memory();
+    timer = g_timer_new();
+
+    details = g_strdup_printf("[Configuration]\n"
+			      "Threads=%d\n"
+			      "Key Size=64 bits\n"
+			      "Hash Map Keys=Zipf-like, s=0.99\n",
+			      n_threads);
+
+    for (i = 0; i < G_N_ELEMENTS(sizes_kib); i++) {
+	gsize bytes = sizes_kib[i] * 1024, n = bytes / sizeof(guint64);
+	gchar *size_name = sizes_kib[i] >= 1024 * 1024 ?
+	    g_strdup_printf("%" G_GSIZE_FORMAT " GiB", sizes_kib[i] / (1024 * 1024)) :
+	    sizes_kib[i] >= 1024 ?
+	    g_strdup_printf("%" G_GSIZE_FORMAT " MiB", sizes_kib[i] / 1024) :
+	    g_strdup_printf("%" G_GSIZE_FORMAT " KiB", sizes_kib[i]);
+
+	details = h_strdup_cprintf("[%s (%" G_GSIZE_FORMAT " keys)]\n",
+				   details, size_name, n);
+
+	/* pristine copy, working array, radix buffer and hash tables */
+	if ((guint64) bytes * 7 > available / 2) {
+	    details = h_strdup_cprintf("Status=Skipped (not enough memory)\n",
+				       details);
+	    g_free(size_name);
+	    continue;
+	}
+	if (spent > SORT_TIME_BUDGET) {
+	    details = h_strdup_cprintf("Status=Skipped (time budget exceeded)\n",
+				       details);
+	    g_free(size_name);
+	    continue;
+	}
+
+	pristine = g_try_malloc(bytes);
+	keys = g_try_malloc(bytes);
+	tmp = g_try_malloc(bytes);
+	if (!pristine || !keys || !tmp) {
+	    details = h_strdup_cprintf("Status=Skipped (allocation failed)\n",
+				       details);
+	    g_free(pristine);
+	    g_free(keys);
+	    g_free(tmp);
+	    g_free(size_name);
+	    continue;
+	}
+
+	g_timer_start(timer);
+	log_sum = 0;
+	for (workload = 0; workload < SORT_N_WORKLOADS; workload++) {
+	    gsize j;
+
+	    status = g_strdup_printf("%s, %s...",
+				     sort_workload_names[workload], size_name);
+	    shell_status_update(status);
+	    shell_status_set_percentage(100 * (i * SORT_N_WORKLOADS + workload) /
+					(G_N_ELEMENTS(sizes_kib) * SORT_N_WORKLOADS));
+	    g_free(status);
+
+	    seed = G_GUINT64_CONSTANT(0x853c49e6748fea9b) + i;
+	    if (workload == SORT_WORKLOAD_HASH) {
+		sort_fill_zipf(pristine, n, seed);
+	    } else if (workload == SORT_WORKLOAD_RADIX) {
+		for (j = 0; j < n; j++)
+		    pristine[j] = sort_random(&seed);
+	    }
+
+	    rate = sort_run_workload(workload, pristine, keys, tmp, n,
+				     n_threads);
+	    if (rate < 0) {
+		details = h_strdup_cprintf("%s=%s\n", details,
+					   sort_workload_names[workload],
+					   rate == SORT_NO_THREADS ?
+					   "Could not create threads" :
+					   "Failed verification");
+		log_sum = -1e30;
+		continue;
+	    }
+
+	    details = h_strdup_cprintf("%s=%.2f Mkeys/s\n", details,
+				       sort_workload_names[workload], rate);
+	    log_sum += log(rate);
+	}
+	g_timer_stop(timer);
+	spent += g_timer_elapsed(timer, NULL);
+
+	/* the score is taken from the largest size up to 64 MiB */
+	if (sizes_kib[i] <= 64 * 1024)
+	    headline = log_sum > -1e29 ? exp(log_sum / SORT_N_WORKLOADS) : 0;
+
+	g_free(pristine);
+	g_free(keys);
+	g_free(tmp);
+	g_free(size_name);
+    }
+
+    g_timer_destroy(timer);
+    benchmark_set_details("CPU Sorting and Hashing", details);
+
+    bench_results[BENCHMARK_SORTING] = headline;
+}
@@ -16,57 +16,71 @@
  *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
-static void
-benchmark_zlib(void)
+static gulong (*zlib_compressBound) (glong srclen) = NULL;
+static gint (*zlib_compress) (gchar *dst, glong *dstlen,
+                              const gchar *src, glong srclen) = NULL;
+
+static gboolean
+zlib_load(void)
 {
     GModule *libz;
-    static gulong (*compressBound) (glong srclen) = NULL;
-    static gint (*compress) (gchar *dst, glong *dstlen,
-                             const gchar *src, glong srclen) = NULL;
-
-    if (!(compress && compressBound)) {
-	libz = g_module_open("libz", G_MODULE_BIND_LAZY);
-	if (!libz) {
-            libz = g_module_open("/usr/lib/libz.so", G_MODULE_BIND_LAZY);
-            if (!libz) {
-                g_warning("Cannot load ZLib: %s", g_module_error());
-                return;
-            }
-	}
-
-	if (!g_module_symbol(libz, "compress", (gpointer) & compress)
-	    || !g_module_symbol(libz, "compressBound", (gpointer) & compressBound)) {
-	    
-            g_module_close(libz);
-	    return;
-	}
+
+    if (zlib_compress && zlib_compressBound)
+        return TRUE;
+
+    libz = g_module_open("libz", G_MODULE_BIND_LAZY);
+    if (!libz) {
+        libz = g_module_open("/usr/lib/libz.so", G_MODULE_BIND_LAZY);
+        if (!libz) {
+            g_warning("Cannot load ZLib: %s", g_module_error());
+            return FALSE;
+        }
     }
 
+    if (!g_module_symbol(libz, "compress", (gpointer) & zlib_compress)
+        || !g_module_symbol(libz, "compressBound", (gpointer) & zlib_compressBound)) {
+        zlib_compress = NULL;
+        zlib_compressBound = NULL;
+
+        g_module_close(libz);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+benchmark_zlib(void)
+{
+    if (!zlib_load())
+        return;
+
     shell_view_set_enabled(FALSE);
 
     int i;
-    GTimer *timer = g_timer_new();
+    GTimer *timer;
     gdouble elapsed = 0;
-    gchar src[65536], *tmpsrc;
+    Corpus *corpus;
     glong srclen = 65536;
-    gchar *bdata_path;
-    
-    bdata_path = g_build_filename(params.path_data, "benchmark.data", NULL);
-    if (!g_file_get_contents(bdata_path, &tmpsrc, NULL, NULL)) {
-        g_free(bdata_path);
+
+    corpus = corpus_get(CORPUS_FILE, 0, CORPUS_PREFAULT);
+    if (!corpus || corpus->size < srclen) {
+        corpus_release(corpus);
         return;
-    }     
-    
+    }
+
+    timer = g_timer_new();
+
     shell_status_update("Compressing 64MB with default options...");
     
     for (i = 0; i <= 1000; i++) { 
         g_timer_start(timer);
         
         gchar *dst;
-        glong dstlen = compressBound(srclen);
+        glong dstlen = zlib_compressBound(srclen);
         
         dst = g_new0(gchar, dstlen);
-        compress(dst, &dstlen, src, srclen);
+        zlib_compress(dst, &dstlen, (const gchar *) corpus->data, srclen);
 
         g_timer_stop(timer);
         elapsed += g_timer_elapsed(timer, NULL);
@@ -76,7 +90,199 @@ benchmark_zlib(void)
     }
     
     g_timer_destroy(timer);
-    g_free(bdata_path);
+    corpus_release(corpus);
     
     bench_results[BENCHMARK_ZLIB] = 65536.0 / elapsed;
 }
+
+/*
+ * Parallel, block-wise compression: the corpus is cut into fixed-size
+ * blocks that are compressed independently on a thread pool, and a single
+ * writer puts them back in order, like pigz and zstd -T do.
+ */
+#define PZLIB_BLOCK_SIZE	(128 * 1024)
+
+typedef struct _PZlibBlock PZlibBlock;
+typedef struct _PZlibJob PZlibJob;
+
+struct _PZlibBlock {
+    const gchar *src;
+    glong srclen;
+    gchar *dst;
+    glong dstlen;
+    gint status;
+    PZlibJob *job;
+};
+
+struct _PZlibJob {
+    GAsyncQueue *done;
+};
+
+static void pzlib_compress_block(gpointer data, gpointer user_data)
+{
+    PZlibBlock *block = (PZlibBlock *) data;
+
+    block->dstlen = zlib_compressBound(block->srclen);
+    block->status = zlib_compress(block->dst, &block->dstlen,
+                                  block->src, block->srclen);
+
+    g_async_queue_push(block->job->done, block);
+}
+
+/*
+ * Compresses the whole corpus with n_threads workers; returns the elapsed
+ * time, or a negative number if zlib refused a block.
+ */
+static gdouble pzlib_run(const gchar * corpus, gsize size, gint n_threads,
+                         gchar * output, gsize * output_len)
+{
+    PZlibJob job;
+    PZlibBlock *blocks;
+    GThreadPool *pool;
+    GTimer *timer;
+    gboolean *ready, failed = FALSE;
+    gint n_blocks, next_block = 0, i;
+    gsize out_pos = 0;
+    gdouble elapsed;
+
+    n_blocks = (size + PZLIB_BLOCK_SIZE - 1) / PZLIB_BLOCK_SIZE;
+    blocks = g_new0(PZlibBlock, n_blocks);
+    ready = g_new0(gboolean, n_blocks);
+    job.done = g_async_queue_new();
+
+    for (i = 0; i < n_blocks; i++) {
+        blocks[i].src = corpus + (gsize) i * PZLIB_BLOCK_SIZE;
+        blocks[i].srclen = MIN(PZLIB_BLOCK_SIZE, size - (gsize) i * PZLIB_BLOCK_SIZE);
+        blocks[i].dst = g_malloc(zlib_compressBound(blocks[i].srclen));
+        blocks[i].job = &job;
+    }
+
+    timer = g_timer_new();
+    g_timer_start(timer);
+
+    pool = g_thread_pool_new(pzlib_compress_block, NULL, n_threads, TRUE, NULL);
+    for (i = 0; i < n_blocks; i++)
+        g_thread_pool_push(pool, &blocks[i], NULL);
+
+    /* the ordered writer: blocks come back in any order, go out in order */
+    while (next_block < n_blocks) {
+        PZlibBlock *block = g_async_queue_pop(job.done);
+
+        ready[block - blocks] = TRUE;
+
+        while (next_block < n_blocks && ready[next_block]) {
+            block = &blocks[next_block++];
+
+            if (block->status != 0) {
+                failed = TRUE;
+                continue;
+            }
+
+            memcpy(output + out_pos, block->dst, block->dstlen);
+            out_pos += block->dstlen;
+        }
+    }
+
+    g_thread_pool_free(pool, FALSE, TRUE);
+
+    g_timer_stop(timer);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    for (i = 0; i < n_blocks; i++)
+        g_free(blocks[i].dst);
+    g_free(blocks);
+    g_free(ready);
+    g_async_queue_unref(job.done);
+
+    *output_len = out_pos;
+
+    return failed ? -1 : elapsed;
+}
+
+static void
+benchmark_pzlib(void)
+{
+    Corpus *corpus;
+    gchar *output, *details;
+    gsize size, output_len = 0;
+    gint n_threads, threads, n_steps = 0, step = 0;
+    gdouble elapsed, rate, single_rate = 0, result = 0;
+
+    if (!zlib_load())
+        return;
+
+    shell_view_set_enabled(FALSE);
+    shell_status_update("Generating corpus...");
+
+    size = MIN(64 * 1024 * 1024, benchmark_get_available_memory() / 8);
+    size -= size % PZLIB_BLOCK_SIZE;
+    n_threads = benchmark_get_n_threads();
+
+    for (threads = 1; threads;
+         threads = benchmark_next_thread_count(threads, n_threads))
+        n_steps++;
+
+    /* log-like text; spread over all nodes, since every thread reads it */
+    corpus = corpus_get(CORPUS_TEXT, size,
+                        CORPUS_PREFAULT | CORPUS_NUMA_INTERLEAVE);
+    if (!corpus)
+        return;
+
+    output = g_malloc(zlib_compressBound(PZLIB_BLOCK_SIZE) *
+                      (size / PZLIB_BLOCK_SIZE));
+
+    details = g_strdup_printf("[Corpus]\n"
+                              "Kind=%s\n"
+                              "Size=%.1f MiB\n"
+                              "Block Size=%d KiB\n"
+                              "Placement=%s\n"
+                              "[Throughput]\n",
+                              corpus_kind_get_name(corpus->kind),
+                              size / (1024.0 * 1024.0),
+                              PZLIB_BLOCK_SIZE / 1024,
+                              corpus->numa_applied ?
+                              "Interleaved across NUMA nodes" :
+                              "Default (no NUMA policy)");
+
+    for (threads = 1; threads;
+         threads = benchmark_next_thread_count(threads, n_threads)) {
+        gchar *status;
+
+        status = g_strdup_printf("Compressing %.0f MiB in %d KiB blocks "
+                                 "with %d thread(s)...",
+                                 size / (1024.0 * 1024.0),
+                                 PZLIB_BLOCK_SIZE / 1024, threads);
+        shell_status_update(status);
+        shell_status_set_percentage(100 * step++ / n_steps);
+        g_free(status);
+
+        elapsed = pzlib_run((const gchar *) corpus->data, size, threads, output, &output_len);
+        if (elapsed <= 0) {
+            details = h_strdup_cprintf("%d thread(s)=Compression failed\n",
+                                       details, threads);
+            continue;
+        }
+
+        rate = size / elapsed / 1000000.0;
+        if (threads == 1)
+            single_rate = rate;
+
+        details = h_strdup_cprintf("%d thread(s)=%.1f MB/s, %.0f%% efficiency\n",
+                                   details, threads, rate,
+                                   single_rate > 0 ?
+                                   100.0 * rate / (single_rate * threads) : 0);
+        result = rate;
+    }
+
+    details = h_strdup_cprintf("[Output]\n"
+                               "Compressed Size=%.1f MiB (%.1f%%)\n",
+                               details, output_len / (1024.0 * 1024.0),
+                               100.0 * output_len / size);
+    benchmark_set_details("CPU Parallel ZLib", details);
+
+    g_free(output);
+    corpus_release(corpus);
+
+    bench_results[BENCHMARK_PZLIB] = result;
+}
@@ -0,0 +1 @@
+../../../arch/linux/common/perfcount.h
\ No newline at end of file
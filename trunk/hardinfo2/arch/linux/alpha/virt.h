@@ -0,0 +1 @@
+../../../arch/linux/common/virt.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../linux/common/coreclass.h
\ No newline at end of file
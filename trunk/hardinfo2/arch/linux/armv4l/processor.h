@@ -22,49 +22,93 @@ struct _Processor {
     gfloat bogomips;
 
     gchar *has_fpu;
+
+    gint id;
+    gchar *cpu_part;
 };
 
 
 static GSList *
 __scan_processors(void)
 {
-    Processor *processor;
+    GSList *procs = NULL, *l;
+    Processor *processor = NULL;
     FILE *cpuinfo;
     gchar buffer[128];
+    gchar *model_name = NULL, *hardware = NULL, *flags = NULL;
 
     cpuinfo = fopen("/proc/cpuinfo", "r");
     if (!cpuinfo)
 	return NULL;
 
-    processor = g_new0(Processor, 1);
     while (fgets(buffer, 128, cpuinfo)) {
 	gchar **tmp = g_strsplit(buffer, ":", 2);
 
+	/* big.LITTLE machines differ per core, so every processor counts */
+	if (g_str_has_prefix(tmp[0], "processor") || !processor) {
+	    processor = g_new0(Processor, 1);
+	    procs = g_slist_append(procs, processor);
+	}
+
 	if (tmp[0] && tmp[1]) {
 	    tmp[0] = g_strstrip(tmp[0]);
 	    tmp[1] = g_strstrip(tmp[1]);
 
-	    get_str("Processor", processor->model_name);
+	    get_int("processor", processor->id);
+	    get_str("model name", processor->model_name);
+	    get_str("Processor", model_name);
 	    get_str("Features", processor->flags);
 	    get_float("BogoMIPS", processor->bogomips);
+	    get_str("CPU part", processor->cpu_part);
 
-	    get_str("Hardware", processor->has_fpu);
+	    get_str("Hardware", hardware);
 	}
 	g_strfreev(tmp);
     }
 
     fclose(cpuinfo);
 
-    return g_slist_append(NULL, processor);
+    /* older kernels name the processor and its features only once */
+    for (l = procs; l; l = l->next) {
+	processor = (Processor *) l->data;
+
+	if (processor->flags && !flags)
+	    flags = processor->flags;
+    }
+
+    for (l = procs; l; l = l->next) {
+	processor = (Processor *) l->data;
+
+	if (!processor->model_name)
+	    processor->model_name = g_strdup(model_name ? model_name
+					     : "ARM Processor");
+	if (!processor->flags)
+	    processor->flags = g_strdup(flags);
+	processor->has_fpu = g_strdup(hardware);
+    }
+
+    g_free(model_name);
+    g_free(hardware);
+
+    /* a stray block before "processor: 0" holds nothing but the globals */
+    processor = (Processor *) procs->data;
+    if (procs->next && !processor->cpu_part && processor->bogomips == 0) {
+	g_free(processor->model_name);
+	g_free(processor->flags);
+	g_free(processor->has_fpu);
+	g_free(processor);
+	procs = g_slist_delete_link(procs, procs);
+    }
+
+    return procs;
 }
 
 static gchar *
-processor_get_info(GSList *processors)
+processor_get_detailed_info(Processor *processor)
 {
-        Processor *processor = (Processor *)processors->data;
-        
 	return g_strdup_printf("[Processor]\n"
 	                       "Name=%s\n"
+	                       "Part=%s\n"
 	                       "Features=%s\n"
 			       "BogoMips=%.2f\n"
 			       "Endianesss="
@@ -76,7 +120,59 @@ processor_get_info(GSList *processors)
                                "\n"
 			       "Hardware=%s\n",
 			       processor->model_name,
+			       processor->cpu_part ? processor->cpu_part : "Unknown",
 			       processor->flags,
 			       processor->bogomips,
 			       processor->has_fpu);
 }
+
+static gchar *
+processor_get_info(GSList *processors)
+{
+    Processor *processor;
+
+    if (g_slist_length(processors) > 1) {
+	GString *list;
+	gchar *ret, *hashkey;
+	GSList *l;
+
+	list = g_string_new("");
+
+	/* details are only formatted for the processors looked at */
+	if (!processor_registry)
+	    processor_registry = device_registry_new_lazy("CPU",
+				(DeviceFormatFunc) processor_get_detailed_info,
+				NULL);
+	device_registry_begin_scan(processor_registry);
+
+	for (l = processors; l; l = l->next) {
+	    processor = (Processor *) l->data;
+
+	    g_string_append_printf(list, "$CPU%d$", processor->id);
+	    h_string_append_escaped(list, processor->model_name,
+				    H_ESCAPE_KEY_FILE_KEY);
+	    g_string_append_c(list, '=');
+	    if (processor->cpu_part)
+		h_string_append_escaped(list, processor->cpu_part,
+					H_ESCAPE_KEY_FILE_VALUE);
+	    g_string_append_c(list, '\n');
+
+	    hashkey = g_strdup_printf("%d", processor->id);
+	    device_registry_set_data(processor_registry, hashkey, processor);
+	    g_free(hashkey);
+	}
+
+	device_registry_end_scan(processor_registry);
+
+	ret = g_strdup_printf("[$ShellParam$]\n"
+			      "ViewType=1\n"
+			      "[Processors]\n"
+			      "%s", list->str);
+	g_string_free(list, TRUE);
+
+	return ret;
+    }
+
+    processor = (Processor *) processors->data;
+    return processor_get_detailed_info(processor);
+}
@@ -199,6 +199,79 @@ __scan_battery_apm(void)
     }
 }
 
+/*
+ * Whether the machine runs on battery power. Only reads the line status,
+ * so it is cheap enough to poll: an AC adapter that is online wins, then
+ * a discharging battery; the older ACPI and APM interfaces come last.
+ */
+static gboolean
+battery_is_discharging(void)
+{
+    GDir *dir;
+    const gchar *entry;
+    gchar *path, *type, *value, buffer[64];
+    gboolean has_mains = FALSE, online = FALSE, discharging = FALSE;
+    FILE *procapm;
+    gint ac_bat;
+
+    if ((dir = g_dir_open("/sys/class/power_supply", 0, NULL))) {
+        while ((entry = g_dir_read_name(dir))) {
+            path = g_build_filename("/sys/class/power_supply", entry, NULL);
+            type = h_sysfs_read_string(path, "type");
+
+            if (type && g_str_equal(type, "Mains")) {
+                has_mains = TRUE;
+                if (h_sysfs_read_int(path, "online") == 1)
+                    online = TRUE;
+            } else if (type && g_str_equal(type, "Battery")) {
+                value = h_sysfs_read_string(path, "status");
+                if (value && g_str_equal(value, "Discharging"))
+                    discharging = TRUE;
+                g_free(value);
+            }
+
+            g_free(type);
+            g_free(path);
+        }
+        g_dir_close(dir);
+
+        if (has_mains)
+            return !online;
+        if (discharging)
+            return TRUE;
+    }
+
+    if ((dir = g_dir_open("/proc/acpi/ac_adapter", 0, NULL))) {
+        while ((entry = g_dir_read_name(dir))) {
+            path = g_build_filename("/proc/acpi/ac_adapter", entry, NULL);
+            value = h_sysfs_read_string(path, "state");
+
+            if (value) {
+                has_mains = TRUE;
+                if (strstr(value, "on-line"))
+                    online = TRUE;
+            }
+
+            g_free(value);
+            g_free(path);
+        }
+        g_dir_close(dir);
+
+        if (has_mains)
+            return !online;
+    }
+
+    if ((procapm = fopen("/proc/apm", "r"))) {
+        /* the fourth field is the line status: 0 is off-line */
+        if (fscanf(procapm, "%63s %63s %63s 0x%x", buffer, buffer, buffer,
+                   &ac_bat) == 4 && ac_bat == 0)
+            discharging = TRUE;
+        fclose(procapm);
+    }
+
+    return discharging;
+}
+
 static void
 __scan_battery(void)
 {
@@ -0,0 +1,298 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Limits of the cgroup this process runs in, as containers and systemd
+ * set them up: the CFS quota, the effective cpuset and the memory limit.
+ * cgroup v2 is preferred, the v1 controllers are the fallback. A parent
+ * group's limit applies as well, so the tightest one on the path wins.
+ */
+
+#define CGROUP_ROOT		"/sys/fs/cgroup"
+
+/* v1 reports "no limit" as a huge number rounded down to the page size */
+#define CGROUP_V1_UNLIMITED	(G_GUINT64_CONSTANT(1) << 60)
+
+typedef struct _CgroupLimits CgroupLimits;
+
+struct _CgroupLimits {
+    gint version;		/* 0 if there is no cgroup to read */
+    gchar *path;
+
+    gdouble cpu_quota;		/* in processors; 0 if unlimited */
+    gchar *cpuset;		/* NULL if unknown */
+    gint cpuset_cpus;
+    guint64 memory_max;		/* in bytes; 0 if unlimited */
+};
+
+static gchar *cgroup_read(const gchar * dir, const gchar * file)
+{
+    gchar *path, *contents;
+
+    path = g_build_filename(dir, file, NULL);
+    if (!g_file_get_contents(path, &contents, NULL, NULL))
+	contents = NULL;
+    g_free(path);
+
+    return contents ? g_strstrip(contents) : NULL;
+}
+
+/*
+ * Returns the directories from the cgroup up to the root of the mount.
+ * Inside a container the host part of the path is usually not mounted,
+ * so those that do not exist are left out.
+ */
+static GSList *cgroup_get_hierarchy(const gchar * mount, const gchar * path)
+{
+    GSList *dirs = NULL;
+    gchar *relative, *dir, *slash;
+
+    relative = g_strdup(path);
+    for (;;) {
+	dir = g_build_filename(mount, relative, NULL);
+	if (g_file_test(dir, G_FILE_TEST_IS_DIR))
+	    dirs = g_slist_append(dirs, dir);
+	else
+	    g_free(dir);
+
+	if (!(slash = strrchr(relative, '/')) || slash == relative) {
+	    if (*relative && !g_str_equal(relative, "/"))
+		dirs = g_slist_append(dirs, g_strdup(mount));
+	    break;
+	}
+	*slash = '\0';
+    }
+    g_free(relative);
+
+    return dirs;
+}
+
+static void cgroup_free_hierarchy(GSList * dirs)
+{
+    g_slist_foreach(dirs, (GFunc) g_free, NULL);
+    g_slist_free(dirs);
+}
+
+static void cgroup_set_cpu_quota(CgroupLimits * limits, gdouble quota)
+{
+    if (quota > 0 && (limits->cpu_quota == 0 || quota < limits->cpu_quota))
+	limits->cpu_quota = quota;
+}
+
+static void cgroup_set_memory_max(CgroupLimits * limits, guint64 max)
+{
+    if (max > 0 && (limits->memory_max == 0 || max < limits->memory_max))
+	limits->memory_max = max;
+}
+
+static void cgroup_set_cpuset(CgroupLimits * limits, gchar * cpuset)
+{
+    CpuMask mask;
+
+    if (!cpuset)
+	return;
+
+    /* the deepest group is seen first, and its set is the effective one */
+    if (!limits->cpuset && *cpuset) {
+	limits->cpuset = cpuset;
+	limits->cpuset_cpus = cpu_mask_parse(&mask, cpuset);
+    } else {
+	g_free(cpuset);
+    }
+}
+
+static void cgroup_read_v2(CgroupLimits * limits, const gchar * path)
+{
+    GSList *dirs, *l;
+    gchar *value;
+    gdouble quota, period;
+
+    dirs = cgroup_get_hierarchy(CGROUP_ROOT, path);
+    for (l = dirs; l; l = l->next) {
+	const gchar *dir = (const gchar *) l->data;
+
+	/* "max 100000" or "<quota> <period>", in microseconds */
+	if ((value = cgroup_read(dir, "cpu.max"))) {
+	    if (sscanf(value, "%lf %lf", &quota, &period) == 2 && period > 0)
+		cgroup_set_cpu_quota(limits, quota / period);
+	    g_free(value);
+	}
+
+	if ((value = cgroup_read(dir, "memory.max"))) {
+	    if (!g_str_equal(value, "max"))
+		cgroup_set_memory_max(limits,
+				      g_ascii_strtoull(value, NULL, 10));
+	    g_free(value);
+	}
+
+	cgroup_set_cpuset(limits, cgroup_read(dir, "cpuset.cpus.effective"));
+    }
+    cgroup_free_hierarchy(dirs);
+}
+
+static void cgroup_read_v1(CgroupLimits * limits, const gchar * controllers,
+			   const gchar * path)
+{
+    static const gchar *cpu_mounts[] = { "cpu,cpuacct", "cpu", NULL };
+    GSList *dirs, *l;
+    gchar *mount, *value, **names;
+    gdouble quota, period;
+    guint64 max;
+    gint i;
+
+    names = g_strsplit(controllers, ",", 0);
+    for (i = 0; names[i]; i++) {
+	if (g_str_equal(names[i], "cpu")) {
+	    gint j;
+
+	    for (j = 0; cpu_mounts[j]; j++) {
+		mount = g_build_filename(CGROUP_ROOT, cpu_mounts[j], NULL);
+		dirs = cgroup_get_hierarchy(mount, path);
+		g_free(mount);
+
+		for (l = dirs; l; l = l->next) {
+		    gchar *period_value;
+
+		    value = cgroup_read(l->data, "cpu.cfs_quota_us");
+		    period_value = cgroup_read(l->data, "cpu.cfs_period_us");
+
+		    if (value && period_value) {
+			quota = g_ascii_strtod(value, NULL);
+			period = g_ascii_strtod(period_value, NULL);
+
+			/* -1 means no quota */
+			if (quota > 0 && period > 0)
+			    cgroup_set_cpu_quota(limits, quota / period);
+		    }
+
+		    g_free(value);
+		    g_free(period_value);
+		}
+
+		if (dirs) {
+		    cgroup_free_hierarchy(dirs);
+		    break;
+		}
+	    }
+	} else if (g_str_equal(names[i], "cpuset")) {
+	    mount = g_build_filename(CGROUP_ROOT, "cpuset", NULL);
+	    dirs = cgroup_get_hierarchy(mount, path);
+	    g_free(mount);
+
+	    for (l = dirs; l; l = l->next) {
+		if (!(value = cgroup_read(l->data, "cpuset.effective_cpus")))
+		    value = cgroup_read(l->data, "cpuset.cpus");
+		cgroup_set_cpuset(limits, value);
+	    }
+	    cgroup_free_hierarchy(dirs);
+	} else if (g_str_equal(names[i], "memory")) {
+	    mount = g_build_filename(CGROUP_ROOT, "memory", NULL);
+	    dirs = cgroup_get_hierarchy(mount, path);
+	    g_free(mount);
+
+	    for (l = dirs; l; l = l->next) {
+		if ((value = cgroup_read(l->data, "memory.limit_in_bytes"))) {
+		    max = g_ascii_strtoull(value, NULL, 10);
+		    if (max < CGROUP_V1_UNLIMITED)
+			cgroup_set_memory_max(limits, max);
+		    g_free(value);
+		}
+	    }
+	    cgroup_free_hierarchy(dirs);
+	}
+    }
+    g_strfreev(names);
+}
+
+static void cgroup_get_limits(CgroupLimits * limits)
+{
+    gchar *contents, **lines, **fields;
+    gint i;
+
+    memset(limits, 0, sizeof(CgroupLimits));
+
+    if (!g_file_get_contents("/proc/self/cgroup", &contents, NULL, NULL))
+	return;
+
+    /* "0::/path" for v2, "<id>:<controllers>:/path" for v1 */
+    lines = g_strsplit(contents, "\n", 0);
+    for (i = 0; lines[i]; i++) {
+	fields = g_strsplit(lines[i], ":", 3);
+
+	if (fields[0] && fields[1] && fields[2]) {
+	    if (!*fields[1]) {
+		if (g_file_test(CGROUP_ROOT "/cgroup.controllers",
+				G_FILE_TEST_EXISTS)) {
+		    cgroup_read_v2(limits, fields[2]);
+		    limits->version = 2;
+
+		    g_free(limits->path);
+		    limits->path = g_strdup(fields[2]);
+		}
+	    } else if (limits->version != 2) {
+		cgroup_read_v1(limits, fields[1], fields[2]);
+		limits->version = 1;
+
+		/* the controllers may sit in different groups */
+		if (!limits->path || g_str_equal(limits->path, "/")) {
+		    g_free(limits->path);
+		    limits->path = g_strdup(fields[2]);
+		}
+	    }
+	}
+
+	g_strfreev(fields);
+    }
+    g_strfreev(lines);
+    g_free(contents);
+}
+
+static void cgroup_limits_free(CgroupLimits * limits)
+{
+    g_free(limits->path);
+    g_free(limits->cpuset);
+}
+
+/* Key=Value lines, as in the environment snapshot */
+static gchar *cgroup_get_info(CgroupLimits * limits)
+{
+    gchar *info;
+
+    if (!limits->version)
+	return g_strdup("Cgroup=None\n");
+
+    info = g_strdup_printf("Cgroup=v%d %s\n", limits->version,
+			   limits->path ? limits->path : "");
+
+    if (limits->cpu_quota > 0)
+	info = h_strdup_cprintf("CPU Quota=%.2f processor(s)\n", info,
+				limits->cpu_quota);
+    else
+	info = h_strdup_cprintf("CPU Quota=None\n", info);
+
+    info = h_strdup_cprintf("Cpuset=%s\n", info,
+			    limits->cpuset ? limits->cpuset : "None");
+
+    if (limits->memory_max > 0)
+	info = h_strdup_cprintf("Memory Limit=%" G_GUINT64_FORMAT " MiB\n",
+				info, limits->memory_max / (1024 * 1024));
+    else
+	info = h_strdup_cprintf("Memory Limit=None\n", info);
+
+    return info;
+}
@@ -0,0 +1,321 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Splits the online processors into classes of identical cores, for
+ * hybrid (Intel P/E cores) and big.LITTLE machines. Cores are told apart
+ * by the scheduler's cpu_capacity, by the hybrid core type in CPUID leaf
+ * 0x1A and by their maximum frequency.
+ */
+
+#include <unistd.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+/* maximum frequencies closer than this are the same class (turbo bins) */
+#define CORECLASS_FREQ_TOLERANCE	0.10
+
+/* CPUID leaf 0x1A core types */
+#define CORECLASS_TYPE_ATOM	0x20
+#define CORECLASS_TYPE_CORE	0x40
+
+typedef struct _CoreClass CoreClass;
+
+struct _CoreClass {
+    gchar *name;
+    gint core_type;
+    gint capacity;
+    gint max_mhz;
+
+    gint n_cpus;
+    gint first_cpu;
+    gchar *cpu_list;		/* "0-7,16" */
+
+    gint range_first, range_last;
+};
+
+#if defined(__i386__) || defined(__x86_64__)
+/* the calling thread is moved to each processor in turn to ask it */
+static void coreclass_read_core_types(gint * types, gint n_cpus)
+{
+    CpuMask old_mask, mask;
+    guint eax, ebx, ecx, edx;
+    gint cpu;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)
+	|| !(edx & (1U << 15)))
+	return;
+
+    if (!cpu_mask_get_affinity(&old_mask))
+	return;
+
+    for (cpu = 0; cpu < n_cpus; cpu++) {
+	cpu_mask_clear(&mask);
+	cpu_mask_set(&mask, cpu);
+
+	if (!cpu_mask_set_affinity(&mask))
+	    continue;
+
+	__cpuid_count(0x1a, 0, eax, ebx, ecx, edx);
+	types[cpu] = eax >> 24;
+    }
+
+    cpu_mask_set_affinity(&old_mask);
+}
+#endif
+
+static gboolean coreclass_cpu_online(gint cpu)
+{
+    gchar *endpoint;
+    gchar *online;
+    gboolean result;
+
+    endpoint = g_strdup_printf("/sys/devices/system/cpu/cpu%d", cpu);
+    if (!g_file_test(endpoint, G_FILE_TEST_IS_DIR)) {
+	g_free(endpoint);
+	return FALSE;
+    }
+
+    /* cpu0 usually has no "online" file: it cannot be taken down */
+    online = h_sysfs_read_string(endpoint, "online");
+    result = !online || !g_str_equal(online, "0");
+
+    g_free(online);
+    g_free(endpoint);
+
+    return result;
+}
+
+static void coreclass_flush_range(CoreClass * class)
+{
+    gchar *range;
+
+    if (class->range_first == class->range_last)
+	range = g_strdup_printf("%d", class->range_first);
+    else
+	range = g_strdup_printf("%d-%d", class->range_first,
+				class->range_last);
+
+    if (class->cpu_list) {
+	gchar *tmp = g_strconcat(class->cpu_list, ",", range, NULL);
+
+	g_free(class->cpu_list);
+	g_free(range);
+	class->cpu_list = tmp;
+    } else {
+	class->cpu_list = range;
+    }
+}
+
+/* processors are always added in increasing order */
+static void coreclass_add_cpu(CoreClass * class, gint cpu)
+{
+    if (class->n_cpus++ == 0) {
+	class->first_cpu = class->range_first = class->range_last = cpu;
+	return;
+    }
+
+    if (cpu == class->range_last + 1) {
+	class->range_last = cpu;
+	return;
+    }
+
+    coreclass_flush_range(class);
+    class->range_first = class->range_last = cpu;
+}
+
+static gint coreclass_type_rank(gint core_type)
+{
+    switch (core_type) {
+    case CORECLASS_TYPE_CORE:
+	return 2;
+    case CORECLASS_TYPE_ATOM:
+	return 1;
+    default:
+	return 0;
+    }
+}
+
+/* fastest class first */
+static gint coreclass_compare(gconstpointer a, gconstpointer b)
+{
+    const CoreClass *ca = (const CoreClass *) a;
+    const CoreClass *cb = (const CoreClass *) b;
+
+    if (ca->capacity != cb->capacity)
+	return cb->capacity - ca->capacity;
+    if (ca->core_type != cb->core_type)
+	return coreclass_type_rank(cb->core_type) -
+	    coreclass_type_rank(ca->core_type);
+
+    return cb->max_mhz - ca->max_mhz;
+}
+
+static void coreclass_name(GSList * classes)
+{
+    static const gchar *arm_names[] = { "Prime", "big", "LITTLE" };
+    GSList *l;
+    gint n_classes = g_slist_length(classes), i;
+
+    for (i = 0, l = classes; l; l = l->next, i++) {
+	CoreClass *class = (CoreClass *) l->data;
+	const gchar *name;
+	GSList *p;
+
+	switch (class->core_type) {
+	case CORECLASS_TYPE_CORE:
+	    name = "Performance";
+	    break;
+	case CORECLASS_TYPE_ATOM:
+	    name = "Efficiency";
+	    break;
+	default:
+	    if (n_classes == 1)
+		name = "All";
+	    else if (n_classes <= 3)
+		name = arm_names[3 - n_classes + i];
+	    else
+		name = NULL;
+	}
+
+	if (!name) {
+	    class->name = g_strdup_printf("Class %d", i + 1);
+	    continue;
+	}
+
+	/* e.g. the low power E-cores, same type as the others but slower */
+	for (p = classes; p != l; p = p->next) {
+	    if (g_str_has_prefix(((CoreClass *) p->data)->name, name))
+		break;
+	}
+
+	if (p != l)
+	    class->name = g_strdup_printf("%s (%d MHz)", name, class->max_mhz);
+	else
+	    class->name = g_strdup(name);
+    }
+}
+
+/*
+ * Returns the classes of online processors, fastest first; a machine
+ * with identical cores has a single class.
+ */
+static GSList *coreclass_scan(void)
+{
+    GSList *classes = NULL, *l;
+    gint types[CPU_MASK_MAX_CPUS];
+    glong n_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    gint cpu;
+
+    if (n_cpus <= 0)
+	n_cpus = 1;
+    if (n_cpus > CPU_MASK_MAX_CPUS)
+	n_cpus = CPU_MASK_MAX_CPUS;
+
+    memset(types, 0, sizeof(types));
+#if defined(__i386__) || defined(__x86_64__)
+    coreclass_read_core_types(types, n_cpus);
+#endif
+
+    for (cpu = 0; cpu < n_cpus; cpu++) {
+	CoreClass *class = NULL;
+	gchar *endpoint;
+	gint capacity, max_mhz;
+
+	if (!coreclass_cpu_online(cpu))
+	    continue;
+
+	endpoint = g_strdup_printf("/sys/devices/system/cpu/cpu%d", cpu);
+	capacity = h_sysfs_read_int(endpoint, "cpu_capacity");
+	max_mhz = h_sysfs_read_int(endpoint, "cpufreq/cpuinfo_max_freq") / 1000;
+	g_free(endpoint);
+
+	for (l = classes; l; l = l->next) {
+	    CoreClass *c = (CoreClass *) l->data;
+
+	    if (c->core_type == types[cpu] && c->capacity == capacity
+		&& ABS(c->max_mhz - max_mhz) <=
+		CORECLASS_FREQ_TOLERANCE * MAX(c->max_mhz, max_mhz)) {
+		class = c;
+		break;
+	    }
+	}
+
+	if (!class) {
+	    class = g_new0(CoreClass, 1);
+	    class->core_type = types[cpu];
+	    class->capacity = capacity;
+	    class->max_mhz = max_mhz;
+
+	    classes = g_slist_append(classes, class);
+	}
+
+	class->max_mhz = MAX(class->max_mhz, max_mhz);
+	coreclass_add_cpu(class, cpu);
+    }
+
+    for (l = classes; l; l = l->next)
+	coreclass_flush_range((CoreClass *) l->data);
+
+    classes = g_slist_sort(classes, coreclass_compare);
+    coreclass_name(classes);
+
+    return classes;
+}
+
+static void coreclass_free(GSList * classes)
+{
+    GSList *l;
+
+    for (l = classes; l; l = l->next) {
+	CoreClass *class = (CoreClass *) l->data;
+
+	g_free(class->name);
+	g_free(class->cpu_list);
+	g_free(class);
+    }
+
+    g_slist_free(classes);
+}
+
+/* a [Core Classes] section, or an empty string if all cores are alike */
+static gchar *coreclass_get_info(GSList * classes)
+{
+    gchar *info;
+    GSList *l;
+
+    if (g_slist_length(classes) < 2)
+	return g_strdup("");
+
+    info = g_strdup("[Core Classes]\n");
+    for (l = classes; l; l = l->next) {
+	CoreClass *class = (CoreClass *) l->data;
+
+	info = h_strdup_cprintf("%s=%d processor(s) (%s)", info,
+				class->name, class->n_cpus, class->cpu_list);
+	if (class->max_mhz > 0)
+	    info = h_strdup_cprintf(", up to %d MHz", info, class->max_mhz);
+	if (class->capacity > 0)
+	    info = h_strdup_cprintf(", capacity %d", info, class->capacity);
+	info = h_strdup_cprintf("\n", info);
+    }
+
+    return info;
+}
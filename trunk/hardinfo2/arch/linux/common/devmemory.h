@@ -20,7 +20,10 @@ static GHashTable *memlabels;
 
 static void __scan_memory()
 {
-    gchar **keys, *tmp;
+    Arena *arena;
+    GString *info, *interval;
+    gchar *contents, **keys, *value;
+    const gchar *key, *label;
     static gint offset = -1;
     gint i;
     
@@ -32,45 +35,40 @@ static void __scan_memory()
         g_free(os_kernel);
     }
     
-    g_file_get_contents("/proc/meminfo", &meminfo, NULL, NULL);
+    if (!g_file_get_contents("/proc/meminfo", &contents, NULL, NULL))
+        return;
     
-    keys = g_strsplit(meminfo, "\n", 0);
-
-    g_free(meminfo);
-    g_free(lginterval);
+    /* rescanned every two seconds; the lines go away with the arena */
+    arena = arena_new();
+    keys = arena_strsplit(arena, contents, "\n", 0);
+    g_free(contents);
     
-    meminfo = g_strdup("");
-    lginterval = g_strdup("");
+    info = g_string_new("");
+    interval = g_string_new("");
     
-    for (i = offset; keys[i]; i++) {
-        gchar **newkeys = g_strsplit(keys[i], ":", 0);
-        
-        if (!newkeys[0]) {
-            g_strfreev(newkeys);
-            break;
-        }
-        
-        g_strstrip(newkeys[1]);
+    for (i = 0; i < offset && keys[i]; i++);
+    
+    for (; keys[i]; i++) {
+        if (!arena_split_pair(arena, keys[i], ':', &key, &value))
+            continue;
         
-        if ((tmp = g_hash_table_lookup(memlabels, newkeys[0]))) {
-            g_free(newkeys[0]);
-            newkeys[0] = g_strdup(tmp);
+        if ((label = g_hash_table_lookup(memlabels, key))) {
+            key = label;
         }
         
-        g_hash_table_replace(moreinfo, g_strdup(newkeys[0]), g_strdup(newkeys[1]));
+        g_hash_table_replace(moreinfo, g_strdup(key), g_strdup(value));
 
-        tmp = g_strconcat(meminfo, newkeys[0], "=", newkeys[1], "\n", NULL);
-        g_free(meminfo);
-        meminfo = tmp;
-        
-        tmp = g_strconcat(lginterval,
-                          "UpdateInterval$", newkeys[0], "=1000\n", NULL);
-        g_free(lginterval);
-        lginterval = tmp;
-
-        g_strfreev(newkeys);
+        g_string_append_printf(info, "%s=%s\n", key, value);
+        g_string_append_printf(interval, "UpdateInterval$%s=1000\n", key);
     }
-    g_strfreev(keys);
+    
+    arena_free(arena);
+    
+    g_free(meminfo);
+    g_free(lginterval);
+    
+    meminfo = g_string_free(info, FALSE);
+    lginterval = g_string_free(interval, FALSE);
 }
 
 static void __init_memory_labels(void)
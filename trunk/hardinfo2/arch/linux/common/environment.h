@@ -0,0 +1,313 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Everything outside the benchmark that moves its result: kernel and its
+ * command line, mitigations, microcode, THP, cpufreq, SMT and turbo state,
+ * memory speed and load. Returned as Key=Value lines, one per setting.
+ */
+
+#include <sys/utsname.h>
+
+#define ENVIRONMENT_CPU		"/sys/devices/system/cpu"
+
+static gchar *environment_read_line(const gchar * file)
+{
+    gchar *contents, *newline;
+
+    if (!g_file_get_contents(file, &contents, NULL, NULL))
+	return NULL;
+
+    if ((newline = strchr(contents, '\n')))
+	*newline = '\0';
+
+    return g_strstrip(contents);
+}
+
+/* "always [madvise] never" -> "madvise" */
+static gchar *environment_read_selected(const gchar * file)
+{
+    gchar *contents, *start, *end, *selected = NULL;
+
+    if (!(contents = environment_read_line(file)))
+	return NULL;
+
+    if ((start = strchr(contents, '[')) && (end = strchr(start, ']')))
+	selected = g_strndup(start + 1, end - start - 1);
+
+    g_free(contents);
+
+    return selected;
+}
+
+/* the second parenthesised group of /proc/version names the compiler */
+static gchar *environment_kernel_compiler(void)
+{
+    gchar *version, *p, *start = NULL, *compiler = NULL;
+    gint depth = 0, group = 0;
+
+    if (!(version = environment_read_line("/proc/version")))
+	return NULL;
+
+    for (p = version; *p; p++) {
+	if (*p == '(' && depth++ == 0) {
+	    start = p + 1;
+	} else if (*p == ')' && depth > 0 && --depth == 0 && ++group == 2) {
+	    compiler = g_strndup(start, p - start);
+	    break;
+	}
+    }
+
+    g_free(version);
+
+    return compiler;
+}
+
+/* what the kernel configuration says about code generation */
+static gchar *environment_kernel_flags(const gchar * release)
+{
+    static const struct {
+	const gchar *option, *flag;
+    } options[] = {
+	{"CONFIG_CC_OPTIMIZE_FOR_PERFORMANCE=y", "-O2"},
+	{"CONFIG_CC_OPTIMIZE_FOR_PERFORMANCE_O3=y", "-O3"},
+	{"CONFIG_CC_OPTIMIZE_FOR_SIZE=y", "-Os"},
+	{"CONFIG_LTO_CLANG_FULL=y", "full LTO"},
+	{"CONFIG_LTO_CLANG_THIN=y", "thin LTO"},
+	{"CONFIG_X86_NATIVE_CPU=y", "-march=native"},
+	{"CONFIG_MNATIVE_INTEL=y", "-march=native"},
+	{"CONFIG_MNATIVE_AMD=y", "-march=native"},
+	{"CONFIG_GENERIC_CPU2=y", "-march=x86-64-v2"},
+	{"CONFIG_GENERIC_CPU3=y", "-march=x86-64-v3"},
+	{"CONFIG_GENERIC_CPU4=y", "-march=x86-64-v4"},
+	{NULL, NULL}
+    };
+    gchar *path, *config, **lines, *flags = NULL;
+    gint i, j;
+
+    path = g_strdup_printf("/boot/config-%s", release);
+    if (!g_file_get_contents(path, &config, NULL, NULL)) {
+	g_free(path);
+	return NULL;
+    }
+    g_free(path);
+
+    lines = g_strsplit(config, "\n", 0);
+    for (i = 0; lines[i]; i++) {
+	for (j = 0; options[j].option; j++) {
+	    if (!g_str_equal(lines[i], options[j].option))
+		continue;
+
+	    flags = flags ? h_strconcat(flags, " ", options[j].flag, NULL)
+		: g_strdup(options[j].flag);
+	}
+    }
+
+    g_strfreev(lines);
+    g_free(config);
+
+    return flags;
+}
+
+static gchar *environment_microcode(void)
+{
+    FILE *cpuinfo;
+    gchar buffer[256], *microcode = NULL;
+
+    if ((microcode = environment_read_line(ENVIRONMENT_CPU
+					   "/cpu0/microcode/version")))
+	return microcode;
+
+    if (!(cpuinfo = fopen("/proc/cpuinfo", "r")))
+	return NULL;
+
+    while (fgets(buffer, sizeof(buffer), cpuinfo)) {
+	gchar **tmp = g_strsplit(buffer, ":", 2);
+
+	if (tmp[0] && tmp[1] && g_str_equal(g_strstrip(tmp[0]), "microcode"))
+	    microcode = g_strdup(g_strstrip(tmp[1]));
+
+	g_strfreev(tmp);
+	if (microcode)
+	    break;
+    }
+    fclose(cpuinfo);
+
+    return microcode;
+}
+
+static gchar *environment_turbo(void)
+{
+    gchar *value;
+    gboolean enabled;
+
+    /* intel_pstate says it the other way around */
+    if ((value = environment_read_line(ENVIRONMENT_CPU
+				       "/intel_pstate/no_turbo"))) {
+	enabled = atoi(value) == 0;
+    } else if ((value = environment_read_line(ENVIRONMENT_CPU
+					      "/cpufreq/boost"))) {
+	enabled = atoi(value) != 0;
+    } else {
+	return NULL;
+    }
+
+    g_free(value);
+
+    return g_strdup(enabled ? "Enabled" : "Disabled");
+}
+
+/*
+ * Reads the speeds of the populated memory devices (SMBIOS type 17) from
+ * the raw DMI table, which is only readable by root.
+ */
+static gchar *environment_memory_speed(void)
+{
+    guchar *table, *p, *end, *next;
+    gsize length;
+    gchar *speed = NULL;
+
+    if (!g_file_get_contents("/sys/firmware/dmi/tables/DMI",
+			     (gchar **) & table, &length, NULL))
+	return NULL;
+
+    for (p = table, end = table + length; p + 4 <= end && p[1] >= 4;
+	 p = next) {
+	guint type = p[0], len = p[1], size, rated = 0, configured = 0;
+
+	/* the formatted area is followed by strings, ending in two NULs */
+	for (next = p + len; next + 1 < end && (next[0] || next[1]); next++);
+	next += 2;
+
+	if (type == 127 || p + len > end)
+	    break;
+	if (type != 17 || len < 0x17)
+	    continue;
+
+	size = p[0x0c] | (p[0x0d] << 8);
+	if (size == 0 || size == 0xffff)
+	    continue;
+
+	rated = p[0x15] | (p[0x16] << 8);
+	if (len >= 0x22)
+	    configured = p[0x20] | (p[0x21] << 8);
+
+	if (!rated)
+	    continue;
+
+	if (configured && configured != rated)
+	    speed = g_strdup_printf("%d MT/s (rated %d MT/s)", configured,
+				    rated);
+	else
+	    speed = g_strdup_printf("%d MT/s", rated);
+	break;
+    }
+
+    g_free(table);
+
+    return speed;
+}
+
+static gchar *environment_vulnerabilities(gchar * snapshot)
+{
+    GDir *dir;
+    GSList *names = NULL, *l;
+    const gchar *name;
+    gchar *path, *state;
+
+    if (!(dir = g_dir_open(ENVIRONMENT_CPU "/vulnerabilities", 0, NULL)))
+	return snapshot;
+
+    while ((name = g_dir_read_name(dir)))
+	names = g_slist_insert_sorted(names, g_strdup(name),
+				      (GCompareFunc) strcmp);
+    g_dir_close(dir);
+
+    for (l = names; l; l = l->next) {
+	path = g_strdup_printf(ENVIRONMENT_CPU "/vulnerabilities/%s",
+			       (gchar *) l->data);
+	state = environment_read_line(path);
+
+	snapshot = h_strdup_cprintf("Vulnerability %s=%s\n", snapshot,
+				    (gchar *) l->data,
+				    state ? state : "Unknown");
+
+	g_free(state);
+	g_free(path);
+	g_free(l->data);
+    }
+    g_slist_free(names);
+
+    return snapshot;
+}
+
+static gchar *environment_snapshot(void)
+{
+    struct utsname un;
+    gchar *snapshot, *value;
+    gint i;
+    struct {
+	const gchar *key;
+	gchar *value;
+    } items[] = {
+	{"Kernel Version", NULL},
+	{"Kernel Command Line", environment_read_line("/proc/cmdline")},
+	{"Kernel Compiler", environment_kernel_compiler()},
+	{"Kernel Build Flags", NULL},
+	{"Microcode", environment_microcode()},
+	{"Transparent Huge Pages",
+	 environment_read_selected("/sys/kernel/mm/transparent_hugepage/"
+				   "enabled")},
+	{"CPU Frequency Driver",
+	 environment_read_line(ENVIRONMENT_CPU "/cpu0/cpufreq/scaling_driver")},
+	{"CPU Frequency Governor",
+	 environment_read_line(ENVIRONMENT_CPU
+			       "/cpu0/cpufreq/scaling_governor")},
+	{"SMT", environment_read_line(ENVIRONMENT_CPU "/smt/control")},
+	{"Turbo", environment_turbo()},
+	{"Memory Speed", environment_memory_speed()},
+	{"Load Average", environment_read_line("/proc/loadavg")},
+    };
+
+    if (uname(&un) == 0) {
+	items[0].value = g_strdup_printf("%s %s", un.release, un.version);
+	items[3].value = environment_kernel_flags(un.release);
+    }
+
+    /* only the 1, 5 and 15 minute averages */
+    if ((value = items[G_N_ELEMENTS(items) - 1].value)) {
+	gchar **fields = g_strsplit(value, " ", 4);
+
+	if (fields[0] && fields[1] && fields[2]) {
+	    g_free(value);
+	    items[G_N_ELEMENTS(items) - 1].value =
+		g_strdup_printf("%s %s %s", fields[0], fields[1], fields[2]);
+	}
+	g_strfreev(fields);
+    }
+
+    snapshot = g_strdup("");
+    for (i = 0; i < G_N_ELEMENTS(items); i++) {
+	snapshot = h_strdup_cprintf("%s=%s\n", snapshot, items[i].key,
+				    items[i].value ? items[i].value :
+				    "Unknown");
+	g_free(items[i].value);
+    }
+
+    return environment_vulnerabilities(snapshot);
+}
@@ -18,12 +18,6 @@
 
 static gchar *input_icons = NULL;
 
-static gboolean
-remove_input_devices(gpointer key, gpointer value, gpointer data)
-{
-    return g_str_has_prefix(key, "INP");
-}
-
 static struct {
     char *name;
     char *icon;
@@ -39,8 +33,8 @@ void
 __scan_input_devices(void)
 {
     FILE *dev;
-    gchar buffer[128];
-    gchar *tmp, *name = NULL, *phys = NULL;
+    gchar buffer[256];
+    gchar *tmp, *name = NULL, *phys = NULL, *sysfs = NULL;
     gint bus, vendor, product, version;
     int d = 0, n = 0;
 
@@ -48,15 +42,13 @@ __scan_input_devices(void)
     if (!dev)
 	return;
 
-    if (input_list) {
-	g_hash_table_foreach_remove(moreinfo, remove_input_devices, NULL);
-	g_free(input_list);
-	g_free(input_icons);
-    }
+    device_registry_begin_scan(input_registry);
+    g_free(input_list);
+    g_free(input_icons);
     input_list = g_strdup("");
     input_icons = g_strdup("");
 
-    while (fgets(buffer, 128, dev)) {
+    while (fgets(buffer, 256, dev)) {
 	tmp = buffer;
 
 	switch (*tmp) {
@@ -67,6 +59,13 @@ __scan_input_devices(void)
 	case 'P':
 	    phys = g_strdup(tmp + strlen("P: Phys="));
 	    break;
+	case 'S':
+	    /* the input class name (input3) stays the same until unplugged */
+	    if (g_str_has_prefix(tmp, "S: Sysfs=")) {
+		g_free(sysfs);
+		sysfs = g_path_get_basename(g_strstrip(tmp + strlen("S: Sysfs=")));
+	    }
+	    break;
 	case 'I':
 	    sscanf(tmp, "I: Bus=%x Vendor=%x Product=%x Version=%x",
 		   &bus, &vendor, &product, &version);
@@ -86,11 +85,16 @@ __scan_input_devices(void)
 	      d = 3;		// INPUT_PCSPKR
 	    }
 	
-	    tmp = g_strdup_printf("INP%d", ++n);
-	    input_list = h_strdup_cprintf("$%s$%s=\n",
+	    n++;
+	    if (sysfs && !device_registry_seen(input_registry, sysfs))
+		tmp = g_strdup(sysfs);
+	    else
+		tmp = g_strdup_printf("%d", n);
+
+	    input_list = h_strdup_cprintf("$INP%s$%s=\n",
 					 input_list,
 					 tmp, name);
-	    input_icons = h_strdup_cprintf("Icon$%s$%s=%s\n",
+	    input_icons = h_strdup_cprintf("Icon$INP%s$%s=%s\n",
 				 	  input_icons,
 					  tmp, name,
 					  input_devices[d].icon);
@@ -124,12 +128,17 @@ __scan_input_devices(void)
 				 	     strhash);
 	    }
 	    
-	    g_hash_table_insert(moreinfo, tmp, strhash);
+	    device_registry_set(input_registry, tmp, strhash);
 
+	    g_free(tmp);
 	    g_free(phys);
 	    g_free(name);
+	    g_free(sysfs);
+	    sysfs = NULL;
 	}
     }
 
     fclose(dev);
+
+    device_registry_end_scan(input_registry);
 }
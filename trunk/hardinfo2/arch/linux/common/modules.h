@@ -23,16 +23,75 @@
     continue;                        					\
   }
 
-static gboolean
-remove_module_devices(gpointer key, gpointer value, gpointer data)
+#define NONE_IF_NULL(var) (var) ? (var) : "N/A"
+
+/* what lsmod and modinfo say; the details are formatted on demand */
+typedef struct _KernelModule KernelModule;
+
+struct _KernelModule {
+    gchar *name;
+    glong memory;
+    gchar *author, *description, *license, *deps, *vermagic, *filename;
+};
+
+static void
+kernel_module_free(KernelModule *km)
 {
-    return g_str_has_prefix(key, "MOD");
+    g_free(km->name);
+    g_free(km->author);
+    g_free(km->description);
+    g_free(km->license);
+    g_free(km->deps);
+    g_free(km->vermagic);
+    g_free(km->filename);
+    g_free(km);
+}
+
+static gchar *
+kernel_module_get_detail(KernelModule *km)
+{
+    gchar *strmodule;
+
+    /* create the module information string */
+    strmodule = g_strdup_printf("[Module Information]\n"
+				"Path=%s\n"
+				"Used Memory=%.2fKiB\n"
+				"[Description]\n"
+				"Name=%s\n"
+				"Description=%s\n"
+				"Version Magic=%s\n"
+				"[Copyright]\n"
+				"Author=%s\n"
+				"License=%s\n",
+				NONE_IF_NULL(km->filename),
+				km->memory / 1024.0,
+				km->name,
+				NONE_IF_NULL(km->description),
+				NONE_IF_NULL(km->vermagic),
+				NONE_IF_NULL(km->author),
+				NONE_IF_NULL(km->license));
+
+    /* if there are dependencies, append them to that string */
+    if (km->deps && strlen(km->deps)) {
+	gchar **tmp = g_strsplit(km->deps, ",", 0);
+	gchar *deps = g_strjoinv("=\n", tmp);
+
+	strmodule = h_strconcat(strmodule,
+				"\n[Dependencies]\n",
+				deps,
+				"=\n", NULL);
+	g_free(deps);
+	g_strfreev(tmp);
+    }
+
+    return strmodule;
 }
 
 static void
 scan_modules_do(void)
 {
     FILE *lsmod;
+    GString *list;
     gchar buffer[1024];
 
     if (module_list) {
@@ -40,16 +99,20 @@ scan_modules_do(void)
     }
     
     module_list = NULL;
-    g_hash_table_foreach_remove(moreinfo, remove_module_devices, NULL);
+    device_registry_begin_scan(module_registry);
 
     lsmod = popen("/sbin/lsmod", "r");
-    if (!lsmod)
+    if (!lsmod) {
+	device_registry_end_scan(module_registry);
 	return;
+    }
 
     fgets(buffer, 1024, lsmod);	/* Discards the first line */
+    list = g_string_new("");
 
     while (fgets(buffer, 1024, lsmod)) {
-	gchar *buf, *strmodule, *hashkey;
+	gchar *buf;
+	KernelModule *km;
 	gchar *author = NULL,
 	    *description = NULL,
 	    *license = NULL,
@@ -63,7 +126,6 @@ scan_modules_do(void)
 
 	sscanf(buf, "%s %ld", modname, &memory);
 
-	hashkey = g_strdup_printf("MOD%s", modname);
 	buf = g_strdup_printf("/sbin/modinfo %s 2>/dev/null", modname);
 
 	modi = popen(buf, "r");
@@ -98,52 +160,27 @@ scan_modules_do(void)
 	}
 
 	/* append this module to the list of modules */
-	module_list = h_strdup_cprintf("$%s$%s=%s\n",
-				      module_list,
-				      hashkey,
-				      modname,
-				      description ? description : "");
-
-#define NONE_IF_NULL(var) (var) ? (var) : "N/A"
-
-	/* create the module information string */
-	strmodule = g_strdup_printf("[Module Information]\n"
-				    "Path=%s\n"
-				    "Used Memory=%.2fKiB\n"
-				    "[Description]\n"
-				    "Name=%s\n"
-				    "Description=%s\n"
-				    "Version Magic=%s\n"
-				    "[Copyright]\n"
-				    "Author=%s\n"
-				    "License=%s\n",
-				    NONE_IF_NULL(filename),
-				    memory / 1024.0,
-				    modname,
-				    NONE_IF_NULL(description),
-				    NONE_IF_NULL(vermagic),
-				    NONE_IF_NULL(author),
-				    NONE_IF_NULL(license));
-
-	/* if there are dependencies, append them to that string */
-	if (deps && strlen(deps)) {
-	    gchar **tmp = g_strsplit(deps, ",", 0);
-
-	    strmodule = h_strconcat(strmodule,
-                                    "\n[Dependencies]\n",
-                                    g_strjoinv("=\n", tmp),
-                                    "=\n", NULL);
-	    g_strfreev(tmp);
-	    g_free(deps);
-	}
-
-	g_hash_table_insert(moreinfo, hashkey, strmodule);
-
-	g_free(license);
-	g_free(description);
-	g_free(author);
-	g_free(vermagic);
-	g_free(filename);
+	g_string_append_printf(list, "$MOD%s$%s=", modname, modname);
+	if (description)
+	    h_string_append_escaped(list, description,
+				    H_ESCAPE_KEY_FILE_VALUE);
+	g_string_append_c(list, '\n');
+
+	km = g_new0(KernelModule, 1);
+	km->name = g_strdup(modname);
+	km->memory = memory;
+	km->author = author;
+	km->description = description;
+	km->license = license;
+	km->deps = deps;
+	km->vermagic = vermagic;
+	km->filename = filename;
+
+	device_registry_set_data(module_registry, modname, km);
     }
     pclose(lsmod);
+
+    device_registry_end_scan(module_registry);
+
+    module_list = g_string_free(list, FALSE);
 }
@@ -16,13 +16,82 @@
  *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+/* what lspci says about a device; its details are formatted on demand */
+typedef struct _PCIDevice PCIDevice;
+
+struct _PCIDevice {
+    gchar *name, *category;
+    gint domain, bus, device, function;
+    gchar *oem;			/* the subsystem vendor */
+    GString *resources;		/* IRQ, memory, I/O and capability lines */
+};
+
+static void
+pci_device_free(PCIDevice *pci)
+{
+    g_free(pci->name);
+    g_free(pci->category);
+    g_free(pci->oem);
+    g_string_free(pci->resources, TRUE);
+    g_free(pci);
+}
+
+static gchar *
+pci_device_get_detail(PCIDevice *pci)
+{
+    GString *detail;
+    const gchar *url;
+
+    detail = g_string_new("[Device Information]\n");
+    g_string_append_printf(detail,
+                           "Name=%s\n"
+                           "Class=%s\n"
+                           "Domain=%d\n"
+                           "Bus, device, function=%d, %d, %d\n",
+                           pci->name, pci->category, pci->domain, pci->bus,
+                           pci->device, pci->function);
+
+    if ((url = vendor_get_url(pci->name)))
+        g_string_append_printf(detail, "Vendor=%s (%s)\n",
+                               vendor_get_name(pci->name), url);
+    if (pci->oem && (url = vendor_get_url(pci->oem)))
+        g_string_append_printf(detail, "OEM Vendor=%s (%s)\n",
+                               vendor_get_name(pci->oem), url);
+
+    g_string_append(detail, pci->resources->str);
+
+    return g_string_free(detail, FALSE);
+}
+
+static void
+pci_device_add(GString *list, PCIDevice *pci)
+{
+    gchar *id;
+
+    id = g_strdup_printf("%04x:%02x:%02x.%d",
+                         pci->domain, pci->bus, pci->device, pci->function);
+    g_string_append_printf(list, "$PCI%s$", id);
+    h_string_append_escaped(list, pci->category, H_ESCAPE_KEY_FILE_KEY);
+    g_string_append_c(list, '=');
+    h_string_append_escaped(list, pci->name, H_ESCAPE_KEY_FILE_VALUE);
+    g_string_append_c(list, '\n');
+    device_registry_set_data(pci_registry, id, pci);
+    g_free(id);
+}
+
 void
 __scan_pci(void)
 {
     FILE *lspci;
-    gchar buffer[256], *buf, *strhash = NULL, *strdevice = NULL;
-    gchar *category = NULL, *name = NULL, *icon;
-    gint n = 0, x = 0;
+    GString *list;
+    PCIDevice *pci = NULL;
+    gchar buffer[256], *buf;
+    gint x = 0;
+
+    /* devices are keyed by their bus address, which survives a rescan */
+    device_registry_begin_scan(pci_registry);
+    g_free(pci_list);
+    list = g_string_new("");
 
     buf = g_build_filename(g_get_home_dir(), ".hardinfo", "pci.ids", NULL);
     if (!g_file_test(buf, G_FILE_TEST_EXISTS)) {
@@ -50,7 +119,45 @@ __scan_pci(void)
     while (fgets(buffer, 256, lspci)) {
 	buf = g_strstrip(buffer);
 
-	if (!strncmp(buf, "Flags", 5)) {
+	if ((buf[0] >= '0' && buf[0] <= '9') && (buf[4] == ':' || buf[2] == ':')) {
+	    gpointer start, end;
+
+	    if (pci)
+		pci_device_add(list, pci);
+
+	    pci = g_new0(PCIDevice, 1);
+	    pci->resources = g_string_new("");
+
+	    if (buf[4] == ':') {
+		sscanf(buf, "%x:%x:%x.%d", &pci->domain, &pci->bus,
+		       &pci->device, &pci->function);
+	    } else {
+	    	/* lspci without domain field */
+	    	sscanf(buf, "%x:%x.%x", &pci->bus, &pci->device,
+		       &pci->function);
+	    }
+
+	    WALK_UNTIL(' ');
+
+	    start = buf;
+
+	    WALK_UNTIL(':');
+	    end = buf + 1;
+	    *buf = 0;
+
+	    buf = start + 1;
+	    pci->category = g_strdup(buf);
+
+	    buf = end;
+	    start = buf;
+	    WALK_UNTIL('(');
+	    *buf = 0;
+	    buf = start + 1;
+
+	    pci->name = g_strdup(buf);
+	} else if (!pci) {
+	    continue;
+	} else if (!strncmp(buf, "Flags", 5)) {
 	    gint irq = 0, freq = 0, latency = 0, i;
 	    gchar **list;
 	    gboolean bus_master;
@@ -76,29 +183,26 @@ __scan_pci(void)
 	    g_strfreev(list);
 
 	    if (irq)
-		strdevice = h_strdup_cprintf("IRQ=%d\n", strdevice, irq);
+		g_string_append_printf(pci->resources, "IRQ=%d\n", irq);
 	    if (freq)
-		strdevice = h_strdup_cprintf("Frequency=%dMHz\n", strdevice, freq);
+		g_string_append_printf(pci->resources, "Frequency=%dMHz\n", freq);
 	    if (latency)
-		strdevice = h_strdup_cprintf("Latency=%d\n", strdevice, latency);
+		g_string_append_printf(pci->resources, "Latency=%d\n", latency);
 
-	    strdevice = h_strdup_cprintf("Bus Master=%s\n", strdevice, bus_master ? "Yes" : "No");
+	    g_string_append_printf(pci->resources, "Bus Master=%s\n",
+				   bus_master ? "Yes" : "No");
 	} else if (!strncmp(buf, "Subsystem", 9)) {
 	    WALK_UNTIL(' ');
 	    buf++;
-	    const gchar *oem_vendor_url = vendor_get_url(buf);
-            if (oem_vendor_url) 
-                strdevice = h_strdup_cprintf("OEM Vendor=%s (%s)\n",
-                                            strdevice,
-                                            vendor_get_name(buf),
-                                            oem_vendor_url);
+	    g_free(pci->oem);
+	    pci->oem = g_strdup(buf);
 	} else if (!strncmp(buf, "Capabilities", 12)
 		   && !strstr(buf, "only to root") && 
 		      !strstr(buf, "access denied")) {
 	    WALK_UNTIL(' ');
 	    WALK_UNTIL(']');
 	    buf++;
-	    strdevice = h_strdup_cprintf("Capability#%d=%s\n", strdevice, ++x, buf);
+	    g_string_append_printf(pci->resources, "Capability#%d=%s\n", ++x, buf);
 	} else if (!strncmp(buf, "Memory at", 9) && strstr(buf, "[size=")) {
 	    gint mem;
 	    gchar unit;
@@ -111,97 +215,38 @@ __scan_pci(void)
 	    WALK_UNTIL('[');
 	    sscanf(buf, "[size=%d%c", &mem, &unit);
 
-	    strdevice = h_strdup_cprintf("Memory#%d=%d%cB (%s%s)\n",
-					strdevice, ++x,
-					mem,
-					(unit == ']') ? ' ' : unit,
-					_32bit ? "32-bit, " : "",
-					prefetch ? "prefetchable" :
-					"non-prefetchable");
+	    g_string_append_printf(pci->resources,
+				   "Memory#%d=%d%cB (%s%s)\n",
+				   ++x,
+				   mem,
+				   (unit == ']') ? ' ' : unit,
+				   _32bit ? "32-bit, " : "",
+				   prefetch ? "prefetchable" :
+				   "non-prefetchable");
 
 	} else if (!strncmp(buf, "I/O", 3)) {
 	    guint io_addr, io_size;
 
 	    sscanf(buf, "I/O ports at %x [size=%d]", &io_addr, &io_size);
 
-	    strdevice =
-		h_strdup_cprintf("I/O ports at#%d=0x%x - 0x%x\n",
-				strdevice, ++x, io_addr,
-				io_addr + io_size);
-	} else if ((buf[0] >= '0' && buf[0] <= '9') && (buf[4] == ':' || buf[2] == ':')) {
-	    gint bus, device, function, domain;
-	    gpointer start, end;
-
-	    if (strdevice != NULL && strhash != NULL) {
-		g_hash_table_insert(moreinfo, strhash, strdevice);
-                g_free(category);
-                g_free(name);
-	    }
-
-	    if (buf[4] == ':') {
-		sscanf(buf, "%x:%x:%x.%d", &domain, &bus, &device, &function);
-	    } else {
-	    	/* lspci without domain field */
-	    	sscanf(buf, "%x:%x.%x", &bus, &device, &function);
-	    	domain = 0;
-	    }
-
-	    WALK_UNTIL(' ');
-
-	    start = buf;
-
-	    WALK_UNTIL(':');
-	    end = buf + 1;
-	    *buf = 0;
-
-	    buf = start + 1;
-	    category = g_strdup(buf);
-
-	    buf = end;
-	    start = buf;
-	    WALK_UNTIL('(');
-	    *buf = 0;
-	    buf = start + 1;
-
-            if (strstr(category, "RAM memory")) icon = "mem";
-            else if (strstr(category, "Multimedia")) icon = "media";
-            else if (strstr(category, "USB")) icon = "usb";
-            else icon = "pci";
-            
-	    name = g_strdup(buf);
-
-	    strhash = g_strdup_printf("PCI%d", n);
-	    strdevice = g_strdup_printf("[Device Information]\n"
-					"Name=%s\n"
-					"Class=%s\n"
-					"Domain=%d\n"
-					"Bus, device, function=%d, %d, %d\n",
-					name, category, domain, bus,
-					device, function);
-            
-            const gchar *url = vendor_get_url(name);
-            if (url) {
-                strdevice = h_strdup_cprintf("Vendor=%s (%s)\n",
-                                            strdevice,
-                                            vendor_get_name(name),
-                                            url);
-            }
-            
-            
-	    pci_list = h_strdup_cprintf("$PCI%d$%s=%s\n", pci_list, n, category, name);
-
-	    n++;
+	    g_string_append_printf(pci->resources,
+				   "I/O ports at#%d=0x%x - 0x%x\n",
+				   ++x, io_addr, io_addr + io_size);
 	}
     }
     
     if (pclose(lspci)) {
 pci_error:
         /* error (no pci, perhaps?) */
-        pci_list = g_strconcat(pci_list, "No PCI devices found=\n", NULL);
-    } else if (strhash) {
+        g_string_append(list, "No PCI devices found=\n");
+        if (pci)
+            pci_device_free(pci);
+    } else if (pci) {
 	/* insert the last device */
-        g_hash_table_insert(moreinfo, strhash, strdevice);
-        g_free(category);
-        g_free(name);
+        pci_device_add(list, pci);
     }
+
+    pci_list = g_string_free(list, FALSE);
+
+    device_registry_end_scan(pci_registry);
 }
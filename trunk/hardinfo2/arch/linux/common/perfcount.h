@@ -0,0 +1,240 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#ifdef __NR_perf_event_open
+#include <linux/perf_event.h>
+#endif				/* __NR_perf_event_open */
+
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_REFERENCES,
+    PERF_CACHE_MISSES,
+    PERF_BRANCHES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_N_COUNTERS
+};
+
+typedef struct _PerfCounters PerfCounters;
+
+struct _PerfCounters {
+    int fd[PERF_N_COUNTERS];
+    guint64 value[PERF_N_COUNTERS];
+    gboolean counted[PERF_N_COUNTERS];
+    gboolean multiplexed;
+    gchar *error;
+};
+
+static gint perf_get_paranoid_level(void)
+{
+    gchar *buf;
+    gint level;
+
+    if (!g_file_get_contents("/proc/sys/kernel/perf_event_paranoid",
+			     &buf, NULL, NULL))
+	return -1;
+
+    level = atoi(buf);
+    g_free(buf);
+
+    return level;
+}
+
+#ifdef __NR_perf_event_open
+static int perf_counter_open(guint32 type, guint64 config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;		/* count the threads the benchmark starts, too */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+	PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif				/* __NR_perf_event_open */
+
+static void perf_counters_start(PerfCounters * pc)
+{
+    gint i;
+
+    memset(pc, 0, sizeof(*pc));
+    for (i = 0; i < PERF_N_COUNTERS; i++)
+	pc->fd[i] = -1;
+
+#ifdef __NR_perf_event_open
+    static const struct {
+	guint32 type;
+	guint64 config;
+    } events[] = {
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+	  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+	  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    };
+
+    for (i = 0; i < PERF_N_COUNTERS; i++) {
+	pc->fd[i] = perf_counter_open(events[i].type, events[i].config);
+
+	if (pc->fd[i] < 0 && i == PERF_CYCLES) {
+	    gint paranoid = perf_get_paranoid_level();
+
+	    if ((errno == EACCES || errno == EPERM) && paranoid >= 0) {
+		pc->error = g_strdup_printf("Unavailable (perf_event_paranoid is %d: %s)",
+					    paranoid, g_strerror(errno));
+	    } else {
+		pc->error = g_strdup_printf("Unavailable (%s)",
+					    g_strerror(errno));
+	    }
+
+	    DEBUG("perf counters: %s", pc->error);
+	    return;
+	}
+    }
+
+    for (i = 0; i < PERF_N_COUNTERS; i++) {
+	if (pc->fd[i] >= 0)
+	    ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#else
+    pc->error = g_strdup("Unavailable (not supported by this build)");
+#endif				/* __NR_perf_event_open */
+}
+
+static void perf_counters_stop(PerfCounters * pc)
+{
+    guint64 buf[3];		/* value, time enabled, time running */
+    gint i;
+
+    for (i = 0; i < PERF_N_COUNTERS; i++) {
+	if (pc->fd[i] < 0)
+	    continue;
+
+#ifdef __NR_perf_event_open
+	ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+#endif				/* __NR_perf_event_open */
+
+	if (read(pc->fd[i], buf, sizeof(buf)) == sizeof(buf) && buf[2]) {
+	    /* scale up if the kernel had to multiplex this counter */
+	    if (buf[2] < buf[1]) {
+		pc->value[i] = (guint64) ((gdouble) buf[0] * buf[1] / buf[2]);
+		pc->multiplexed = TRUE;
+	    } else {
+		pc->value[i] = buf[0];
+	    }
+
+	    pc->counted[i] = TRUE;
+	}
+
+	close(pc->fd[i]);
+	pc->fd[i] = -1;
+    }
+}
+
+static gchar *perf_counter_format(PerfCounters * pc, gint counter,
+				  gint relative_to)
+{
+    if (!pc->counted[counter])
+	return g_strdup("Not counted");
+
+    if (relative_to < 0 || !pc->counted[relative_to] || !pc->value[relative_to])
+	return g_strdup_printf("%" G_GUINT64_FORMAT, pc->value[counter]);
+
+    if (relative_to == PERF_INSTRUCTIONS)
+	return g_strdup_printf("%" G_GUINT64_FORMAT " (%.2f per 1000 instructions)",
+			       pc->value[counter],
+			       1000.0 * pc->value[counter] / pc->value[relative_to]);
+
+    return g_strdup_printf("%" G_GUINT64_FORMAT " (%.2f%%)",
+			   pc->value[counter],
+			   100.0 * pc->value[counter] / pc->value[relative_to]);
+}
+
+/*
+ * Returns a detail pane section describing the counters read by
+ * perf_counters_stop(), or why they could not be used.
+ */
+static gchar *perf_counters_get_info(PerfCounters * pc)
+{
+    gchar *cycles, *instructions, *cache_refs, *cache_misses, *branch_misses,
+	*dtlb_misses, *ipc, *ret;
+
+    if (pc->error) {
+	return g_strdup_printf("[Performance Counters]\n"
+			       "Status=%s\n", pc->error);
+    }
+
+    if (pc->counted[PERF_CYCLES] && pc->counted[PERF_INSTRUCTIONS] &&
+	pc->value[PERF_CYCLES]) {
+	ipc = g_strdup_printf("%.2f", (gdouble) pc->value[PERF_INSTRUCTIONS] /
+			      pc->value[PERF_CYCLES]);
+    } else {
+	ipc = g_strdup("Not counted");
+    }
+
+    cycles = perf_counter_format(pc, PERF_CYCLES, -1);
+    instructions = perf_counter_format(pc, PERF_INSTRUCTIONS, -1);
+    cache_refs = perf_counter_format(pc, PERF_CACHE_REFERENCES, -1);
+    cache_misses = perf_counter_format(pc, PERF_CACHE_MISSES,
+				       PERF_CACHE_REFERENCES);
+    branch_misses = perf_counter_format(pc, PERF_BRANCH_MISSES,
+					PERF_BRANCHES);
+    dtlb_misses = perf_counter_format(pc, PERF_DTLB_MISSES,
+				      PERF_INSTRUCTIONS);
+
+    ret = g_strdup_printf("[Performance Counters]\n"
+			  "Status=%s\n"
+			  "Cycles=%s\n"
+			  "Instructions=%s\n"
+			  "Instructions per Cycle=%s\n"
+			  "Cache References=%s\n"
+			  "Cache Misses=%s\n"
+			  "Branch Misses=%s\n"
+			  "dTLB Misses=%s\n",
+			  pc->multiplexed ? "Available (multiplexed, scaled)"
+			  : "Available",
+			  cycles, instructions, ipc, cache_refs, cache_misses,
+			  branch_misses, dtlb_misses);
+
+    g_free(cycles);
+    g_free(instructions);
+    g_free(ipc);
+    g_free(cache_refs);
+    g_free(cache_misses);
+    g_free(branch_misses);
+    g_free(dtlb_misses);
+
+    return ret;
+}
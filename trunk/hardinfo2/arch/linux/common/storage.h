@@ -18,12 +18,6 @@
 
 static gchar *storage_icons = NULL;
 
-static gboolean
-remove_scsi_devices(gpointer key, gpointer value, gpointer data)
-{
-    return g_str_has_prefix(key, "SCSI");
-}
-
 /* SCSI support by Pascal F.Martin <pascalmartin@earthlink.net> */
 void
 __scan_scsi_devices(void)
@@ -38,11 +32,13 @@ __scan_scsi_devices(void)
     gchar *vendor = NULL, *revision = NULL, *model = NULL;
     gchar *scsi_storage_list;
 
-    /* remove old devices from global device table */
-    g_hash_table_foreach_remove(moreinfo, remove_scsi_devices, NULL);
+    /* devices are keyed by host, channel, id and lun */
+    device_registry_begin_scan(scsi_registry);
 
-    if (!g_file_test("/proc/scsi/scsi", G_FILE_TEST_EXISTS))
+    if (!g_file_test("/proc/scsi/scsi", G_FILE_TEST_EXISTS)) {
+	device_registry_end_scan(scsi_registry);
 	return;
+    }
 
     scsi_storage_list = g_strdup("\n[SCSI Disks]\n");
 
@@ -119,9 +115,10 @@ __scan_scsi_devices(void)
                 }
 	    }
 	    
-	    gchar *devid = g_strdup_printf("SCSI%d", n);
-	    scsi_storage_list = h_strdup_cprintf("$%s$%s=\n", scsi_storage_list, devid, model);
-	    storage_icons = h_strdup_cprintf("Icon$%s$%s=%s.png\n", storage_icons, devid, model, icon);
+	    gchar *devid = g_strdup_printf("%d:%d:%d:%d", scsi_controller,
+					   scsi_channel, scsi_id, scsi_lun);
+	    scsi_storage_list = h_strdup_cprintf("$SCSI%s$%s=\n", scsi_storage_list, devid, model);
+	    storage_icons = h_strdup_cprintf("Icon$SCSI%s$%s=%s.png\n", storage_icons, devid, model, icon);
 	    
 	    gchar *strhash = g_strdup_printf("[Device Information]\n"
 					     "Model=%s\n",model);
@@ -151,14 +148,17 @@ __scan_scsi_devices(void)
                                        scsi_channel,
                                        scsi_id,
                                        scsi_lun);
-	    g_hash_table_insert(moreinfo, devid, strhash);
+	    device_registry_set(scsi_registry, devid, strhash);
 
+	    g_free(devid);
 	    g_free(model);
 	    g_free(revision);
 	    g_free(vendor);
 	}
     }
     fclose(proc_scsi);
+
+    device_registry_end_scan(scsi_registry);
     
     if (n) {
       storage_list = h_strconcat(storage_list, scsi_storage_list, NULL);
@@ -166,12 +166,6 @@ __scan_scsi_devices(void)
     }
 }
 
-static gboolean
-remove_ide_devices(gpointer key, gpointer value, gpointer data)
-{
-    return g_str_has_prefix(key, "IDE");
-}
-
 void
 __scan_ide_devices(void)
 {
@@ -181,8 +175,8 @@ __scan_ide_devices(void)
     gint n = 0, i = 0, cache, nn = 0;
     gchar *capab = NULL, *speed = NULL, *driver = NULL, *ide_storage_list;
 
-    /* remove old devices from global device table */
-    g_hash_table_foreach_remove(moreinfo, remove_ide_devices, NULL);
+    /* devices are keyed by their name: hda, hdb... */
+    device_registry_begin_scan(ide_registry);
     
     ide_storage_list = g_strdup("\n[IDE Disks]\n");
 
@@ -304,11 +298,11 @@ __scan_ide_devices(void)
 
 	    n++;
 
-	    gchar *devid = g_strdup_printf("IDE%d", n);
+	    gchar *devid = g_strdup_printf("hd%c", iface);
 
-	    ide_storage_list = h_strdup_cprintf("$%s$%s=\n", ide_storage_list,
+	    ide_storage_list = h_strdup_cprintf("$IDE%s$%s=\n", ide_storage_list,
 					 devid, model);
-	    storage_icons = h_strdup_cprintf("Icon$%s$%s=%s.png\n", storage_icons, devid,
+	    storage_icons = h_strdup_cprintf("Icon$IDE%s$%s=%s.png\n", storage_icons, devid,
 	                                  model, g_str_equal(media, "cdrom") ? \
 	                                         "cdrom" : "hdd");
 	    
@@ -369,8 +363,9 @@ __scan_ide_devices(void)
                 speed = NULL;
             }
             
-	    g_hash_table_insert(moreinfo, devid, strhash);
+	    device_registry_set(ide_registry, devid, strhash);
 
+	    g_free(devid);
 	    g_free(model);
 	    model = g_strdup("");
 	} else
@@ -378,6 +373,8 @@ __scan_ide_devices(void)
 
 	iface++;
     }
+
+    device_registry_end_scan(ide_registry);
     
     if (n) {
       storage_list = h_strconcat(storage_list, ide_storage_list, NULL);
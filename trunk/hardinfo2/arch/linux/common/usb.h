@@ -19,118 +19,181 @@
  * FIXME:
  * - listing with sysfs does not generate device hierarchy
  */
-static gboolean
-remove_usb_devices(gpointer key, gpointer value, gpointer data)
+static gchar *usb_list = NULL;
+
+/* what the scan found about a device; its details are formatted on demand */
+typedef struct _USBDevice USBDevice;
+
+struct _USBDevice {
+    gchar *product, *manufacturer, *mxpwr;
+    gint bus, classid, vendor, prodid;
+    gfloat speed, version;
+
+    gboolean has_port;		/* procfs also gives these */
+    gint port, level;
+    gfloat revision;
+};
+
+static void usb_device_free(USBDevice * usb)
 {
-    return g_str_has_prefix(key, "USB");
+    g_free(usb->product);
+    g_free(usb->manufacturer);
+    g_free(usb->mxpwr);
+    g_free(usb);
 }
 
-static gchar *usb_list = NULL;
+static gchar *usb_device_get_detail(USBDevice * usb)
+{
+    GString *detail;
+    const gchar *url;
+
+    detail = g_string_new("[Device Information]\n");
+    g_string_append_printf(detail, "Product=%s\n", usb->product);
+
+    if (usb->manufacturer && *usb->manufacturer) {
+	if ((url = vendor_get_url(usb->manufacturer)))
+	    g_string_append_printf(detail, "Manufacturer=%s (%s)\n",
+				   vendor_get_name(usb->manufacturer), url);
+	else
+	    g_string_append_printf(detail, "Manufacturer=%s\n",
+				   usb->manufacturer);
+    }
 
-void __scan_usb_sysfs_add_device(gchar * endpoint, int n)
+    if (usb->has_port)
+	g_string_append_printf(detail, "[Port #%d]\n", usb->port);
+
+    g_string_append_printf(detail,
+			   "Speed=%.2fMbit/s\n"
+			   "Max Current=%s\n"
+			   "[Misc]\n"
+			   "USB Version=%.2f\n",
+			   usb->speed, usb->mxpwr, usb->version);
+    if (usb->has_port)
+	g_string_append_printf(detail, "Revision=%.2f\n", usb->revision);
+
+    g_string_append_printf(detail,
+			   "Class=0x%x\n"
+			   "Vendor=0x%x\n"
+			   "Product ID=0x%x\n"
+			   "Bus=%d\n",
+			   usb->classid, usb->vendor, usb->prodid, usb->bus);
+    if (usb->has_port)
+	g_string_append_printf(detail, "Level=%d\n", usb->level);
+
+    return g_string_free(detail, FALSE);
+}
+
+static gint __scan_usb_sysfs_read_int(Arena * arena, gchar * endpoint,
+				      gchar * entry)
 {
-    gchar *manufacturer, *product, *mxpwr, *tmp, *strhash;
-    gint bus, classid, vendor, prodid;
-    gfloat version, speed;
-
-    classid = h_sysfs_read_int(endpoint, "bDeviceClass");
-    vendor = h_sysfs_read_int(endpoint, "idVendor");
-    prodid = h_sysfs_read_int(endpoint, "idProduct");
-    bus = h_sysfs_read_int(endpoint, "busnum");
-    speed = h_sysfs_read_float(endpoint, "speed");
-    version = h_sysfs_read_float(endpoint, "version");
+    gchar *value = arena_read_file(arena, endpoint, entry);
+
+    return value ? atoi(value) : 0;
+}
+
+static gfloat __scan_usb_sysfs_read_float(Arena * arena, gchar * endpoint,
+					  gchar * entry)
+{
+    gchar *value = arena_read_file(arena, endpoint, entry);
+
+    return value ? atof(value) : 0.0f;
+}
+
+void __scan_usb_sysfs_add_device(Arena * arena, GString * list,
+				 gchar * endpoint)
+{
+    gchar *manufacturer, *product, *mxpwr, *id;
+    DeviceRecord *record;
+    USBDevice *usb;
+    gint bus, devnum;
+
+    bus = __scan_usb_sysfs_read_int(arena, endpoint, "busnum");
+    devnum = __scan_usb_sysfs_read_int(arena, endpoint, "devnum");
+
+    /* every endpoint of a device leads here */
+    id = arena_strdup_printf(arena, "%d.%d", bus, devnum);
+    if (device_registry_seen(usb_registry, id))
+	return;
+
+    usb = g_new0(USBDevice, 1);
+    usb->bus = bus;
+    usb->classid = __scan_usb_sysfs_read_int(arena, endpoint, "bDeviceClass");
+    usb->vendor = __scan_usb_sysfs_read_int(arena, endpoint, "idVendor");
+    usb->prodid = __scan_usb_sysfs_read_int(arena, endpoint, "idProduct");
+    usb->speed = __scan_usb_sysfs_read_float(arena, endpoint, "speed");
+    usb->version = __scan_usb_sysfs_read_float(arena, endpoint, "version");
     
-    if (!(mxpwr = h_sysfs_read_string(endpoint, "bMaxPower"))) {
-    	mxpwr = g_strdup("0 mA");
+    if (!(mxpwr = arena_read_file(arena, endpoint, "bMaxPower"))) {
+    	mxpwr = "0 mA";
     }
 
-    if (!(manufacturer = h_sysfs_read_string(endpoint, "manufacturer"))) {
-    	manufacturer = g_strdup("Unknown");
+    if (!(manufacturer = arena_read_file(arena, endpoint, "manufacturer"))) {
+    	manufacturer = "Unknown";
     }
 
-    if (!(product = h_sysfs_read_string(endpoint, "product"))) {
-	if (classid == 9) {
-	    product = g_strdup_printf("USB %.2f Hub", version);
+    if (!(product = arena_read_file(arena, endpoint, "product"))) {
+	if (usb->classid == 9) {
+	    product = arena_strdup_printf(arena, "USB %.2f Hub", usb->version);
 	} else {
-	    product = g_strdup_printf("Unknown USB %.2f Device (class %d)", version, classid);
+	    product = arena_strdup_printf(arena, "Unknown USB %.2f Device (class %d)",
+					  usb->version, usb->classid);
 	}
     }
 
-    const gchar *url = vendor_get_url(manufacturer);
-    if (url) {
-	tmp = g_strdup_printf("%s (%s)", vendor_get_name(manufacturer), url);
-	
-	g_free(manufacturer);
-	manufacturer = tmp;	    
-    }
+    usb->product = g_strdup(product);
+    usb->manufacturer = g_strdup(manufacturer);
+    usb->mxpwr = g_strdup(mxpwr);
 
-    tmp = g_strdup_printf("USB%d", n);
-    usb_list = h_strdup_cprintf("$%s$%s=\n", usb_list, tmp, product);
-
-    strhash = g_strdup_printf("[Device Information]\n"
-			      "Product=%s\n"
-			      "Manufacturer=%s\n"
-			      "Speed=%.2fMbit/s\n"
-			      "Max Current=%s\n"
-			      "[Misc]\n"
-			      "USB Version=%.2f\n"
-			      "Class=0x%x\n"
-			      "Vendor=0x%x\n"
-			      "Product ID=0x%x\n"
-			      "Bus=%d\n",
-			      product,
-			      manufacturer,
-			      speed,
-			      mxpwr,
-			      version, classid, vendor, prodid, bus);
-
-    g_hash_table_insert(moreinfo, tmp, strhash);
-    
-    g_free(manufacturer);
-    g_free(product);
-    g_free(mxpwr);
+    record = device_registry_set_data(usb_registry, id, usb);
+    g_string_append_printf(list, "$%s$", record->tag);
+    h_string_append_escaped(list, product, H_ESCAPE_KEY_FILE_KEY);
+    g_string_append(list, "=\n");
 }
 
 void __scan_usb_sysfs(void)
 {
     GDir *sysfs;
+    GString *list;
+    Arena *arena;
     gchar *filename;
     const gchar *sysfs_path = "/sys/class/usb_endpoint";
-    gint usb_device_number = 0;
 
     if (!(sysfs = g_dir_open(sysfs_path, 0, NULL))) {
 	return;
     }
 
-    if (usb_list) {
-	g_hash_table_foreach_remove(moreinfo, remove_usb_devices, NULL);
-	g_free(usb_list);
-    }
-    usb_list = g_strdup("[USB Devices]\n");
+    device_registry_begin_scan(usb_registry);
+    g_free(usb_list);
+    list = g_string_new("[USB Devices]\n");
+
+    /* paths and attribute values, all dropped once the scan is done */
+    arena = arena_new();
 
     while ((filename = (gchar *) g_dir_read_name(sysfs))) {
 	gchar *endpoint =
-	    g_build_filename(sysfs_path, filename, "device", NULL);
+	    arena_build_filename(arena, sysfs_path, filename, "device", NULL);
 	gchar *temp;
 
-	temp = g_build_filename(endpoint, "idVendor", NULL);
+	temp = arena_build_filename(arena, endpoint, "idVendor", NULL);
 	if (g_file_test(temp, G_FILE_TEST_EXISTS)) {
-	    __scan_usb_sysfs_add_device(endpoint, ++usb_device_number);
+	    __scan_usb_sysfs_add_device(arena, list, endpoint);
 	}
-
-	g_free(temp);
-	g_free(endpoint);
     }
 
+    arena_free(arena);
     g_dir_close(sysfs);
+
+    device_registry_end_scan(usb_registry);
+    usb_list = g_string_free(list, FALSE);
 }
 
 int __scan_usb_procfs(void)
 {
     FILE *dev;
+    GString *list;
     gchar buffer[128];
     gchar *tmp, *manuf = NULL, *product = NULL, *mxpwr;
-    gint bus, level, port, classid, trash;
+    gint bus, level, port, devnum, classid, trash;
     gint vendor, prodid;
     gfloat ver, rev, speed;
     int n = 0;
@@ -139,11 +202,9 @@ int __scan_usb_procfs(void)
     if (!dev)
 	return 0;
 
-    if (usb_list) {
-	g_hash_table_foreach_remove(moreinfo, remove_usb_devices, NULL);
-	g_free(usb_list);
-    }
-    usb_list = g_strdup("[USB Devices]\n");
+    device_registry_begin_scan(usb_registry);
+    g_free(usb_list);
+    list = g_string_new("[USB Devices]\n");
 
     while (fgets(buffer, 128, dev)) {
 	tmp = buffer;
@@ -152,7 +213,7 @@ int __scan_usb_procfs(void)
 	case 'T':
 	    sscanf(tmp,
 		   "T:  Bus=%d Lev=%d Prnt=%d Port=%d Cnt=%d Dev#=%d Spd=%f",
-		   &bus, &level, &trash, &port, &trash, &trash, &speed);
+		   &bus, &level, &trash, &port, &trash, &devnum, &speed);
 	    break;
 	case 'D':
 	    sscanf(tmp, "D:  Ver=%f Cls=%x", &ver, &classid);
@@ -173,9 +234,10 @@ int __scan_usb_procfs(void)
 	case 'C':
 	    mxpwr = strstr(buffer, "MxPwr=") + 6;
 
-	    tmp = g_strdup_printf("USB%d", ++n);
+	    tmp = g_strdup_printf("%d.%d", bus, devnum);
+	    n++;
 
-	    if (*product == '\0') {
+	    if (!product || *product == '\0') {
 		g_free(product);
 		if (classid == 9) {
 		    product = g_strdup_printf("USB %.2f Hub", ver);
@@ -189,46 +251,33 @@ int __scan_usb_procfs(void)
 
 
 	    if (classid == 9) {	/* hub */
-		usb_list = h_strdup_cprintf("[%s#%d]\n",
-					    usb_list, product, n);
+		g_string_append_printf(list, "[%s#%d]\n", product, n);
 	    } else {		/* everything else */
-		usb_list = h_strdup_cprintf("$%s$%s=\n",
-					    usb_list, tmp, product);
-
-		const gchar *url = vendor_get_url(manuf);
-		if (url) {
-		    gchar *tmp =
-			g_strdup_printf("%s (%s)", vendor_get_name(manuf),
-					url);
-		    g_free(manuf);
-		    manuf = tmp;
-		}
-
-		gchar *strhash = g_strdup_printf("[Device Information]\n"
-						 "Product=%s\n",
-						 product);
-		if (manuf && strlen(manuf))
-		    strhash = h_strdup_cprintf("Manufacturer=%s\n",
-					       strhash, manuf);
-
-		strhash = h_strdup_cprintf("[Port #%d]\n"
-					   "Speed=%.2fMbit/s\n"
-					   "Max Current=%s\n"
-					   "[Misc]\n"
-					   "USB Version=%.2f\n"
-					   "Revision=%.2f\n"
-					   "Class=0x%x\n"
-					   "Vendor=0x%x\n"
-					   "Product ID=0x%x\n"
-					   "Bus=%d\n" "Level=%d\n",
-					   strhash,
-					   port, speed, mxpwr,
-					   ver, rev, classid,
-					   vendor, prodid, bus, level);
-
-		g_hash_table_insert(moreinfo, tmp, strhash);
+		USBDevice *usb = g_new0(USBDevice, 1);
+
+		g_string_append_printf(list, "$USB%s$", tmp);
+		h_string_append_escaped(list, product, H_ESCAPE_KEY_FILE_KEY);
+		g_string_append(list, "=\n");
+
+		usb->product = product;
+		usb->manufacturer = manuf;
+		usb->mxpwr = g_strdup(g_strstrip(mxpwr));
+		usb->bus = bus;
+		usb->classid = classid;
+		usb->vendor = vendor;
+		usb->prodid = prodid;
+		usb->speed = speed;
+		usb->version = ver;
+		usb->has_port = TRUE;
+		usb->port = port;
+		usb->level = level;
+		usb->revision = rev;
+
+		device_registry_set_data(usb_registry, tmp, usb);
+		product = manuf = NULL;
 	    }
 
+	    g_free(tmp);
 	    g_free(manuf);
 	    g_free(product);
 	    manuf = g_strdup("");
@@ -238,6 +287,9 @@ int __scan_usb_procfs(void)
 
     fclose(dev);
 
+    device_registry_end_scan(usb_registry);
+    usb_list = g_string_free(list, FALSE);
+
     return n;
 }
 
@@ -0,0 +1,279 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Tells whether a benchmark ran on a virtual machine and whether it got
+ * the processors to itself: the hypervisor is detected from CPUID, from
+ * /sys/hypervisor and from the DMI strings, and steal time (/proc/stat) and
+ * involuntary context switches are sampled around the run.
+ */
+
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+/* over these, a run is marked as unreliable */
+#define VIRT_MAX_STEAL_PERCENT		2.0
+#define VIRT_MAX_IVCSW_PER_CPU_SECOND	100.0
+
+typedef struct _VirtSample VirtSample;
+
+struct _VirtSample {
+    guint64 steal, total;
+    glong nivcsw;
+    GTimer *timer;
+
+    gdouble steal_percent;
+    gdouble ivcsw_rate;
+    gboolean steal_known;
+};
+
+static const struct {
+    const gchar *signature, *name;
+} virt_cpuid_signatures[] = {
+    {"KVMKVMKVM", "KVM"},
+    {"Microsoft Hv", "Hyper-V"},
+    {"VMwareVMware", "VMware"},
+    {"XenVMMXenVMM", "Xen"},
+    {"VBoxVBoxVBox", "VirtualBox"},
+    {"TCGTCGTCGTCG", "QEMU (TCG)"},
+    {" lrpepyh  vr", "Parallels"},
+    {"bhyve bhyve ", "bhyve"},
+    {"ACRNACRNACRN", "ACRN"},
+    {NULL, NULL}
+};
+
+static const struct {
+    const gchar *dmi, *name;
+} virt_dmi_strings[] = {
+    {"KVM", "KVM"},
+    {"QEMU", "QEMU"},
+    {"VMware", "VMware"},
+    {"VirtualBox", "VirtualBox"},
+    {"Virtual Machine", "Hyper-V"},
+    {"Xen", "Xen"},
+    {"Amazon EC2", "Amazon EC2"},
+    {"Google Compute Engine", "Google Compute Engine"},
+    {"Parallels", "Parallels"},
+    {"BHYVE", "bhyve"},
+    {NULL, NULL}
+};
+
+static gchar *virt_get_hypervisor_cpuid(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    guint eax, ebx, ecx, edx;
+    gchar signature[13];
+    gint i;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & (1U << 31)))
+	return NULL;
+
+    __cpuid(0x40000000, eax, ebx, ecx, edx);
+    memcpy(signature, &ebx, 4);
+    memcpy(signature + 4, &ecx, 4);
+    memcpy(signature + 8, &edx, 4);
+    signature[12] = '\0';
+
+    for (i = 0; virt_cpuid_signatures[i].signature; i++) {
+	if (g_str_has_prefix(signature, virt_cpuid_signatures[i].signature))
+	    return g_strdup(virt_cpuid_signatures[i].name);
+    }
+
+    return g_strdup_printf("Unknown (%s)", g_strstrip(signature));
+#else
+    return NULL;
+#endif
+}
+
+static gchar *virt_get_hypervisor_dmi(void)
+{
+    static const gchar *files[] = {
+	"/sys/class/dmi/id/sys_vendor",
+	"/sys/class/dmi/id/product_name",
+	NULL
+    };
+    gchar *contents;
+    gint i, j;
+
+    for (i = 0; files[i]; i++) {
+	if (!g_file_get_contents(files[i], &contents, NULL, NULL))
+	    continue;
+
+	for (j = 0; virt_dmi_strings[j].dmi; j++) {
+	    if (strstr(contents, virt_dmi_strings[j].dmi)) {
+		g_free(contents);
+		return g_strdup(virt_dmi_strings[j].name);
+	    }
+	}
+
+	g_free(contents);
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns the hypervisor name, or NULL on bare metal; source is set to
+ * where it was found.
+ */
+static gchar *virt_get_hypervisor(const gchar ** source)
+{
+    gchar *name;
+
+    if ((name = virt_get_hypervisor_cpuid())) {
+	*source = "CPUID";
+	return name;
+    }
+
+    if (g_file_get_contents("/sys/hypervisor/type", &name, NULL, NULL)) {
+	g_strstrip(name);
+	if (*name) {
+	    *source = "/sys/hypervisor";
+	    return name;
+	}
+	g_free(name);
+    }
+
+    if ((name = virt_get_hypervisor_dmi())) {
+	*source = "DMI";
+	return name;
+    }
+
+    *source = NULL;
+    return NULL;
+}
+
+/* reads the aggregate steal and total jiffies from /proc/stat */
+static gboolean virt_read_steal(guint64 * steal, guint64 * total)
+{
+    guint64 fields[8] = { 0 };
+    gchar *contents;
+    gint n, i;
+
+    if (!g_file_get_contents("/proc/stat", &contents, NULL, NULL))
+	return FALSE;
+
+    n = sscanf(contents, "cpu %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+	       " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+	       " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+	       " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT,
+	       &fields[0], &fields[1], &fields[2], &fields[3],
+	       &fields[4], &fields[5], &fields[6], &fields[7]);
+    g_free(contents);
+
+    /* steal is the eighth field; older kernels do not have it */
+    if (n < 8)
+	return FALSE;
+
+    *steal = fields[7];
+    for (*total = 0, i = 0; i < 8; i++)
+	*total += fields[i];
+
+    return TRUE;
+}
+
+static void virt_sample_start(VirtSample * sample)
+{
+    struct rusage usage;
+
+    memset(sample, 0, sizeof(VirtSample));
+
+    sample->steal_known = virt_read_steal(&sample->steal, &sample->total);
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+	sample->nivcsw = usage.ru_nivcsw;
+
+    sample->timer = g_timer_new();
+}
+
+static void virt_sample_stop(VirtSample * sample, gint n_cpus)
+{
+    struct rusage usage;
+    guint64 steal, total;
+    gdouble elapsed;
+
+    g_timer_stop(sample->timer);
+    elapsed = g_timer_elapsed(sample->timer, NULL);
+    g_timer_destroy(sample->timer);
+    sample->timer = NULL;
+
+    if (sample->steal_known && virt_read_steal(&steal, &total)
+	&& total > sample->total) {
+	sample->steal_percent = 100.0 * (steal - sample->steal) /
+	    (total - sample->total);
+    } else {
+	sample->steal_known = FALSE;
+    }
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0 && elapsed > 0) {
+	sample->ivcsw_rate = (usage.ru_nivcsw - sample->nivcsw) /
+	    (elapsed * MAX(n_cpus, 1));
+	sample->nivcsw = usage.ru_nivcsw - sample->nivcsw;
+    }
+}
+
+/*
+ * Returns why a run should not be trusted, or NULL if it looks fine.
+ */
+static gchar *virt_sample_get_problem(VirtSample * sample)
+{
+    if (sample->steal_known && sample->steal_percent > VIRT_MAX_STEAL_PERCENT)
+	return g_strdup_printf("%.1f%% steal", sample->steal_percent);
+
+    if (sample->ivcsw_rate > VIRT_MAX_IVCSW_PER_CPU_SECOND)
+	return g_strdup_printf("%.0f preemptions/s per CPU",
+			       sample->ivcsw_rate);
+
+    return NULL;
+}
+
+static gchar *virt_sample_get_info(VirtSample * sample)
+{
+    const gchar *source;
+    gchar *hypervisor, *problem, *steal, *ret;
+
+    hypervisor = virt_get_hypervisor(&source);
+    problem = virt_sample_get_problem(sample);
+
+    if (sample->steal_known)
+	steal = g_strdup_printf("%.2f%%", sample->steal_percent);
+    else
+	steal = g_strdup("Not available");
+
+    ret = g_strdup_printf("[Virtualization]\n"
+			  "Hypervisor=%s%s%s%s\n"
+			  "Steal Time=%s\n"
+			  "Involuntary Context Switches=%ld (%.1f/s per CPU)\n"
+			  "Result=%s%s\n",
+			  hypervisor ? hypervisor : "None (bare metal)",
+			  hypervisor ? " (from " : "",
+			  hypervisor ? source : "",
+			  hypervisor ? ")" : "",
+			  steal, sample->nivcsw, sample->ivcsw_rate,
+			  problem ? "Unreliable: " : "Reliable",
+			  problem ? problem : "");
+
+    g_free(hypervisor);
+    g_free(problem);
+    g_free(steal);
+
+    return ret;
+}
@@ -0,0 +1 @@
+../../linux/common/perfcount.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../linux/common/virt.h
\ No newline at end of file
@@ -21,29 +21,39 @@ struct _Processor {
     gchar *vendor_id;
     gint cache_size;
     gfloat bogomips, cpu_mhz;
+
+    gint id;
 };
 
 static GSList *
 __scan_processors(void)
 {
-    Processor *processor;
+    GSList *procs = NULL, *l;
+    Processor *processor = NULL;
     FILE *cpuinfo;
     gchar buffer[128];
+    gchar *machine = NULL;
 
     cpuinfo = fopen("/proc/cpuinfo", "r");
     if (!cpuinfo)
 	return NULL;
 
-    processor = g_new0(Processor, 1);
     while (fgets(buffer, 128, cpuinfo)) {
 	gchar **tmp = g_strsplit(buffer, ":", 2);
 
+	/* SMP kernels list every processor, older ones only describe one */
+	if (g_str_has_prefix(tmp[0], "processor") || !processor) {
+	    processor = g_new0(Processor, 1);
+	    procs = g_slist_append(procs, processor);
+	}
+
 	if (tmp[0] && tmp[1]) {
 	    tmp[0] = g_strstrip(tmp[0]);
 	    tmp[1] = g_strstrip(tmp[1]);
 
+	    get_int("processor", processor->id);
 	    get_str("cpu", processor->model_name);
-	    get_str("machine", processor->vendor_id);
+	    get_str("machine", machine);
 	    get_int("L2 cache", processor->cache_size);
 	    get_float("clock", processor->cpu_mhz);
 	    get_float("bogomips", processor->bogomips);
@@ -51,23 +61,30 @@ __scan_processors(void)
 	}
 	g_strfreev(tmp);
     }
-    
-    gchar *tmp = g_strdup_printf("PowerPC %s (%.2fMHz)",
-                                 processor->model_name,
-                                 processor->cpu_mhz);
-    g_free(processor->model_name);
-    processor->model_name = tmp;
 
     fclose(cpuinfo);
 
-    return g_slist_append(NULL, processor);
+    /* the machine line comes once, after the last processor */
+    for (l = procs; l; l = l->next) {
+	gchar *tmp;
+
+	processor = (Processor *) l->data;
+	processor->vendor_id = g_strdup(machine);
+
+	tmp = g_strdup_printf("PowerPC %s (%.2fMHz)",
+			      processor->model_name,
+			      processor->cpu_mhz);
+	g_free(processor->model_name);
+	processor->model_name = tmp;
+    }
+    g_free(machine);
+
+    return procs;
 }
 
 static gchar *
-processor_get_info(GSList *processors)
+processor_get_detailed_info(Processor *processor)
 {
-        Processor *processor = (Processor *)processors->data;
-        
 	return g_strdup_printf("[Processor]\n"
 	                       "Machine=%s\n"
 	                       "CPU=%s\n"
@@ -87,3 +104,50 @@ processor_get_info(GSList *processors)
 #endif
                               );
 }
+
+static gchar *
+processor_get_info(GSList *processors)
+{
+    Processor *processor;
+
+    if (g_slist_length(processors) > 1) {
+	GString *list;
+	gchar *ret, *hashkey;
+	GSList *l;
+
+	list = g_string_new("");
+
+	/* details are only formatted for the processors looked at */
+	if (!processor_registry)
+	    processor_registry = device_registry_new_lazy("CPU",
+				(DeviceFormatFunc) processor_get_detailed_info,
+				NULL);
+	device_registry_begin_scan(processor_registry);
+
+	for (l = processors; l; l = l->next) {
+	    processor = (Processor *) l->data;
+
+	    g_string_append_printf(list, "$CPU%d$", processor->id);
+	    h_string_append_escaped(list, processor->model_name,
+				    H_ESCAPE_KEY_FILE_KEY);
+	    g_string_append_printf(list, "=%.2fMHz\n", processor->cpu_mhz);
+
+	    hashkey = g_strdup_printf("%d", processor->id);
+	    device_registry_set_data(processor_registry, hashkey, processor);
+	    g_free(hashkey);
+	}
+
+	device_registry_end_scan(processor_registry);
+
+	ret = g_strdup_printf("[$ShellParam$]\n"
+			      "ViewType=1\n"
+			      "[Processors]\n"
+			      "%s", list->str);
+	g_string_free(list, TRUE);
+
+	return ret;
+    }
+
+    processor = (Processor *) processors->data;
+    return processor_get_detailed_info(processor);
+}
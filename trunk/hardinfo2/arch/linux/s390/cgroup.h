@@ -0,0 +1 @@
+../../../arch/linux/common/cgroup.h
\ No newline at end of file
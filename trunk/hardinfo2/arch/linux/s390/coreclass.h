@@ -0,0 +1 @@
+../../../arch/linux/common/coreclass.h
\ No newline at end of file
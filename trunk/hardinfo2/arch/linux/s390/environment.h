@@ -0,0 +1 @@
+../../../arch/linux/common/environment.h
\ No newline at end of file
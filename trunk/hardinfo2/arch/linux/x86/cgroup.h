@@ -0,0 +1 @@
+../../linux/common/cgroup.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../linux/common/environment.h
\ No newline at end of file
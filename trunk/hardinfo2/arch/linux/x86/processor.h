@@ -243,18 +243,28 @@ static GSList *__scan_processors(void)
 {
     GSList *procs = NULL;
     Processor *processor = NULL;
-    FILE *cpuinfo;
-    gchar buffer[256];
-    gint processor_number = 0;
+    Arena *arena;
+    gchar *cpuinfo, **lines;
+    gint processor_number = 0, i;
 
-    cpuinfo = fopen("/proc/cpuinfo", "r");
-    if (!cpuinfo)
+    /* whole lines: the flags line is longer than any fixed buffer */
+    if (!g_file_get_contents("/proc/cpuinfo", &cpuinfo, NULL, NULL))
 	return NULL;
 
-    while (fgets(buffer, 256, cpuinfo)) {
-	gchar **tmp = g_strsplit(buffer, ":", 2);
+    lines = g_strsplit(cpuinfo, "\n", 0);
+    g_free(cpuinfo);
 
-	if (g_str_has_prefix(tmp[0], "processor")) {
+    /* only holds the keys, which repeat for every processor */
+    arena = arena_new();
+
+    for (i = 0; lines[i]; i++) {
+	const gchar *key;
+	gchar *value;
+
+	if (!arena_split_pair(arena, lines[i], ':', &key, &value))
+	    continue;
+
+	if (g_str_has_prefix(key, "processor")) {
 	    if (processor) {
 		get_processor_strfamily(processor);
 		procs = g_slist_append(procs, processor);
@@ -265,31 +275,25 @@ static GSList *__scan_processors(void)
 	    __cache_obtain_info(processor, processor_number++);
 	}
 
-	if (tmp[0] && tmp[1]) {
-	    tmp[0] = g_strstrip(tmp[0]);
-	    tmp[1] = g_strstrip(tmp[1]);
-
-	    get_str("model name", processor->model_name);
-	    get_str("vendor_id", processor->vendor_id);
-	    get_str("flags", processor->flags);
-	    get_int("cache size", processor->cache_size);
-	    get_float("cpu MHz", processor->cpu_mhz);
-	    get_float("bogomips", processor->bogomips);
+	get_pair_str("model name", processor->model_name);
+	get_pair_str("vendor_id", processor->vendor_id);
+	get_pair_str("flags", processor->flags);
+	get_pair_int("cache size", processor->cache_size);
+	get_pair_float("cpu MHz", processor->cpu_mhz);
+	get_pair_float("bogomips", processor->bogomips);
 
-	    get_str("fpu", processor->has_fpu);
+	get_pair_str("fpu", processor->has_fpu);
 
-	    get_str("fdiv_bug", processor->bug_fdiv);
-	    get_str("hlt_bug", processor->bug_hlt);
-	    get_str("f00f_bug", processor->bug_f00f);
-	    get_str("coma_bug", processor->bug_coma);
+	get_pair_str("fdiv_bug", processor->bug_fdiv);
+	get_pair_str("hlt_bug", processor->bug_hlt);
+	get_pair_str("f00f_bug", processor->bug_f00f);
+	get_pair_str("coma_bug", processor->bug_coma);
 
-	    get_int("model", processor->model);
-	    get_int("cpu family", processor->family);
-	    get_int("stepping", processor->stepping);
+	get_pair_int("model", processor->model);
+	get_pair_int("cpu family", processor->family);
+	get_pair_int("stepping", processor->stepping);
 
-	    get_int("processor", processor->id);
-	}
-	g_strfreev(tmp);
+	get_pair_int("processor", processor->id);
     }
 
     if (processor) {
@@ -297,7 +301,8 @@ static GSList *__scan_processors(void)
 	procs = g_slist_append(procs, processor);
     }
 
-    fclose(cpuinfo);
+    arena_free(arena);
+    g_strfreev(lines);
 
     return procs;
 }
@@ -416,6 +421,8 @@ static struct {
 	{ "tpr",	"Task Priority Register"			},
 	{ "vid",	"Voltage Identifier"				},
 	{ "fid", 	"Frequency Identifier"				},
+	{ "aes",	"AES instructions (AES-NI)"			},
+	{ "pclmulqdq",	"Carry-less Multiplication (PCLMULQDQ)"		},
 	{ NULL,		NULL						},
 };
 
@@ -426,10 +433,11 @@ gchar *processor_get_capabilities_from_flags(gchar * strflags)
      * - Use binary search or something faster than this O(n) cruft
      */
     gchar **flags, **old;
-    gchar *tmp = NULL;
+    GString *tmp;
     gint i, j = 0;
 
     flags = g_strsplit(strflags, " ", 0);
+    tmp = g_string_new("");
     old = flags;
 
     while (flags[j]) {
@@ -441,12 +449,12 @@ gchar *processor_get_capabilities_from_flags(gchar * strflags)
 	    }
 	}
 
-	tmp = h_strdup_cprintf("%s=%s\n", tmp, flags[j], meaning);
+	g_string_append_printf(tmp, "%s=%s\n", flags[j], meaning);
 	j++;
     }
 
     g_strfreev(old);
-    return tmp;
+    return g_string_free(tmp, FALSE);
 }
 
 static gchar *processor_get_detailed_info(Processor * processor)
@@ -506,29 +514,39 @@ static gchar *processor_get_info(GSList * processors)
     Processor *processor;
 
     if (g_slist_length(processors) > 1) {
-	gchar *ret, *tmp, *hashkey;
+	GString *list;
+	gchar *ret, *hashkey;
 	GSList *l;
 
-	tmp = g_strdup("");
+	list = g_string_new("");
+
+	/* details are only formatted for the processors looked at */
+	if (!processor_registry)
+	    processor_registry = device_registry_new_lazy("CPU",
+				(DeviceFormatFunc) processor_get_detailed_info,
+				NULL);
+	device_registry_begin_scan(processor_registry);
 
 	for (l = processors; l; l = l->next) {
 	    processor = (Processor *) l->data;
 
-	    tmp = g_strdup_printf("%s$CPU%d$%s=%.2fMHz\n",
-				  tmp, processor->id,
-				  processor->model_name,
-				  processor->cpu_mhz);
+	    g_string_append_printf(list, "$CPU%d$", processor->id);
+	    h_string_append_escaped(list, processor->model_name,
+				    H_ESCAPE_KEY_FILE_KEY);
+	    g_string_append_printf(list, "=%.2fMHz\n", processor->cpu_mhz);
 
-	    hashkey = g_strdup_printf("CPU%d", processor->id);
-	    g_hash_table_insert(moreinfo, hashkey,
-				processor_get_detailed_info(processor));
+	    hashkey = g_strdup_printf("%d", processor->id);
+	    device_registry_set_data(processor_registry, hashkey, processor);
+	    g_free(hashkey);
 	}
 
+	device_registry_end_scan(processor_registry);
+
 	ret = g_strdup_printf("[$ShellParam$]\n"
 			      "ViewType=1\n"
 			      "[Processors]\n"
-			      "%s", tmp);
-	g_free(tmp);
+			      "%s", list->str);
+	g_string_free(list, TRUE);
 	
 	return ret;
     }
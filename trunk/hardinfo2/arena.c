@@ -0,0 +1,292 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <arena.h>
+
+#define ARENA_BLOCK_SIZE	4096
+#define ARENA_ALIGN(size)	(((size) + 7) & ~(gsize) 7)
+
+typedef struct _ArenaBlock ArenaBlock;
+
+/* the data follows the header, which keeps it 8-byte aligned */
+struct _ArenaBlock {
+    ArenaBlock *next;
+    gsize size, used;
+};
+
+struct _Arena {
+    ArenaBlock *blocks;		/* the one being filled first */
+    GHashTable *strings;
+};
+
+/* summed over every arena; scans only run from the main loop */
+static ArenaStats stats;
+
+Arena *arena_new(void)
+{
+    return g_new0(Arena, 1);
+}
+
+void arena_free(Arena * arena)
+{
+    ArenaBlock *block, *next;
+
+    if (!arena)
+	return;
+
+    for (block = arena->blocks; block; block = next) {
+	next = block->next;
+	g_free(block);
+    }
+
+    if (arena->strings)
+	g_hash_table_destroy(arena->strings);
+
+    g_free(arena);
+}
+
+gpointer arena_alloc(Arena * arena, gsize size)
+{
+    ArenaBlock *block = arena->blocks, *new_block;
+    gpointer p;
+
+    size = ARENA_ALIGN(MAX(size, 1));
+
+    stats.allocations++;
+    stats.bytes += size;
+
+    if (!block || block->size - block->used < size) {
+	gsize block_size = MAX(size, ARENA_BLOCK_SIZE);
+
+	new_block = g_malloc(sizeof(ArenaBlock) + block_size);
+	new_block->size = block_size;
+	new_block->used = 0;
+	stats.blocks++;
+
+	/* a large request gets a block of its own, so that what is left
+	   in the current one is not thrown away */
+	if (block && size > ARENA_BLOCK_SIZE / 2) {
+	    new_block->next = block->next;
+	    block->next = new_block;
+	} else {
+	    new_block->next = block;
+	    arena->blocks = new_block;
+	}
+
+	block = new_block;
+    }
+
+    p = (gchar *) (block + 1) + block->used;
+    block->used += size;
+
+    return p;
+}
+
+gchar *arena_strndup(Arena * arena, const gchar * string, gsize length)
+{
+    gchar *copy;
+
+    copy = arena_alloc(arena, length + 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    return copy;
+}
+
+gchar *arena_strdup(Arena * arena, const gchar * string)
+{
+    if (!string)
+	return NULL;
+
+    return arena_strndup(arena, string, strlen(string));
+}
+
+gchar *arena_strdup_printf(Arena * arena, const gchar * format, ...)
+{
+    va_list args;
+    gchar *string;
+    gint length;
+
+    va_start(args, format);
+    length = g_vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    string = arena_alloc(arena, length + 1);
+
+    va_start(args, format);
+    g_vsnprintf(string, length + 1, format, args);
+    va_end(args);
+
+    return string;
+}
+
+/* like g_build_filename(): separators between elements are not doubled */
+gchar *arena_build_filename(Arena * arena, const gchar * first, ...)
+{
+    va_list args;
+    const gchar *element, *end;
+    gchar *path, *p;
+    gsize length = 0;
+
+    va_start(args, first);
+    for (element = first; element; element = va_arg(args, const gchar *))
+	length += strlen(element) + 1;
+    va_end(args);
+
+    p = path = arena_alloc(arena, length + 1);
+
+    va_start(args, first);
+    for (element = first; element; element = va_arg(args, const gchar *)) {
+	if (p != path) {
+	    while (*element == G_DIR_SEPARATOR)
+		element++;
+	    if (!*element)
+		continue;
+	    if (p[-1] != G_DIR_SEPARATOR)
+		*p++ = G_DIR_SEPARATOR;
+	}
+
+	for (end = element + strlen(element);
+	     end > element + 1 && end[-1] == G_DIR_SEPARATOR; end--);
+
+	memcpy(p, element, end - element);
+	p += end - element;
+    }
+    va_end(args);
+
+    *p = '\0';
+
+    return path;
+}
+
+/* like g_strsplit(), but the vector and the strings live in the arena */
+gchar **arena_strsplit(Arena * arena, const gchar * string,
+		       const gchar * delimiter, gint max_tokens)
+{
+    gchar **vector;
+    const gchar *s, *next;
+    gsize delimiter_length = strlen(delimiter);
+    gint n = 1, i;
+
+    if (!*string) {
+	vector = arena_alloc(arena, sizeof(gchar *));
+	vector[0] = NULL;
+
+	return vector;
+    }
+
+    if (max_tokens < 1)
+	max_tokens = G_MAXINT;
+
+    for (s = string; n < max_tokens && (next = strstr(s, delimiter));
+	 s = next + delimiter_length)
+	n++;
+
+    vector = arena_alloc(arena, (n + 1) * sizeof(gchar *));
+
+    for (s = string, i = 0; i < n - 1; i++) {
+	next = strstr(s, delimiter);
+	vector[i] = arena_strndup(arena, s, next - s);
+	s = next + delimiter_length;
+    }
+    vector[i++] = arena_strdup(arena, s);
+    vector[i] = NULL;
+
+    return vector;
+}
+
+const gchar *arena_intern(Arena * arena, const gchar * string)
+{
+    gchar *interned;
+
+    if (!arena->strings)
+	arena->strings = g_hash_table_new(g_str_hash, g_str_equal);
+
+    if ((interned = g_hash_table_lookup(arena->strings, string))) {
+	stats.interned++;
+	return interned;
+    }
+
+    interned = arena_strdup(arena, string);
+    g_hash_table_insert(arena->strings, interned, interned);
+
+    return interned;
+}
+
+/*
+ * Splits "key: value" in place. Both halves are stripped; the key is
+ * interned and the value points into the line, so nothing is allocated
+ * for a key seen before.
+ */
+gboolean arena_split_pair(Arena * arena, gchar * line, gchar separator,
+			  const gchar ** key, gchar ** value)
+{
+    gchar *p;
+
+    if (!(p = strchr(line, separator)))
+	return FALSE;
+
+    *p = '\0';
+    *key = arena_intern(arena, g_strstrip(line));
+    *value = g_strstrip(p + 1);
+
+    return TRUE;
+}
+
+/* a small file, such as a sysfs attribute, stripped; NULL if unreadable */
+gchar *arena_read_file(Arena * arena, const gchar * dir, const gchar * name)
+{
+    gchar buffer[ARENA_BLOCK_SIZE], *path, *contents, *data;
+    gssize n;
+    gsize length = 0;
+    gint fd;
+
+    path = arena_build_filename(arena, dir, name, NULL);
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+	return NULL;
+
+    while (length < sizeof(buffer) &&
+	   (n = read(fd, buffer + length, sizeof(buffer) - length)) > 0)
+	length += n;
+    close(fd);
+
+    if (length < sizeof(buffer)) {
+	contents = arena_strndup(arena, buffer, length);
+    } else {
+	/* did not fit; take the slow way */
+	if (!g_file_get_contents(path, &data, &length, NULL))
+	    return NULL;
+
+	contents = arena_strndup(arena, data, length);
+	g_free(data);
+    }
+
+    return g_strstrip(contents);
+}
+
+void arena_get_stats(ArenaStats * out)
+{
+    *out = stats;
+}
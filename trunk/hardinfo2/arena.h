@@ -0,0 +1,67 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <glib.h>
+
+/*
+ * A region allocator for the temporary data of one scan: lines, split
+ * fields and paths are carved out of a few large blocks and released
+ * together by arena_free(), instead of being freed one by one. Strings
+ * that repeat across a scan (/proc/cpuinfo keys, for instance) can be
+ * interned, so that each is stored only once.
+ *
+ * Nothing allocated here may outlive the arena; whatever a scan keeps
+ * must still be copied with g_strdup().
+ */
+
+typedef struct _Arena		Arena;
+typedef struct _ArenaStats	ArenaStats;
+
+struct _ArenaStats {
+    guint64 allocations;	/* requests served */
+    guint64 blocks;		/* blocks actually taken from malloc */
+    guint64 bytes;
+    guint64 interned;		/* arena_intern() calls that found a copy */
+};
+
+Arena		*arena_new(void);
+void		 arena_free(Arena *arena);
+
+gpointer	 arena_alloc(Arena *arena, gsize size);
+gchar		*arena_strdup(Arena *arena, const gchar *string);
+gchar		*arena_strndup(Arena *arena, const gchar *string, gsize length);
+gchar		*arena_strdup_printf(Arena *arena, const gchar *format, ...)
+		 G_GNUC_PRINTF(2, 3);
+gchar		*arena_build_filename(Arena *arena, const gchar *first, ...)
+		 G_GNUC_NULL_TERMINATED;
+gchar	       **arena_strsplit(Arena *arena, const gchar *string,
+				const gchar *delimiter, gint max_tokens);
+
+const gchar	*arena_intern(Arena *arena, const gchar *string);
+gboolean	 arena_split_pair(Arena *arena, gchar *line, gchar separator,
+				  const gchar **key, gchar **value);
+
+gchar		*arena_read_file(Arena *arena, const gchar *dir,
+				 const gchar *name);
+
+void		 arena_get_stats(ArenaStats *stats);
+
+#endif	/* __ARENA_H__ */
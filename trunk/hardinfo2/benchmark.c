@@ -21,9 +21,22 @@
 #include <shell.h>
 #include <config.h>
 #include <syncmanager.h>
+#include <corpus.h>
+#include <cpumask.h>
 
+#include <arch/this/cgroup.h>
+
+#include <unistd.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/poll.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
 
 enum {
     BENCHMARK_ZLIB,
@@ -32,6 +45,16 @@ enum {
     BENCHMARK_SHA1,
     BENCHMARK_BLOWFISH,
     BENCHMARK_RAYTRACE,
+    BENCHMARK_PROCSPAWN,
+    BENCHMARK_AES,
+    BENCHMARK_PZLIB,
+    BENCHMARK_PATHTRACE,
+    BENCHMARK_SORTING,
+    BENCHMARK_PFIB,
+    BENCHMARK_SMT,
+    BENCHMARK_LIBCRYPTO,
+    BENCHMARK_COMPOSITE,
+    BENCHMARK_COMPOSITE_THREAD,
     BENCHMARK_N_ENTRIES
 } Entries;
 
@@ -41,6 +64,15 @@ void scan_bfsh(gboolean reload);
 void scan_md5(gboolean reload);
 void scan_fib(gboolean reload);
 void scan_sha1(gboolean reload);
+void scan_procspawn(gboolean reload);
+void scan_aes(gboolean reload);
+void scan_pzlib(gboolean reload);
+void scan_pathtrace(gboolean reload);
+void scan_sorting(gboolean reload);
+void scan_pfib(gboolean reload);
+void scan_smt(gboolean reload);
+void scan_libcrypto(gboolean reload);
+void scan_composite(gboolean reload);
 
 gchar *callback_zlib();
 gchar *callback_raytr();
@@ -48,6 +80,16 @@ gchar *callback_bfsh();
 gchar *callback_md5();
 gchar *callback_fib();
 gchar *callback_sha1();
+gchar *callback_procspawn();
+gchar *callback_aes();
+gchar *callback_pzlib();
+gchar *callback_pathtrace();
+gchar *callback_sorting();
+gchar *callback_pfib();
+gchar *callback_smt();
+gchar *callback_libcrypto();
+gchar *callback_composite();
+gchar *callback_composite_thread();
 
 static ModuleEntry entries[] = {
     {"CPU ZLib", "compress.png", callback_zlib, scan_zlib},
@@ -56,17 +98,111 @@ static ModuleEntry entries[] = {
     {"CPU SHA1", "module.png", callback_sha1, scan_sha1},
     {"CPU Blowfish", "blowfish.png", callback_bfsh, scan_bfsh},
     {"FPU Raytracing", "raytrace.png", callback_raytr, scan_raytr},
+    {"CPU Process Creation", "module.png", callback_procspawn, scan_procspawn},
+    {"CPU AES", "blowfish.png", callback_aes, scan_aes},
+    {"CPU Parallel ZLib", "compress.png", callback_pzlib, scan_pzlib},
+    {"FPU Path Tracing", "raytrace.png", callback_pathtrace, scan_pathtrace},
+    {"CPU Sorting and Hashing", "module.png", callback_sorting, scan_sorting},
+    {"CPU Fibonacci (Parallel)", "module.png", callback_pfib, scan_pfib},
+    {"CPU SMT Interference", "module.png", callback_smt, scan_smt},
+    {"CPU Crypto Library", "blowfish.png", callback_libcrypto, scan_libcrypto},
+    {"Composite Score", "module.png", callback_composite, scan_composite},
+    {"Composite Score (per Thread)", "module.png", callback_composite_thread,
+     scan_composite},
     {NULL}
 };
 
-static gchar *__benchmark_include_results(gdouble result,
-					  const gchar * benchmark,
-					  ShellOrderType order_type)
+static GHashTable *moreinfo = NULL;
+
+/* shown next to this machine's score: the hypervisor, or why a run is
+   not comparable */
+static gchar *bench_annotations[BENCHMARK_N_ENTRIES];
+static gboolean bench_unreliable[BENCHMARK_N_ENTRIES];
+
+/* Key=Value lines describing the environment of the last run */
+static gchar *bench_environment[BENCHMARK_N_ENTRIES];
+
+/* how each result compares, and whether it counts for the composite score */
+static const struct {
+    gboolean higher_is_better;
+    gboolean all_cores;
+    gboolean in_composite;
+} bench_kind[BENCHMARK_N_ENTRIES] = {
+    [BENCHMARK_ZLIB] = {TRUE, FALSE, TRUE},
+    [BENCHMARK_FIB] = {FALSE, FALSE, TRUE},
+    [BENCHMARK_MD5] = {TRUE, FALSE, TRUE},
+    [BENCHMARK_SHA1] = {TRUE, FALSE, TRUE},
+    [BENCHMARK_BLOWFISH] = {FALSE, FALSE, TRUE},
+    [BENCHMARK_RAYTRACE] = {FALSE, FALSE, TRUE},
+    [BENCHMARK_PROCSPAWN] = {TRUE, FALSE, TRUE},
+    [BENCHMARK_AES] = {TRUE, FALSE, TRUE},
+    [BENCHMARK_PZLIB] = {TRUE, TRUE, TRUE},
+    [BENCHMARK_PATHTRACE] = {TRUE, TRUE, TRUE},
+    [BENCHMARK_SORTING] = {TRUE, TRUE, TRUE},
+    [BENCHMARK_PFIB] = {FALSE, TRUE, TRUE},
+    [BENCHMARK_SMT] = {TRUE, FALSE, FALSE},
+    [BENCHMARK_LIBCRYPTO] = {TRUE, FALSE, FALSE},
+    [BENCHMARK_COMPOSITE] = {TRUE, FALSE, FALSE},
+    [BENCHMARK_COMPOSITE_THREAD] = {TRUE, FALSE, FALSE},
+};
+
+/*
+ * Reference machines may be described by a [Machine: <name>] group in
+ * benchmark.conf, where <name> is the key used in the result groups. The
+ * group may also record environment settings (see environment.h), which
+ * are then compared with this machine's.
+ */
+enum {
+    MACHINE_CPU_MODEL,
+    MACHINE_CORES,
+    MACHINE_THREADS,
+    MACHINE_BASE_CLOCK,
+    MACHINE_MAX_CLOCK,
+    MACHINE_MEMORY,
+    MACHINE_KERNEL,
+    MACHINE_COMPILER,
+    MACHINE_N_KEYS
+};
+
+static const gchar *machine_keys[] = {
+    "CPU Model",
+    "Cores",
+    "Threads",
+    "Base Clock",
+    "Max Clock",
+    "Memory",
+    "Kernel",
+    "Compiler"
+};
+
+static gint benchmark_lookup_entry(const gchar * benchmark)
+{
+    gint i;
+
+    for (i = 0; entries[i].name; i++) {
+	if (g_str_equal(entries[i].name, benchmark))
+	    return i;
+    }
+
+    return -1;
+}
+
+static gint benchmark_lookup_machine_key(const gchar * name)
+{
+    gint i;
+
+    for (i = 0; i < MACHINE_N_KEYS; i++) {
+	if (!g_ascii_strcasecmp(machine_keys[i], name))
+	    return i;
+    }
+
+    return -1;
+}
+
+static GKeyFile *benchmark_load_conf(void)
 {
     GKeyFile *conf;
-    gchar **machines;
-    gchar *path, *results = g_strdup("");
-    int i;
+    gchar *path;
 
     conf = g_key_file_new();
 
@@ -80,30 +216,314 @@ static gchar *__benchmark_include_results(gdouble result,
     }
 
     g_key_file_load_from_file(conf, path, 0, NULL);
+    g_free(path);
+
+    return conf;
+}
+
+static gchar *benchmark_machine_get(GKeyFile * conf, const gchar * machine,
+				    gint key)
+{
+    gchar *group, *value;
+
+    group = g_strdup_printf("Machine: %s", machine);
+    value = g_key_file_get_value(conf, group, machine_keys[key], NULL);
+    g_free(group);
+
+    return value;
+}
+
+/*
+ * Filters are given as "Key=pattern;Key=pattern", with shell-style
+ * wildcards; a machine must match all of them.
+ */
+static gboolean benchmark_machine_matches(GKeyFile * conf,
+					  const gchar * machine)
+{
+    gchar **filters, **filter, *value;
+    gboolean matches = TRUE;
+    gint i, key;
+
+    if (!params.benchmark_filter)
+	return TRUE;
+
+    filters = g_strsplit(params.benchmark_filter, ";", 0);
+    for (i = 0; matches && filters[i]; i++) {
+	filter = g_strsplit(filters[i], "=", 2);
+	value = NULL;
+
+	if (filter[0] && filter[1]
+	    && (key = benchmark_lookup_machine_key(g_strstrip(filter[0]))) >= 0)
+	    value = benchmark_machine_get(conf, machine, key);
+
+	matches = value && g_pattern_match_simple(g_strstrip(filter[1]), value);
 
-    machines = g_key_file_get_keys(conf, benchmark, NULL, NULL);
-    for (i = 0; machines && machines[i]; i++) {
-	gchar *value;
-	
-	value   = g_key_file_get_value(conf, benchmark, machines[i], NULL);
-	results = g_strconcat(results, machines[i], "=", value, "\n", NULL);
-	
 	g_free(value);
+	g_strfreev(filter);
+    }
+    g_strfreev(filters);
+
+    return matches;
+}
+
+/*
+ * Formats machine=value lines for the comparison list, applying the
+ * filter; when grouping, each group of machines gets its own section.
+ */
+static gchar *benchmark_format_machines(GKeyFile * conf, gchar ** machines,
+					gchar ** values)
+{
+    GHashTable *grouped;
+    GSList *order = NULL, *l;
+    gchar *results = g_strdup(""), *group, *group_value;
+    GString *lines;
+    gint i, group_key = -1;
+
+    if (params.benchmark_group)
+	group_key = benchmark_lookup_machine_key(params.benchmark_group);
+
+    grouped = g_hash_table_new(g_str_hash, g_str_equal);
+
+    for (i = 0; machines && machines[i]; i++) {
+	if (!benchmark_machine_matches(conf, machines[i]))
+	    continue;
+
+	if (group_key < 0) {
+	    results = h_strdup_cprintf("%s=%s\n", results,
+				       machines[i], values[i]);
+	    continue;
+	}
+
+	group_value = benchmark_machine_get(conf, machines[i], group_key);
+	group = g_strdup_printf("%s: %s", machine_keys[group_key],
+				group_value ? group_value : "Unknown");
+	g_free(group_value);
+
+	if (!(lines = g_hash_table_lookup(grouped, group))) {
+	    lines = g_string_new(NULL);
+	    g_hash_table_insert(grouped, group, lines);
+	    order = g_slist_append(order, group);
+	} else {
+	    g_free(group);
+	}
+
+	g_string_append_printf(lines, "%s=%s\n", machines[i], values[i]);
+    }
+
+    for (l = order; l; l = l->next) {
+	lines = g_hash_table_lookup(grouped, l->data);
+	results = h_strdup_cprintf("[%s]\n%s", results,
+				   (gchar *) l->data, lines->str);
+
+	g_string_free(lines, TRUE);
+	g_free(l->data);
+    }
+
+    g_slist_free(order);
+    g_hash_table_destroy(grouped);
+
+    return results;
+}
+
+static gdouble benchmark_conf_get_result(GKeyFile * conf,
+					 const gchar * machine, gint entry)
+{
+    gchar *value;
+    gdouble result;
+
+    value = g_key_file_get_value(conf, entries[entry].name, machine, NULL);
+    if (!value)
+	return 0;
+
+    result = g_ascii_strtod(value, NULL);
+    g_free(value);
+
+    return result;
+}
+
+static gchar *benchmark_get_reference_machine(GKeyFile * conf)
+{
+    if (params.benchmark_reference)
+	return g_strdup(params.benchmark_reference);
+
+    return g_key_file_get_value(conf, "Composite", "Reference", NULL);
+}
+
+/*
+ * Geometric mean of the results relative to the reference machine, with
+ * the reference at 100. The per-thread variant divides the all-core
+ * results by the ratio of thread counts; it needs both counts.
+ */
+static gdouble benchmark_composite(const gdouble * results, gint threads,
+				   const gdouble * reference,
+				   gint reference_threads,
+				   gboolean per_thread, gint * n_compared)
+{
+    gdouble ratio, log_sum = 0;
+    gint i, n = 0;
+
+    if (per_thread && (threads <= 0 || reference_threads <= 0))
+	return 0;
+
+    for (i = 0; i < BENCHMARK_N_ENTRIES; i++) {
+	if (!bench_kind[i].in_composite || results[i] <= 0
+	    || reference[i] <= 0)
+	    continue;
+
+	ratio = bench_kind[i].higher_is_better ? results[i] / reference[i]
+	    : reference[i] / results[i];
+	if (per_thread && bench_kind[i].all_cores)
+	    ratio *= (gdouble) reference_threads / threads;
+
+	log_sum += log(ratio);
+	n++;
+    }
+
+    if (n_compared)
+	*n_compared = n;
+
+    return n ? 100.0 * exp(log_sum / n) : 0;
+}
+
+static gint benchmark_machine_get_threads(GKeyFile * conf,
+					  const gchar * machine)
+{
+    gchar *value = benchmark_machine_get(conf, machine, MACHINE_THREADS);
+    gint threads = value ? atoi(value) : 0;
+
+    g_free(value);
+
+    return threads;
+}
+
+/* composite scores of every reference machine, for the comparison list */
+static void benchmark_get_composite_results(GKeyFile * conf,
+					    gboolean per_thread,
+					    gchar *** machines,
+					    gchar *** values)
+{
+    GHashTable *seen;
+    GPtrArray *names, *scores;
+    gdouble results[BENCHMARK_N_ENTRIES], reference[BENCHMARK_N_ENTRIES];
+    gchar **keys, *reference_name;
+    gint i, j, k, reference_threads;
+    gdouble score;
+
+    names = g_ptr_array_new();
+    scores = g_ptr_array_new();
+
+    reference_name = benchmark_get_reference_machine(conf);
+    if (!reference_name)
+	goto out;
+
+    for (i = 0; i < BENCHMARK_N_ENTRIES; i++)
+	reference[i] = benchmark_conf_get_result(conf, reference_name, i);
+    reference_threads = benchmark_machine_get_threads(conf, reference_name);
+
+    seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    for (i = 0; i < BENCHMARK_N_ENTRIES; i++) {
+	if (!bench_kind[i].in_composite)
+	    continue;
+
+	keys = g_key_file_get_keys(conf, entries[i].name, NULL, NULL);
+	for (j = 0; keys && keys[j]; j++) {
+	    if (g_hash_table_lookup(seen, keys[j]))
+		continue;
+	    g_hash_table_insert(seen, g_strdup(keys[j]), GINT_TO_POINTER(1));
+
+	    for (k = 0; k < BENCHMARK_N_ENTRIES; k++)
+		results[k] = benchmark_conf_get_result(conf, keys[j], k);
+
+	    score = benchmark_composite(results,
+					benchmark_machine_get_threads(conf,
+								      keys[j]),
+					reference, reference_threads,
+					per_thread, NULL);
+	    if (score > 0) {
+		g_ptr_array_add(names, g_strdup(keys[j]));
+		g_ptr_array_add(scores, g_strdup_printf("%.3f", score));
+	    }
+	}
+	g_strfreev(keys);
+    }
+    g_hash_table_destroy(seen);
+    g_free(reference_name);
+
+  out:
+    g_ptr_array_add(names, NULL);
+    g_ptr_array_add(scores, NULL);
+
+    *machines = (gchar **) g_ptr_array_free(names, FALSE);
+    *values = (gchar **) g_ptr_array_free(scores, FALSE);
+}
+
+static gchar *__benchmark_include_results(gdouble result,
+					  const gchar * benchmark,
+					  ShellOrderType order_type)
+{
+    GKeyFile *conf;
+    gchar **machines, **values;
+    gchar *results, *this_machine, *label, *ret;
+    const gchar *annotation = NULL;
+    ShellViewType view_type;
+    gint i, entry;
+
+    conf = benchmark_load_conf();
+    entry = benchmark_lookup_entry(benchmark);
+
+    if (entry == BENCHMARK_COMPOSITE || entry == BENCHMARK_COMPOSITE_THREAD) {
+	benchmark_get_composite_results(conf,
+					entry == BENCHMARK_COMPOSITE_THREAD,
+					&machines, &values);
+    } else {
+	machines = g_key_file_get_keys(conf, benchmark, NULL, NULL);
+	values = g_new0(gchar *, machines ? g_strv_length(machines) + 1 : 1);
+
+	for (i = 0; machines && machines[i]; i++)
+	    values[i] = g_key_file_get_value(conf, benchmark, machines[i],
+					     NULL);
     }
 
+    results = benchmark_format_machines(conf, machines, values);
+
     g_strfreev(machines);
-    g_free(path);
+    g_strfreev(values);
     g_key_file_free(conf);
 
     DEBUG("results = %s", results);
 
-    return g_strdup_printf("[$ShellParam$]\n"
-			   "Zebra=1\n"
-			   "OrderType=%d\n"
-			   "ViewType=3\n"
-			   "[%s]\n"
-			   "<big><b>This Machine</b></big>=%.3f\n"
-			   "%s", order_type, benchmark, result, results);
+    if (entry >= 0)
+	annotation = bench_annotations[entry];
+
+    if (annotation)
+	label = g_strdup_printf("<big><b>This Machine</b></big> <i>(%s)</i>",
+				annotation);
+    else
+	label = g_strdup("<big><b>This Machine</b></big>");
+
+    /* benchmarks that recorded a breakdown get it in the detail pane */
+    if (g_hash_table_lookup(moreinfo, benchmark)) {
+	this_machine = g_strdup_printf("$%s$%s", benchmark, label);
+	view_type = SHELL_VIEW_PROGRESS_DUAL;
+    } else {
+	this_machine = g_strdup(label);
+	view_type = SHELL_VIEW_PROGRESS;
+    }
+    g_free(label);
+
+    ret = g_strdup_printf("[$ShellParam$]\n"
+			  "Zebra=1\n"
+			  "OrderType=%d\n"
+			  "ViewType=%d\n"
+			  "[%s]\n"
+			  "%s=%.3f\n"
+			  "%s", order_type, view_type, benchmark,
+			  this_machine, result, results);
+
+    g_free(this_machine);
+    g_free(results);
+
+    return ret;
 }
 
 static gchar *benchmark_include_results_reverse(gdouble result,
@@ -122,12 +542,233 @@ static gchar *benchmark_include_results(gdouble result,
 
 static gdouble bench_results[BENCHMARK_N_ENTRIES];
 
+static void benchmark_set_details(const gchar * benchmark, gchar * details)
+{
+    g_hash_table_replace(moreinfo, g_strdup(benchmark), details);
+}
+
+/*
+ * The details of a benchmark without the groups named in groups (a
+ * NULL-terminated list of prefixes), so those can be added again.
+ */
+static gchar *benchmark_get_details_without(const gchar * benchmark,
+					    const gchar ** groups)
+{
+    GString *result;
+    gchar *details, **lines;
+    gboolean skip = FALSE;
+    gint i, j;
+
+    result = g_string_new(NULL);
+    if (!(details = g_hash_table_lookup(moreinfo, benchmark)))
+	return g_string_free(result, FALSE);
+
+    lines = g_strsplit(details, "\n", 0);
+    for (i = 0; lines[i]; i++) {
+	if (*lines[i] == '[') {
+	    for (skip = FALSE, j = 0; groups[j] && !skip; j++)
+		skip = g_str_has_prefix(lines[i], groups[j]);
+	}
+
+	if (!skip && (*lines[i] || lines[i + 1]))
+	    g_string_append_printf(result, "%s\n", lines[i]);
+    }
+    g_strfreev(lines);
+
+    return g_string_free(result, FALSE);
+}
+
+/* set by a benchmark that cannot run here, e.g. for a missing library */
+static const gchar *bench_skip_reason = NULL;
+
+static void benchmark_skip(const gchar * reason)
+{
+    bench_skip_reason = reason;
+}
+
+#define BENCHMARK_TIMEOUT	600
+
+/*
+ * The processors this process may run on, not just the online ones: its
+ * affinity mask, its cpuset and its CPU quota all limit the number.
+ */
+static gint benchmark_get_n_threads(void)
+{
+    CgroupLimits limits;
+    glong n = sysconf(_SC_NPROCESSORS_ONLN);
+    CpuMask mask;
+    gint allowed;
+
+    if (cpu_mask_get_affinity(&mask)) {
+	allowed = cpu_mask_count(&mask);
+	if (allowed > 0 && (n <= 0 || allowed < n))
+	    n = allowed;
+    }
+
+    /* threads beyond the CFS quota only wait for the throttle to lift */
+    cgroup_get_limits(&limits);
+    if (limits.cpuset_cpus > 0 && (n <= 0 || limits.cpuset_cpus < n))
+	n = limits.cpuset_cpus;
+    if (limits.cpu_quota > 0 && (n <= 0 || ceil(limits.cpu_quota) < n))
+	n = (glong) ceil(limits.cpu_quota);
+    cgroup_limits_free(&limits);
+
+    return n > 0 ? (gint) n : 1;
+}
+
+static guint64 benchmark_get_physical_memory(void)
+{
+    glong pages = sysconf(_SC_PHYS_PAGES);
+    glong page_size = sysconf(_SC_PAGESIZE);
+
+    if (pages <= 0 || page_size <= 0)
+	return 256 * 1024 * 1024;
+
+    return (guint64) pages * (guint64) page_size;
+}
+
+/* what the memory cgroup lets us have, or all of it */
+static guint64 benchmark_get_available_memory(void)
+{
+    CgroupLimits limits;
+    guint64 memory = benchmark_get_physical_memory();
+
+    cgroup_get_limits(&limits);
+    if (limits.memory_max > 0 && limits.memory_max < memory)
+	memory = limits.memory_max;
+    cgroup_limits_free(&limits);
+
+    return memory;
+}
+
+/*
+ * Thread counts to try when measuring scaling: 1, 2, 4, ... and finally
+ * the number of online processors. Returns 0 after the last one.
+ */
+static gint benchmark_next_thread_count(gint current, gint max)
+{
+    if (current >= max)
+	return 0;
+
+    return MIN(current * 2, max);
+}
+
+typedef struct _ParallelBenchmark ParallelBenchmark;
+typedef struct _ParallelGate ParallelGate;
+
+/* holds the threads until all of them exist, or tells them to give up */
+struct _ParallelGate {
+    GMutex *lock;
+    GCond *cond;
+    gboolean open, cancelled;
+};
+
+struct _ParallelBenchmark {
+    gint thread_number;
+    gpointer data;
+    void (*callback) (gint thread_number, gpointer data);
+    ParallelGate *gate;
+};
+
+static gpointer benchmark_parallel_dispatcher(gpointer data)
+{
+    ParallelBenchmark *pb = (ParallelBenchmark *) data;
+    gboolean cancelled;
+
+    g_mutex_lock(pb->gate->lock);
+    while (!pb->gate->open)
+	g_cond_wait(pb->gate->cond, pb->gate->lock);
+    cancelled = pb->gate->cancelled;
+    g_mutex_unlock(pb->gate->lock);
+
+    if (!cancelled)
+	pb->callback(pb->thread_number, pb->data);
+
+    return NULL;
+}
+
+/*
+ * Runs callback on n_threads threads at once and returns the wall clock
+ * time, in seconds, until the last one finished. If not every thread can
+ * be created, callback does not run at all and -1 is returned: kernels
+ * that wait for their siblings would never finish, and fewer threads
+ * would not be the measurement that was asked for.
+ */
+static gdouble benchmark_parallel(gint n_threads,
+				  void (*callback) (gint thread_number,
+						    gpointer data),
+				  gpointer data)
+{
+    ParallelBenchmark *pb;
+    ParallelGate gate;
+    GThread **threads;
+    GTimer *timer;
+    gdouble elapsed;
+    gint i;
+
+    pb = g_new0(ParallelBenchmark, n_threads);
+    threads = g_new0(GThread *, n_threads);
+    timer = g_timer_new();
+
+    gate.lock = g_mutex_new();
+    gate.cond = g_cond_new();
+    gate.open = gate.cancelled = FALSE;
+
+    for (i = 0; i < n_threads; i++) {
+	pb[i].thread_number = i;
+	pb[i].data = data;
+	pb[i].callback = callback;
+	pb[i].gate = &gate;
+
+	threads[i] = g_thread_create(benchmark_parallel_dispatcher, &pb[i],
+				     TRUE, NULL);
+	if (!threads[i]) {
+	    DEBUG("could not create thread %d of %d", i, n_threads);
+	    gate.cancelled = TRUE;
+	    break;
+	}
+    }
+
+    g_mutex_lock(gate.lock);
+    gate.open = TRUE;
+    g_cond_broadcast(gate.cond);
+    g_mutex_unlock(gate.lock);
+
+    g_timer_start(timer);
+    for (i = 0; i < n_threads; i++) {
+	if (threads[i])
+	    g_thread_join(threads[i]);
+    }
+    g_timer_stop(timer);
+
+    elapsed = gate.cancelled ? -1 : g_timer_elapsed(timer, NULL);
+
+    g_mutex_free(gate.lock);
+    g_cond_free(gate.cond);
+    g_timer_destroy(timer);
+    g_free(threads);
+    g_free(pb);
+
+    return elapsed;
+}
+
 #include <arch/common/fib.h>
 #include <arch/common/zlib.h>
 #include <arch/common/md5.h>
 #include <arch/common/sha1.h>
 #include <arch/common/blowfish.h>
 #include <arch/common/raytrace.h>
+#include <arch/common/procspawn.h>
+#include <arch/common/aes.h>
+#include <arch/common/pathtracer.h>
+#include <arch/common/sorting.h>
+#include <arch/common/smt.h>
+#include <arch/common/libcrypto.h>
+
+#include <arch/this/perfcount.h>
+#include <arch/this/virt.h>
+#include <arch/this/coreclass.h>
+#include <arch/this/environment.h>
 
 gchar *callback_zlib()
 {
@@ -165,131 +806,1043 @@ gchar *callback_sha1()
 					     "CPU SHA1");
 }
 
-#define RUN_WITH_HIGH_PRIORITY(fn)			\
-  do {							\
-    int old_priority = getpriority(PRIO_PROCESS, 0);	\
-    setpriority(PRIO_PROCESS, 0, -20);			\
-    fn();						\
-    setpriority(PRIO_PROCESS, 0, old_priority);		\
-  } while (0);
-
-void scan_zlib(gboolean reload)
+gchar *callback_procspawn()
 {
-    SCAN_START();
-    RUN_WITH_HIGH_PRIORITY(benchmark_zlib);
-    SCAN_END();
+    return benchmark_include_results_reverse(bench_results[BENCHMARK_PROCSPAWN],
+					     "CPU Process Creation");
 }
 
-void scan_raytr(gboolean reload)
+gchar *callback_aes()
 {
-    SCAN_START();
-    RUN_WITH_HIGH_PRIORITY(benchmark_raytrace);
-    SCAN_END();
+    return benchmark_include_results_reverse(bench_results[BENCHMARK_AES],
+					     "CPU AES");
 }
 
-void scan_bfsh(gboolean reload)
+gchar *callback_pzlib()
 {
-    SCAN_START();
-    RUN_WITH_HIGH_PRIORITY(benchmark_fish);
-    SCAN_END();
+    return benchmark_include_results_reverse(bench_results[BENCHMARK_PZLIB],
+					     "CPU Parallel ZLib");
 }
 
-void scan_md5(gboolean reload)
+gchar *callback_pathtrace()
 {
-    SCAN_START();
-    RUN_WITH_HIGH_PRIORITY(benchmark_md5);
-    SCAN_END();
+    return benchmark_include_results_reverse(bench_results[BENCHMARK_PATHTRACE],
+					     "FPU Path Tracing");
 }
 
-void scan_fib(gboolean reload)
+gchar *callback_sorting()
 {
-    SCAN_START();
-    RUN_WITH_HIGH_PRIORITY(benchmark_fib);
-    SCAN_END();
+    return benchmark_include_results_reverse(bench_results[BENCHMARK_SORTING],
+					     "CPU Sorting and Hashing");
 }
 
-void scan_sha1(gboolean reload)
+gchar *callback_pfib()
 {
-    SCAN_START();
-    RUN_WITH_HIGH_PRIORITY(benchmark_sha1);
-    SCAN_END();
+    return benchmark_include_results(bench_results[BENCHMARK_PFIB],
+				     "CPU Fibonacci (Parallel)");
 }
 
-const gchar *hi_note_func(gint entry)
+gchar *callback_smt()
 {
-    switch (entry) {
-    case BENCHMARK_ZLIB:
-	return "Results in KiB/second. Higher is better.";
-
-    case BENCHMARK_MD5:
-    case BENCHMARK_SHA1:
-	return "Results in MiB/second. Higher is better.";
-
-    case BENCHMARK_RAYTRACE:
-    case BENCHMARK_BLOWFISH:
-    case BENCHMARK_FIB:
-	return "Results in seconds. Lower is better.";
-    }
-
-    return NULL;
+    return benchmark_include_results_reverse(bench_results[BENCHMARK_SMT],
+					     "CPU SMT Interference");
 }
 
-gchar *hi_module_get_name(void)
+gchar *callback_libcrypto()
 {
-    return g_strdup("Benchmarks");
+    return benchmark_include_results_reverse(bench_results
+					     [BENCHMARK_LIBCRYPTO],
+					     "CPU Crypto Library");
 }
 
-guchar hi_module_get_weight(void)
+gchar *callback_composite()
 {
-    return 240;
+    return benchmark_include_results_reverse(bench_results[BENCHMARK_COMPOSITE],
+					     "Composite Score");
 }
 
-ModuleEntry *hi_module_get_entries(void)
+gchar *callback_composite_thread()
 {
-    return entries;
+    return
+	benchmark_include_results_reverse(bench_results
+					  [BENCHMARK_COMPOSITE_THREAD],
+					  "Composite Score (per Thread)");
 }
 
-ModuleAbout *hi_module_get_about(void)
+static gchar *benchmark_read_clock(const gchar * file)
 {
-    static ModuleAbout ma[] = {
-	{
-	 .author = "Leandro A. F. Pereira",
-	 .description = "Perform tasks and compare with other systems",
-	 .version = VERSION,
-	 .license = "GNU GPL version 2"}
-    };
+    gchar *path, *contents, *clock = NULL;
 
-    return ma;
+    path = g_strdup_printf("/sys/devices/system/cpu/cpu0/cpufreq/%s", file);
+    if (g_file_get_contents(path, &contents, NULL, NULL)) {
+	/* sysfs has kHz */
+	clock = g_strdup_printf("%d MHz", atoi(contents) / 1000);
+	g_free(contents);
+    }
+    g_free(path);
+
+    return clock;
 }
 
-static gchar *get_benchmark_results()
+static gint benchmark_count_cores(void)
+{
+    GHashTable *cores;
+    gchar *path, *package, *core, *key;
+    glong n_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    gint i, n;
+
+    cores = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    for (i = 0; i < n_cpus && i < CPU_MASK_MAX_CPUS; i++) {
+	path = g_strdup_printf("/sys/devices/system/cpu/cpu%d/topology/"
+			       "physical_package_id", i);
+	if (!g_file_get_contents(path, &package, NULL, NULL)) {
+	    g_free(path);
+	    continue;
+	}
+	g_free(path);
+
+	path = g_strdup_printf("/sys/devices/system/cpu/cpu%d/topology/"
+			       "core_id", i);
+	if (g_file_get_contents(path, &core, NULL, NULL)) {
+	    key = g_strdup_printf("%d:%d", atoi(package), atoi(core));
+	    g_hash_table_replace(cores, key, GINT_TO_POINTER(1));
+	    g_free(core);
+	}
+	g_free(path);
+	g_free(package);
+    }
+
+    n = g_hash_table_size(cores);
+    g_hash_table_destroy(cores);
+
+    return n;
+}
+
+/* the same keys as a [Machine: ...] group, for this machine */
+static gchar *benchmark_get_machine_info(gint key)
+{
+    struct utsname un;
+    gchar *clock;
+
+    switch (key) {
+    case MACHINE_CPU_MODEL:
+	return module_call_method("devices::getProcessorName");
+    case MACHINE_CORES:
+	return g_strdup_printf("%d", benchmark_count_cores());
+    case MACHINE_THREADS:
+	return g_strdup_printf("%ld", sysconf(_SC_NPROCESSORS_ONLN));
+    case MACHINE_BASE_CLOCK:
+	if ((clock = benchmark_read_clock("base_frequency")))
+	    return clock;
+	return benchmark_read_clock("cpuinfo_min_freq");
+    case MACHINE_MAX_CLOCK:
+	return benchmark_read_clock("cpuinfo_max_freq");
+    case MACHINE_MEMORY:
+	return g_strdup_printf("%" G_GUINT64_FORMAT " MiB",
+			       benchmark_get_physical_memory() /
+			       (1024 * 1024));
+    case MACHINE_KERNEL:
+	if (uname(&un) == 0)
+	    return g_strdup(un.release);
+	return NULL;
+    case MACHINE_COMPILER:
+#ifdef __GNUC__
+	return g_strdup("GCC " __VERSION__);
+#else
+	return NULL;
+#endif
+    }
+
+    return NULL;
+}
+
+static void benchmark_calculate_composite(void)
+{
+    GKeyFile *conf;
+    gdouble reference[BENCHMARK_N_ENTRIES], ratio;
+    gchar *reference_name, *details, *value;
+    gint i, n_compared, threads, reference_threads;
+
+    conf = benchmark_load_conf();
+    reference_name = benchmark_get_reference_machine(conf);
+
+    bench_results[BENCHMARK_COMPOSITE] = 0;
+    bench_results[BENCHMARK_COMPOSITE_THREAD] = 0;
+
+    if (!reference_name) {
+	details = g_strdup("[Composite Score]\n"
+			   "Reference=None configured\n");
+	goto out;
+    }
+
+    for (i = 0; i < BENCHMARK_N_ENTRIES; i++)
+	reference[i] = benchmark_conf_get_result(conf, reference_name, i);
+    reference_threads = benchmark_machine_get_threads(conf, reference_name);
+    threads = benchmark_get_n_threads();
+
+    bench_results[BENCHMARK_COMPOSITE] =
+	benchmark_composite(bench_results, threads, reference,
+			    reference_threads, FALSE, &n_compared);
+    bench_results[BENCHMARK_COMPOSITE_THREAD] =
+	benchmark_composite(bench_results, threads, reference,
+			    reference_threads, TRUE, NULL);
+
+    details = g_strdup_printf("[Composite Score]\n"
+			      "Reference=%s (100)\n"
+			      "Benchmarks Compared=%d\n"
+			      "[This Machine]\n",
+			      reference_name, n_compared);
+
+    for (i = 0; i < MACHINE_N_KEYS; i++) {
+	value = benchmark_get_machine_info(i);
+	details = h_strdup_cprintf("%s=%s\n", details, machine_keys[i],
+				   value ? value : "Unknown");
+	g_free(value);
+    }
+
+    details = h_strdup_cprintf("[Relative to Reference]\n", details);
+    for (i = 0; i < BENCHMARK_N_ENTRIES; i++) {
+	if (!bench_kind[i].in_composite)
+	    continue;
+
+	if (bench_results[i] <= 0 || reference[i] <= 0) {
+	    details = h_strdup_cprintf("%s=Not compared\n", details,
+				       entries[i].name);
+	    continue;
+	}
+
+	ratio = bench_kind[i].higher_is_better ?
+	    bench_results[i] / reference[i] : reference[i] / bench_results[i];
+	details = h_strdup_cprintf("%s=%.2fx%s\n", details, entries[i].name,
+				   ratio, bench_kind[i].all_cores ?
+				   " (all processors)" : "");
+    }
+
+  out:
+    benchmark_set_details(entries[BENCHMARK_COMPOSITE].name, details);
+    benchmark_set_details(entries[BENCHMARK_COMPOSITE_THREAD].name,
+			  g_strdup(details));
+
+    g_free(reference_name);
+    g_key_file_free(conf);
+}
+
+static void benchmark_run_in_process(gint entry,
+				     void (*benchmark_function) (void))
+{
+    static const gchar *run_groups[] = {
+	"[Virtualization]", "[Performance Counters]", NULL
+    };
+    PerfCounters counters;
+    VirtSample sample;
+    gchar *details, *counter_info, *virt_info, *hypervisor, *problem;
+    const gchar *source;
+    int old_priority = getpriority(PRIO_PROCESS, 0);
+
+    g_hash_table_remove(moreinfo, entries[entry].name);
+
+    setpriority(PRIO_PROCESS, 0, -20);
+    virt_sample_start(&sample);
+    perf_counters_start(&counters);
+    benchmark_function();
+    perf_counters_stop(&counters);
+    virt_sample_stop(&sample, benchmark_get_n_threads());
+    setpriority(PRIO_PROCESS, 0, old_priority);
+
+    counter_info = perf_counters_get_info(&counters);
+    virt_info = virt_sample_get_info(&sample);
+    details = benchmark_get_details_without(entries[entry].name,
+					    run_groups);
+    benchmark_set_details(entries[entry].name,
+			  g_strconcat(virt_info, counter_info, details,
+				      NULL));
+    g_free(details);
+
+    hypervisor = virt_get_hypervisor(&source);
+    problem = virt_sample_get_problem(&sample);
+
+    g_free(bench_annotations[entry]);
+    if (problem)
+	bench_annotations[entry] = g_strdup_printf("%s%sunreliable: %s",
+						   hypervisor ? hypervisor : "",
+						   hypervisor ? ", " : "",
+						   problem);
+    else
+	bench_annotations[entry] = hypervisor ? g_strdup(hypervisor) : NULL;
+    bench_unreliable[entry] = problem != NULL;
+
+    /* kept out of uploads like an unreliable result */
+    if (bench_skip_reason) {
+	g_free(bench_annotations[entry]);
+	bench_annotations[entry] = g_strdup_printf("skipped: %s",
+						   bench_skip_reason);
+	bench_unreliable[entry] = TRUE;
+	bench_skip_reason = NULL;
+    }
+
+    g_free(hypervisor);
+    g_free(problem);
+    g_free(virt_info);
+    g_free(counter_info);
+    g_free(counters.error);
+}
+
+static gboolean benchmark_write_all(gint fd, gconstpointer data, gsize size)
+{
+    const gchar *p = data;
+    gssize written;
+
+    while (size > 0) {
+	written = write(fd, p, size);
+	if (written < 0 && errno == EINTR)
+	    continue;
+	if (written <= 0)
+	    return FALSE;
+
+	p += written;
+	size -= written;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Runs in the forked helper: applies the CPU mask and resource limits,
+ * runs the benchmark and sends the result, followed by its details, back
+ * through fd.
+ */
+static void benchmark_run_child(gint entry, void (*benchmark_function) (void),
+				const gchar * cpu_list, gint fd)
+{
+    struct rlimit limit;
+    CpuMask cpus;
+    gchar *details, *annotation;
+
+    /* the X connection belongs to the parent: never touch it from here */
+    if (params.gui_running) {
+	gint null = open("/dev/null", O_WRONLY);
+
+	if (null >= 0) {
+	    dup2(null, STDERR_FILENO);
+	    close(null);
+	}
+	params.gui_running = FALSE;
+    }
+
+    limit.rlim_cur = limit.rlim_max = 0;
+    setrlimit(RLIMIT_CORE, &limit);
+
+    limit.rlim_cur = limit.rlim_max = benchmark_get_available_memory();
+    setrlimit(RLIMIT_DATA, &limit);
+
+    if (cpu_list) {
+	if (!cpu_mask_parse(&cpus, cpu_list)
+	    || !cpu_mask_set_affinity(&cpus))
+	    DEBUG("cannot restrict benchmark to CPUs %s", cpu_list);
+    }
+
+    bench_results[entry] = 0;
+    benchmark_run_in_process(entry, benchmark_function);
+
+    /* result, reliability, annotation and details, in this order */
+    annotation = bench_annotations[entry] ? bench_annotations[entry] : "";
+    details = g_hash_table_lookup(moreinfo, entries[entry].name);
+    if (benchmark_write_all(fd, &bench_results[entry], sizeof(gdouble))
+	&& benchmark_write_all(fd, &bench_unreliable[entry], sizeof(gboolean))
+	&& benchmark_write_all(fd, annotation, strlen(annotation) + 1)
+	&& details)
+	benchmark_write_all(fd, details, strlen(details));
+
+    close(fd);
+    _exit(0);
+}
+
+/*
+ * Runs a benchmark in a forked helper, so a crash or a runaway kernel
+ * cannot take the user interface down, and so every run starts from the
+ * same process state. The helper is killed after BENCHMARK_TIMEOUT seconds.
+ * If cpu_list is not NULL, the helper only runs on those processors.
+ */
+static void benchmark_run_isolated(gint entry,
+				   void (*benchmark_function) (void),
+				   const gchar * cpu_list)
+{
+    GString *output;
+    GTimer *timer;
+    gchar buffer[4096], *status, *failure = NULL, *annotation;
+    gsize header = sizeof(gdouble) + sizeof(gboolean), annotation_len = 0;
+    gint fds[2], child_status;
+    gboolean timed_out = FALSE;
+    pid_t pid;
+
+    if (params.benchmark_in_process || pipe(fds) < 0) {
+	benchmark_run_in_process(entry, benchmark_function);
+	return;
+    }
+
+    /* mapped here, so the helpers share one mapping instead of each
+       mapping benchmark.data again */
+    corpus_release(corpus_get(CORPUS_FILE, 0, 0));
+
+    pid = fork();
+    if (pid < 0) {
+	close(fds[0]);
+	close(fds[1]);
+
+	benchmark_run_in_process(entry, benchmark_function);
+	return;
+    }
+
+    if (pid == 0) {
+	close(fds[0]);
+	benchmark_run_child(entry, benchmark_function, cpu_list, fds[1]);
+    }
+
+    close(fds[1]);
+
+    g_hash_table_remove(moreinfo, entries[entry].name);
+    bench_results[entry] = 0;
+    bench_unreliable[entry] = FALSE;
+    g_free(bench_annotations[entry]);
+    bench_annotations[entry] = NULL;
+
+    status = g_strdup_printf("Running %s...", entries[entry].name);
+    shell_view_set_enabled(FALSE);
+    shell_status_update(status);
+    g_free(status);
+
+    output = g_string_new(NULL);
+    timer = g_timer_new();
+
+    for (;;) {
+	struct pollfd pfd = { fds[0], POLLIN, 0 };
+	gssize n;
+	gint ready;
+
+	if (g_timer_elapsed(timer, NULL) > BENCHMARK_TIMEOUT) {
+	    kill(pid, SIGKILL);
+	    timed_out = TRUE;
+	    break;
+	}
+
+	ready = poll(&pfd, 1, 100);
+	if (ready < 0 && errno != EINTR)
+	    break;
+
+	if (ready > 0) {
+	    n = read(fds[0], buffer, sizeof(buffer));
+	    if (n == 0 || (n < 0 && errno != EINTR))
+		break;
+	    if (n > 0)
+		g_string_append_len(output, buffer, n);
+	}
+
+	if (params.gui_running)
+	    shell_status_pulse();
+    }
+
+    close(fds[0]);
+    waitpid(pid, &child_status, 0);
+    g_timer_destroy(timer);
+
+    if (timed_out) {
+	failure = g_strdup_printf("Killed after %d seconds", BENCHMARK_TIMEOUT);
+    } else if (WIFSIGNALED(child_status)) {
+	failure = g_strdup_printf("Crashed (%s)",
+				  g_strsignal(WTERMSIG(child_status)));
+    } else if (output->len <= header
+	       || !(annotation = memchr(output->str + header, '\0',
+				       output->len - header))) {
+	failure = g_strdup("No result");
+    } else {
+	annotation_len = annotation - (output->str + header);
+    }
+
+    if (failure) {
+	benchmark_set_details(entries[entry].name,
+			      g_strdup_printf("[Isolation]\n"
+					      "Status=%s\n", failure));
+	g_free(failure);
+    } else {
+	memcpy(&bench_results[entry], output->str, sizeof(gdouble));
+	memcpy(&bench_unreliable[entry], output->str + sizeof(gdouble),
+	       sizeof(gboolean));
+	if (annotation_len > 0)
+	    bench_annotations[entry] = g_strdup(output->str + header);
+
+	header += annotation_len + 1;
+	if (output->len > header)
+	    benchmark_set_details(entries[entry].name,
+				  g_strdup(output->str + header));
+    }
+
+    g_string_free(output, TRUE);
+}
+
+static gboolean benchmark_is_better(gint entry, gdouble result, gdouble than)
+{
+    if (result <= 0)
+	return FALSE;
+    if (than <= 0)
+	return TRUE;
+
+    return bench_kind[entry].higher_is_better ? result > than : result < than;
+}
+
+/*
+ * On machines with more than one kind of core (P/E cores, big.LITTLE),
+ * the benchmark also runs confined to each core class. Single-threaded
+ * benchmarks report the best class; the all-core ones report the run on
+ * every processor, with what each class manages on its own.
+ */
+static void benchmark_run_per_class(gint entry,
+				    void (*benchmark_function) (void))
+{
+    static GSList *classes = NULL;
+    static gboolean classes_scanned = FALSE;
+    GSList *l;
+    gdouble *class_results, best_result = 0, total, ratio;
+    gchar *best_details = NULL, *best_annotation = NULL;
+    gchar *class_info, *details;
+    gboolean best_unreliable = FALSE;
+    gint i, n_classes;
+
+    /* scanning moves this thread over every CPU: do it once */
+    if (!classes_scanned) {
+	classes = coreclass_scan();
+	classes_scanned = TRUE;
+    }
+    n_classes = g_slist_length(classes);
+
+    /* the SMT test places its own threads, and an explicit mask wins */
+    if (n_classes < 2 || entry == BENCHMARK_SMT || params.benchmark_cpus
+	|| params.benchmark_in_process) {
+	benchmark_run_isolated(entry, benchmark_function,
+			       params.benchmark_cpus);
+	return;
+    }
+
+    class_results = g_new0(gdouble, n_classes);
+    for (i = 0, l = classes; l; l = l->next, i++) {
+	CoreClass *class = (CoreClass *) l->data;
+
+	benchmark_run_isolated(entry, benchmark_function, class->cpu_list);
+	class_results[i] = bench_results[entry];
+
+	if (!benchmark_is_better(entry, class_results[i], best_result))
+	    continue;
+
+	best_result = class_results[i];
+	best_unreliable = bench_unreliable[entry];
+
+	g_free(best_annotation);
+	best_annotation = bench_annotations[entry];
+	bench_annotations[entry] = NULL;
+
+	g_free(best_details);
+	best_details = g_strdup(g_hash_table_lookup(moreinfo,
+						    entries[entry].name));
+    }
+
+    if (bench_kind[entry].all_cores) {
+	benchmark_run_isolated(entry, benchmark_function, NULL);
+
+	g_free(best_annotation);
+	g_free(best_details);
+    } else {
+	bench_results[entry] = best_result;
+	bench_unreliable[entry] = best_unreliable;
+
+	g_free(bench_annotations[entry]);
+	bench_annotations[entry] = best_annotation;
+
+	if (best_details)
+	    benchmark_set_details(entries[entry].name, best_details);
+	else
+	    g_hash_table_remove(moreinfo, entries[entry].name);
+    }
+
+    /* single-threaded: relative to the best class; all-core: the share of
+       the whole machine each class gets alone */
+    total = bench_results[entry];
+    class_info = g_strdup("[Core Classes]\n");
+    for (i = 0, l = classes; l; l = l->next, i++) {
+	CoreClass *class = (CoreClass *) l->data;
+
+	if (class_results[i] <= 0 || total <= 0) {
+	    class_info = h_strdup_cprintf("%s (%s)=Not available\n",
+					  class_info, class->name,
+					  class->cpu_list);
+	    continue;
+	}
+
+	ratio = bench_kind[entry].higher_is_better ?
+	    class_results[i] / total : total / class_results[i];
+	class_info = h_strdup_cprintf("%s (%s)=%.3f (%.0f%%%s)\n",
+				      class_info, class->name,
+				      class->cpu_list, class_results[i],
+				      100 * ratio,
+				      bench_kind[entry].all_cores ?
+				      " of all processors" : "");
+    }
+
+    details = g_hash_table_lookup(moreinfo, entries[entry].name);
+    benchmark_set_details(entries[entry].name,
+			  g_strconcat(class_info, details ? details : "",
+				      NULL));
+
+    g_free(class_info);
+    g_free(class_results);
+}
+
+static GHashTable *benchmark_environment_parse(const gchar * environment)
+{
+    GHashTable *settings;
+    gchar **lines, **setting;
+    gint i;
+
+    settings = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+    lines = g_strsplit(environment, "\n", 0);
+    for (i = 0; lines[i]; i++) {
+	setting = g_strsplit(lines[i], "=", 2);
+	if (setting[0] && setting[1])
+	    g_hash_table_replace(settings, g_strdup(setting[0]),
+				 g_strdup(setting[1]));
+	g_strfreev(setting);
+    }
+    g_strfreev(lines);
+
+    return settings;
+}
+
+/*
+ * Appends the settings that differ from the other environment, in the
+ * order of the first one; settings the other does not know are skipped.
+ */
+static gchar *benchmark_environment_diff(gchar * details,
+					 const gchar * environment,
+					 GHashTable * other,
+					 const gchar * format)
+{
+    GHashTable *settings;
+    gchar **lines, *key, *value, *other_value;
+    gint i, n_differences = 0;
+
+    settings = benchmark_environment_parse(environment);
+
+    lines = g_strsplit(environment, "\n", 0);
+    for (i = 0; lines[i]; i++) {
+	if (!(value = strchr(lines[i], '=')))
+	    continue;
+
+	key = g_strndup(lines[i], value - lines[i]);
+	value = g_hash_table_lookup(settings, key);
+	other_value = g_hash_table_lookup(other, key);
+
+	if (other_value && !g_str_equal(value, other_value)) {
+	    details = h_strdup_cprintf(format, details, key, value,
+				       other_value);
+	    n_differences++;
+	}
+
+	g_free(key);
+    }
+    g_strfreev(lines);
+    g_hash_table_destroy(settings);
+
+    if (!n_differences)
+	details = h_strdup_cprintf("No differences=\n", details);
+
+    return details;
+}
+
+/*
+ * Stores the environment with the result, and shows it together with what
+ * changed since the previous run and how it differs from the reference
+ * machine's, when that is known.
+ */
+static void benchmark_set_environment(gint entry, gchar * environment)
+{
+    static const gchar *environment_groups[] = {
+	"[Environment]", "[Changed Since Previous Run]", "[Differences from ",
+	NULL
+    };
+    GKeyFile *conf;
+    GHashTable *other;
+    gchar *details, *reference, *group, **keys, *value;
+    gint i;
+
+    details = g_strdup_printf("[Environment]\n%s", environment);
+
+    if (bench_environment[entry]) {
+	other = benchmark_environment_parse(bench_environment[entry]);
+	details = h_strdup_cprintf("[Changed Since Previous Run]\n", details);
+	details = benchmark_environment_diff(details, environment, other,
+					     "%s=%s (was %s)\n");
+	g_hash_table_destroy(other);
+    }
+
+    conf = benchmark_load_conf();
+    if ((reference = benchmark_get_reference_machine(conf))) {
+	group = g_strdup_printf("Machine: %s", reference);
+	other = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+				      g_free);
+
+	keys = g_key_file_get_keys(conf, group, NULL, NULL);
+	for (i = 0; keys && keys[i]; i++) {
+	    if ((value = g_key_file_get_value(conf, group, keys[i], NULL)))
+		g_hash_table_replace(other, g_strdup(keys[i]), value);
+	}
+	g_strfreev(keys);
+
+	details = h_strdup_cprintf("[Differences from %s]\n", details,
+				   reference);
+	details = benchmark_environment_diff(details, environment, other,
+					     "%s=%s (reference: %s)\n");
+
+	g_hash_table_destroy(other);
+	g_free(group);
+	g_free(reference);
+    }
+    g_key_file_free(conf);
+
+    value = benchmark_get_details_without(entries[entry].name,
+					  environment_groups);
+    benchmark_set_details(entries[entry].name,
+			  g_strconcat(value, details, NULL));
+    g_free(details);
+    g_free(value);
+
+    g_free(bench_environment[entry]);
+    bench_environment[entry] = environment;
+}
+
+static void benchmark_run(gint entry, void (*benchmark_function) (void))
+{
+    CgroupLimits limits;
+    gchar *environment, *cgroup;
+
+    /* taken before the run, so the load average is the background load */
+    environment = environment_snapshot();
+
+    /* and what the benchmarks were sized for */
+    cgroup_get_limits(&limits);
+    cgroup = cgroup_get_info(&limits);
+    cgroup_limits_free(&limits);
+
+    environment = h_strdup_cprintf("%sUsable Processors=%d\n"
+				   "Usable Memory=%" G_GUINT64_FORMAT " MiB\n",
+				   environment, cgroup,
+				   benchmark_get_n_threads(),
+				   benchmark_get_available_memory() /
+				   (1024 * 1024));
+    g_free(cgroup);
+
+    benchmark_run_per_class(entry, benchmark_function);
+    benchmark_set_environment(entry, environment);
+}
+
+void scan_zlib(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_ZLIB, benchmark_zlib);
+    SCAN_END();
+}
+
+void scan_raytr(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_RAYTRACE, benchmark_raytrace);
+    SCAN_END();
+}
+
+void scan_bfsh(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_BLOWFISH, benchmark_fish);
+    SCAN_END();
+}
+
+void scan_md5(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_MD5, benchmark_md5);
+    SCAN_END();
+}
+
+void scan_fib(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_FIB, benchmark_fib);
+    SCAN_END();
+}
+
+void scan_sha1(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_SHA1, benchmark_sha1);
+    SCAN_END();
+}
+
+void scan_procspawn(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_PROCSPAWN, benchmark_procspawn);
+    SCAN_END();
+}
+
+void scan_aes(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_AES, benchmark_aes);
+    SCAN_END();
+}
+
+void scan_pzlib(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_PZLIB, benchmark_pzlib);
+    SCAN_END();
+}
+
+void scan_pathtrace(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_PATHTRACE, benchmark_pathtrace);
+    SCAN_END();
+}
+
+void scan_sorting(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_SORTING, benchmark_sorting);
+    SCAN_END();
+}
+
+void scan_pfib(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_PFIB, benchmark_pfib);
+    SCAN_END();
+}
+
+void scan_smt(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_SMT, benchmark_smt);
+    SCAN_END();
+}
+
+void scan_libcrypto(gboolean reload)
+{
+    SCAN_START();
+    benchmark_run(BENCHMARK_LIBCRYPTO, benchmark_libcrypto);
+    SCAN_END();
+}
+
+void scan_composite(gboolean reload)
 {
     void (*scan_callback) (gboolean rescan);
+    gint i;
 
-    gint i = G_N_ELEMENTS(entries) - 1;
-    gchar *machine = module_call_method("devices::getProcessorName");
-    gchar *param = g_strdup_printf("[param]\n"
-				   "machine=%s\n" "nbenchmarks=%d\n",
-				   machine, i);
-    gchar *result = param;
+    SCAN_START();
+
+    for (i = 0; i < BENCHMARK_N_ENTRIES; i++) {
+	if (bench_kind[i].in_composite
+	    && (scan_callback = entries[i].scan_callback))
+	    scan_callback(FALSE);
+    }
+    benchmark_calculate_composite();
+
+    SCAN_END();
+}
+
+const gchar *hi_note_func(gint entry)
+{
+    switch (entry) {
+    case BENCHMARK_ZLIB:
+	return "Results in KiB/second. Higher is better.";
+
+    case BENCHMARK_MD5:
+    case BENCHMARK_SHA1:
+    case BENCHMARK_AES:
+	return "Results in MiB/second. Higher is better.";
+
+    case BENCHMARK_LIBCRYPTO:
+	return "Results in MiB/second, geometric mean of the system "
+	    "libcrypto's MD5, SHA-1, SHA-256 and AES-128-GCM. Higher is better.";
+
+    case BENCHMARK_PROCSPAWN:
+	return "Results in operations/second. Higher is better.";
+
+    case BENCHMARK_PZLIB:
+	return "Results in MB/second, using all processors. Higher is better.";
+
+    case BENCHMARK_PATHTRACE:
+	return "Results in millions of rays/second, using all processors. "
+	       "Higher is better.";
+
+    case BENCHMARK_SORTING:
+	return "Results in millions of keys/second, using all processors. "
+	       "Higher is better.";
+
+    case BENCHMARK_COMPOSITE:
+	return "Results relative to the reference machine, which scores 100. "
+	       "Higher is better.";
+
+    case BENCHMARK_COMPOSITE_THREAD:
+	return "Results relative to the reference machine, which scores 100, "
+	       "with multi-threaded results divided by the thread count. "
+	       "Higher is better.";
+
+    case BENCHMARK_SMT:
+	return "Results in combined throughput of two SMT siblings, relative "
+	       "to one thread alone. Higher is better.";
+
+    case BENCHMARK_PFIB:
+	return "Results in seconds, using all processors. Lower is better.";
+
+    case BENCHMARK_RAYTRACE:
+    case BENCHMARK_BLOWFISH:
+    case BENCHMARK_FIB:
+	return "Results in seconds. Lower is better.";
+    }
+
+    return NULL;
+}
+
+gchar *hi_module_get_name(void)
+{
+    return g_strdup("Benchmarks");
+}
+
+guchar hi_module_get_weight(void)
+{
+    return 240;
+}
+
+ModuleEntry *hi_module_get_entries(void)
+{
+    return entries;
+}
+
+gchar *hi_more_info(gchar * entry)
+{
+    gchar *info = (gchar *) g_hash_table_lookup(moreinfo, entry);
+
+    if (info)
+	return g_strdup(info);
+
+    return g_strdup("?");
+}
+
+ModuleAbout *hi_module_get_about(void)
+{
+    static ModuleAbout ma[] = {
+	{
+	 .author = "Leandro A. F. Pereira",
+	 .description = "Perform tasks and compare with other systems",
+	 .version = VERSION,
+	 .license = "GNU GPL version 2"}
+    };
+
+    return ma;
+}
+
+/*
+ * Environment settings that are shown and compared here but never sent:
+ * the kernel command line can hold disk UUIDs, network setup or passwords.
+ */
+static gboolean benchmark_environment_is_private(const gchar * key,
+						 gsize length)
+{
+    static const gchar *private_keys[] = { "Kernel Command Line", NULL };
+    gint i;
+
+    for (i = 0; private_keys[i]; i++) {
+	if (strlen(private_keys[i]) == length
+	    && strncmp(key, private_keys[i], length) == 0)
+	    return TRUE;
+    }
+
+    return FALSE;
+}
+
+static gchar *get_benchmark_results()
+{
+    void (*scan_callback) (gboolean rescan);
+
+    GString *result, *benchmarks;
+    gchar *machine, *key, *value;
+    gint i, j, n = 0;
+
+    /* only the entries actually sent are numbered */
+    benchmarks = g_string_new("");
+
+    for (i = G_N_ELEMENTS(entries) - 1; i >= 0; i--) {
+	/* composite scores are derived from the others */
+	if (i == BENCHMARK_COMPOSITE || i == BENCHMARK_COMPOSITE_THREAD)
+	    continue;
 
-    for (; i >= 0; i--) {
 	if ((scan_callback = entries[i].scan_callback)) {
 	    scan_callback(FALSE);
 
-	    result = g_strdup_printf("%s\n"
-				     "[bench%d]\n"
-				     "name=%s\n"
-				     "value=%f\n",
-				     result,
-				     i, entries[i].name, bench_results[i]);
+	    /* do not send results that are not comparable */
+	    if (bench_unreliable[i])
+		continue;
+
+	    g_string_append_printf(benchmarks,
+				   "\n"
+				   "[bench%d]\n"
+				   "name=%s\n"
+				   "value=%f\n",
+				   n++, entries[i].name, bench_results[i]);
+
+	    /* the environment it ran in, as env_ keys */
+	    if (bench_environment[i]) {
+		gchar **lines = g_strsplit(bench_environment[i], "\n", 0);
+
+		for (j = 0; lines[j]; j++) {
+		    if (!(value = strchr(lines[j], '='))
+			|| benchmark_environment_is_private(lines[j],
+							    value - lines[j]))
+			continue;
+
+		    key = g_ascii_strdown(lines[j], value - lines[j]);
+		    g_strdelimit(key, " -", '_');
+		    g_string_append_printf(benchmarks, "env_%s=%s\n", key,
+					   value + 1);
+		    g_free(key);
+		}
+		g_strfreev(lines);
+	    }
 	}
     }
 
+    machine = module_call_method("devices::getProcessorName");
+    result = g_string_new("[param]\n");
+    g_string_append_printf(result, "machine=%s\n" "nbenchmarks=%d\n",
+			   machine, n);
     g_free(machine);
-    g_free(param);
 
-    return result;
+    /* the structured machine description, as machine_keys in lowercase */
+    for (j = MACHINE_CORES; j < MACHINE_N_KEYS; j++) {
+	key = g_ascii_strdown(machine_keys[j], -1);
+	g_strdelimit(key, " ", '_');
+	value = benchmark_get_machine_info(j);
+
+	g_string_append_printf(result, "%s=%s\n", key, value ? value : "");
+
+	g_free(key);
+	g_free(value);
+    }
+
+    g_string_append(result, benchmarks->str);
+    g_string_free(benchmarks, TRUE);
+
+    return g_string_free(result, FALSE);
 }
 
 void hi_module_init(void)
@@ -309,4 +1862,6 @@ void hi_module_init(void)
 
     sync_manager_add_entry(&se[0]);
     sync_manager_add_entry(&se[1]);
+
+    moreinfo = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 }
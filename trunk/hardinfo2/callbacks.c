@@ -100,7 +100,7 @@ void cb_copy_to_clipboard()
     ShellModuleEntry *entry = shell_get_main_shell()->selected;
 
     if (entry) {
-	gchar *data = module_entry_function(entry);
+	Info *info = module_entry_get_info(entry);
 	GtkClipboard *clip =
 	    gtk_clipboard_get(gdk_atom_intern("CLIPBOARD", FALSE));
 	ReportContext *ctx = report_context_text_new(NULL);
@@ -108,12 +108,12 @@ void cb_copy_to_clipboard()
 	ctx->entry = entry;
 
 	report_header(ctx);
-	report_table(ctx, data);
+	report_info(ctx, info);
 	report_footer(ctx);
 
-	gtk_clipboard_set_text(clip, ctx->output, -1);
+	gtk_clipboard_set_text(clip, ctx->output->str, -1);
 
-	g_free(data);
+	info_free(info);
 	report_context_free(ctx);
     }
 }
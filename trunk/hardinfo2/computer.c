@@ -28,6 +28,7 @@
 #include <hardinfo.h>
 #include <iconcache.h>
 #include <shell.h>
+#include <registry.h>
 
 #include <vendor.h>
 
@@ -55,6 +56,19 @@ void scan_display(gboolean reload);
 void scan_network(gboolean reload);
 void scan_users(gboolean reload);
 
+enum {
+    COMPUTER_SUMMARY,
+    COMPUTER_OS,
+    COMPUTER_MODULES,
+    COMPUTER_BOOTS,
+    COMPUTER_LOCALES,
+    COMPUTER_FS,
+    COMPUTER_SHARES,
+    COMPUTER_DISPLAY,
+    COMPUTER_NETWORK,
+    COMPUTER_USERS
+} Entries;
+
 static ModuleEntry entries[] = {
     {"Summary", "summary.png", callback_summary, scan_summary},
     {"Operating System", "os.png", callback_os, scan_os},
@@ -72,6 +86,7 @@ static ModuleEntry entries[] = {
 #include "computer.h"
 
 static GHashTable *moreinfo = NULL;
+static DeviceRegistry *module_registry = NULL;
 static gchar *module_list = NULL;
 static Computer *computer = NULL;
 
@@ -92,9 +107,10 @@ static Computer *computer = NULL;
 
 gchar *hi_more_info(gchar * entry)
 {
-    gchar *info = (gchar *) g_hash_table_lookup(moreinfo, entry);
+    const gchar *info;
 
-    if (info)
+    if ((info = device_registry_get_detail(module_registry, entry)) ||
+	(info = g_hash_table_lookup(moreinfo, entry)))
 	return g_strdup(info);
 
     return g_strdup_printf("[%s]", entry);
@@ -245,33 +261,41 @@ gchar *callback_summary()
     return summary;
 }
 
+static Info *info_os(void)
+{
+    Info *info = info_new();
+    InfoGroup *group;
+
+    group = info_add_group(info, "Version");
+    info_group_add_string(group, "Kernel", computer->os->kernel);
+    info_group_add_string(group, "Compiled", computer->os->compiled_date);
+    info_group_add_string(group, "C Library", computer->os->libc);
+    info_group_add_string(group, "Distribution", computer->os->distro);
+
+    group = info_add_group(info, "Current Session");
+    info_group_add_string(group, "Computer Name", computer->os->hostname);
+    info_group_add_string(group, "User Name", computer->os->username);
+    info_group_add_string(group, "Home Directory", computer->os->homedir);
+    info_group_add_string(group, "Desktop Environment",
+			  computer->os->desktop);
+
+    group = info_add_group(info, "Misc");
+    info_row_set_update_interval(info_group_add_lazy(group, "Uptime"),
+				 10000);
+    info_row_set_update_interval(info_group_add_lazy(group, "Load Average"),
+				 1000);
+
+    return info;
+}
+
 gchar *callback_os()
 {
-    return g_strdup_printf("[$ShellParam$]\n"
-			   "UpdateInterval$Uptime=10000\n"
-			   "UpdateInterval$Load Average=1000\n"
-			   "[Version]\n"
-			   "Kernel=%s\n"
-			   "Compiled=%s\n"
-			   "C Library=%s\n"
-			   "Distribution=%s\n"
-			   "[Current Session]\n"
-			   "Computer Name=%s\n"
-			   "User Name=%s\n"
-			   "#Language=%s\n"
-			   "Home Directory=%s\n"
-			   "Desktop Environment=%s\n"
-			   "[Misc]\n"
-			   "Uptime=...\n"
-			   "Load Average=...",
-			   computer->os->kernel,
-			   computer->os->compiled_date,
-			   computer->os->libc,
-			   computer->os->distro,
-			   computer->os->hostname,
-			   computer->os->username,
-			   computer->os->language,
-			   computer->os->homedir, computer->os->desktop);
+    Info *info = info_os();
+    gchar *text = info_to_key_file(info);
+
+    info_free(info);
+
+    return text;
 }
 
 gchar *callback_modules()
@@ -363,6 +387,16 @@ gchar *get_os_kernel(void)
     return computer->os->kernel;
 }
 
+Info *hi_info(gint entry)
+{
+    switch (entry) {
+    case COMPUTER_OS:
+	return info_os();
+    }
+
+    return NULL;
+}
+
 ShellModuleMethod *hi_exported_methods(void)
 {
     static ShellModuleMethod m[] = {
@@ -400,6 +434,9 @@ void hi_module_init(void)
     computer = g_new0(Computer, 1);
     moreinfo =
 	g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    module_registry = device_registry_new_lazy("MOD",
+				(DeviceFormatFunc) kernel_module_get_detail,
+				(GDestroyNotify) kernel_module_free);
 }
 
 ModuleAbout *hi_module_get_about(void)
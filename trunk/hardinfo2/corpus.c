@@ -0,0 +1,245 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <hardinfo.h>
+#include <corpus.h>
+
+/* from <numaif.h>, which is not always installed */
+#define CORPUS_MPOL_INTERLEAVE	3
+
+static const gchar *kind_names[] = {
+    "benchmark.data",
+    "Text"
+};
+
+static GHashTable *corpora = NULL;
+static Corpus *file_corpus = NULL;
+G_LOCK_DEFINE_STATIC(corpora);
+
+const gchar *corpus_kind_get_name(CorpusKind kind)
+{
+    return kind < CORPUS_N_KINDS ? kind_names[kind] : NULL;
+}
+
+static void corpus_prefault(Corpus * corpus)
+{
+    volatile guchar sink = 0;
+    glong page_size = sysconf(_SC_PAGESIZE);
+    gsize i;
+
+    if (page_size <= 0)
+	page_size = 4096;
+
+    madvise(corpus->map, corpus->map_size, MADV_WILLNEED);
+    for (i = 0; i < corpus->size; i += page_size)
+	sink ^= corpus->data[i];
+}
+
+static gboolean corpus_set_numa_policy(gpointer map, gsize size,
+				       CorpusFlags flags)
+{
+#ifdef __NR_mbind
+    gulong nodes = ~0UL;
+
+    if (flags & CORPUS_NUMA_INTERLEAVE)
+	return syscall(__NR_mbind, map, size, CORPUS_MPOL_INTERLEAVE,
+		       &nodes, 8 * sizeof(nodes), 0) == 0;
+#endif
+
+    return FALSE;
+}
+
+static void generate_text(guchar * data, gsize size)
+{
+    static const gchar *words[] = {
+	"kernel", "module", "device", "memory", "processor", "cache",
+	"thread", "buffer", "socket", "request", "latency", "the", "a",
+	"of", "and", "to", "in", "is", "with", "error", "warning", "info",
+	"0x1f3a", "connection", "timeout", "user", "session", "disk",
+	"read", "write", "queue", "ok", "failed", "retry", "[main]"
+    };
+    guint32 seed = 0x12345678;
+    gsize pos = 0;
+
+    while (pos < size) {
+	const gchar *word;
+	gsize len;
+
+	seed = seed * 1103515245 + 12345;
+	word = words[(seed >> 16) % G_N_ELEMENTS(words)];
+	len = MIN(strlen(word), size - pos);
+
+	memcpy(data + pos, word, len);
+	pos += len;
+	if (pos < size)
+	    data[pos++] = ((seed >> 8) & 0xf) ? ' ' : '\n';
+    }
+}
+
+static Corpus *corpus_map_file(CorpusFlags flags)
+{
+    Corpus *corpus;
+    struct stat st;
+    gchar *path;
+    gpointer map;
+    gint fd;
+
+    path = g_build_filename(params.path_data, "benchmark.data", NULL);
+    fd = open(path, O_RDONLY);
+    g_free(path);
+
+    if (fd < 0)
+	return NULL;
+
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+	close(fd);
+	return NULL;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+	return NULL;
+
+    corpus = g_new0(Corpus, 1);
+    corpus->kind = CORPUS_FILE;
+    corpus->map = map;
+    corpus->map_size = corpus->size = st.st_size;
+    corpus->data = map;
+
+    /* the page cache has already decided where the file lives */
+    corpus->numa_applied = FALSE;
+
+    return corpus;
+}
+
+static Corpus *corpus_generate(CorpusKind kind, gsize size, CorpusFlags flags)
+{
+    Corpus *corpus;
+    gpointer map;
+
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+	       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+	return NULL;
+
+    corpus = g_new0(Corpus, 1);
+    corpus->kind = kind;
+    corpus->map = map;
+    corpus->map_size = corpus->size = size;
+    corpus->data = map;
+
+    /* the policy must be set before the pages are first touched */
+    corpus->numa_applied = corpus_set_numa_policy(map, size, flags);
+
+    switch (kind) {
+    case CORPUS_TEXT:
+	generate_text(map, size);
+	break;
+    default:
+	break;
+    }
+
+    mprotect(map, size, PROT_READ);
+
+    return corpus;
+}
+
+Corpus *corpus_get(CorpusKind kind, gsize size, CorpusFlags flags)
+{
+    Corpus *corpus;
+    gchar *key;
+
+    if (kind >= CORPUS_N_KINDS || (kind != CORPUS_FILE && size == 0))
+	return NULL;
+
+    G_LOCK(corpora);
+
+    if (kind == CORPUS_FILE) {
+	/* mapped on first use and kept for the lifetime of the program;
+	   benchmark_run_isolated() maps it before forking its helpers */
+	if (!file_corpus) {
+	    file_corpus = corpus_map_file(flags);
+	    if (file_corpus)
+		file_corpus->refcount = 1;
+	}
+
+	corpus = file_corpus;
+	if (corpus)
+	    corpus->refcount++;
+
+	G_UNLOCK(corpora);
+
+	if (corpus && (flags & CORPUS_PREFAULT))
+	    corpus_prefault(corpus);
+
+	return corpus;
+    }
+
+    if (!corpora)
+	corpora = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    key = g_strdup_printf("%d:%" G_GSIZE_FORMAT ":%d", kind, size,
+			  flags & CORPUS_NUMA_INTERLEAVE);
+    corpus = g_hash_table_lookup(corpora, key);
+    if (corpus) {
+	corpus->refcount++;
+	g_free(key);
+    } else if ((corpus = corpus_generate(kind, size, flags))) {
+	corpus->refcount = 1;
+	g_hash_table_insert(corpora, key, corpus);
+    } else {
+	g_free(key);
+    }
+
+    G_UNLOCK(corpora);
+
+    if (corpus && (flags & CORPUS_PREFAULT))
+	corpus_prefault(corpus);
+
+    return corpus;
+}
+
+static gboolean corpus_equal(gpointer key, gpointer value, gpointer data)
+{
+    return value == data;
+}
+
+void corpus_release(Corpus * corpus)
+{
+    if (!corpus)
+	return;
+
+    G_LOCK(corpora);
+
+    if (--corpus->refcount == 0) {
+	g_hash_table_foreach_remove(corpora, corpus_equal, corpus);
+	munmap(corpus->map, corpus->map_size);
+	g_free(corpus);
+    }
+
+    G_UNLOCK(corpora);
+}
@@ -0,0 +1,62 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#ifndef __CORPUS_H__
+#define __CORPUS_H__
+
+#include <glib.h>
+
+/*
+ * Input data for the benchmarks. benchmark.data is mapped once and shared,
+ * also with the benchmark helpers forked after it was first asked for;
+ * generated corpora are deterministic, cached by kind and size in the
+ * process that made them, and handed out read-only. Release every corpus
+ * obtained with corpus_get().
+ */
+
+typedef struct _Corpus		Corpus;
+
+typedef enum {
+    CORPUS_FILE,		/* benchmark.data, size is ignored */
+    CORPUS_TEXT,		/* log-like text from a small vocabulary */
+    CORPUS_N_KINDS
+} CorpusKind;
+
+typedef enum {
+    CORPUS_PREFAULT		= 1 << 0,
+    CORPUS_NUMA_INTERLEAVE	= 1 << 1
+} CorpusFlags;
+
+struct _Corpus {
+    CorpusKind		 kind;
+    const guchar	*data;
+    gsize		 size;
+
+    gboolean		 numa_applied;	/* the pages follow the NUMA flag */
+
+    /* private */
+    gpointer		 map;
+    gsize		 map_size;
+    gint		 refcount;
+};
+
+Corpus		*corpus_get(CorpusKind kind, gsize size, CorpusFlags flags);
+void		 corpus_release(Corpus *corpus);
+
+const gchar	*corpus_kind_get_name(CorpusKind kind);
+
+#endif	/* __CORPUS_H__ */
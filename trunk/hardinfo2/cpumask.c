@@ -0,0 +1,113 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <cpumask.h>
+
+#define CPU_MASK_WORD_BITS	(8 * sizeof(gulong))
+
+void cpu_mask_clear(CpuMask * mask)
+{
+    memset(mask->bits, 0, sizeof(mask->bits));
+}
+
+/* processors past CPU_MASK_MAX_CPUS are ignored */
+void cpu_mask_set(CpuMask * mask, gint cpu)
+{
+    if (cpu >= 0 && cpu < CPU_MASK_MAX_CPUS)
+	mask->bits[cpu / CPU_MASK_WORD_BITS] |=
+	    1UL << (cpu % CPU_MASK_WORD_BITS);
+}
+
+gboolean cpu_mask_is_set(const CpuMask * mask, gint cpu)
+{
+    if (cpu < 0 || cpu >= CPU_MASK_MAX_CPUS)
+	return FALSE;
+
+    return (mask->bits[cpu / CPU_MASK_WORD_BITS] &
+	    (1UL << (cpu % CPU_MASK_WORD_BITS))) != 0;
+}
+
+gint cpu_mask_count(const CpuMask * mask)
+{
+    gint cpu, n = 0;
+
+    for (cpu = 0; cpu < CPU_MASK_MAX_CPUS; cpu++) {
+	if (cpu_mask_is_set(mask, cpu))
+	    n++;
+    }
+
+    return n;
+}
+
+/* a list such as "0,4" or "0-3,8"; returns how many processors it has */
+gint cpu_mask_parse(CpuMask * mask, const gchar * list)
+{
+    gchar **ranges;
+    gint i, first, last;
+
+    cpu_mask_clear(mask);
+
+    ranges = g_strsplit(list, ",", 0);
+    for (i = 0; ranges[i]; i++) {
+	switch (sscanf(ranges[i], "%d-%d", &first, &last)) {
+	case 1:
+	    last = first;
+	    break;
+	case 2:
+	    break;
+	default:
+	    continue;
+	}
+
+	for (; first <= last && first < CPU_MASK_MAX_CPUS; first++)
+	    cpu_mask_set(mask, first);
+    }
+    g_strfreev(ranges);
+
+    return cpu_mask_count(mask);
+}
+
+/* the processors the calling thread may run on */
+gboolean cpu_mask_get_affinity(CpuMask * mask)
+{
+    cpu_mask_clear(mask);
+
+#ifdef __NR_sched_getaffinity
+    return syscall(__NR_sched_getaffinity, 0, sizeof(mask->bits),
+		   mask->bits) > 0;
+#else
+    return FALSE;
+#endif
+}
+
+/* moves the calling thread, not the whole process */
+gboolean cpu_mask_set_affinity(const CpuMask * mask)
+{
+#ifdef __NR_sched_setaffinity
+    return syscall(__NR_sched_setaffinity, 0, sizeof(mask->bits),
+		   mask->bits) == 0;
+#else
+    return FALSE;
+#endif
+}
@@ -0,0 +1,48 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef __CPUMASK_H__
+#define __CPUMASK_H__
+
+#include <glib.h>
+
+/*
+ * A set of processors, as the kernel takes it for sched_setaffinity(),
+ * and parsed from the "0-3,8" lists found in sysfs and cgroups.
+ */
+
+#define CPU_MASK_MAX_CPUS	1024
+
+typedef struct _CpuMask	CpuMask;
+
+struct _CpuMask {
+    gulong		 bits[CPU_MASK_MAX_CPUS / (8 * sizeof(gulong))];
+};
+
+void		 cpu_mask_clear(CpuMask *mask);
+void		 cpu_mask_set(CpuMask *mask, gint cpu);
+gboolean	 cpu_mask_is_set(const CpuMask *mask, gint cpu);
+gint		 cpu_mask_count(const CpuMask *mask);
+
+gint		 cpu_mask_parse(CpuMask *mask, const gchar *list);
+
+gboolean	 cpu_mask_get_affinity(CpuMask *mask);
+gboolean	 cpu_mask_set_affinity(const CpuMask *mask);
+
+#endif	/* __CPUMASK_H__ */
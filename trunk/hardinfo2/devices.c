@@ -23,6 +23,9 @@
 #include <hardinfo.h>
 #include <shell.h>
 #include <iconcache.h>
+#include <arena.h>
+#include <registry.h>
+#include <cpumask.h>
 #include <syncmanager.h>
 
 #include <expr.h>
@@ -71,7 +74,14 @@ static ModuleEntry entries[] = {
 };
 
 static GHashTable *moreinfo = NULL;
+static DeviceRegistry *processor_registry = NULL;
+static DeviceRegistry *pci_registry = NULL;
+static DeviceRegistry *usb_registry = NULL;
+static DeviceRegistry *input_registry = NULL;
+static DeviceRegistry *scsi_registry = NULL;
+static DeviceRegistry *ide_registry = NULL;
 static GSList *processors = NULL;
+static GSList *core_classes = NULL;
 static gchar *printer_list = NULL;
 static gchar *pci_list = NULL;
 static gchar *input_list = NULL;
@@ -107,11 +117,29 @@ static gchar *meminfo = NULL, *lginterval = NULL;
     continue;                                 \
   }
 
+/* the same, for a line split with arena_split_pair() */
+#define get_pair_str(field_name,ptr)          \
+  if (g_str_has_prefix(key, field_name)) {    \
+    ptr = g_strdup(value);                    \
+    continue;                                 \
+  }
+#define get_pair_int(field_name,ptr)          \
+  if (g_str_has_prefix(key, field_name)) {    \
+    ptr = atoi(value);                        \
+    continue;                                 \
+  }
+#define get_pair_float(field_name,ptr)        \
+  if (g_str_has_prefix(key, field_name)) {    \
+    ptr = atof(value);                        \
+    continue;                                 \
+  }
+
 #include <vendor.h>
 
 typedef struct _Processor Processor;
 
 #include <arch/this/processor.h>
+#include <arch/this/coreclass.h>
 #include <arch/this/pci.h>
 #include <arch/common/printers.h>
 #include <arch/this/inputdevices.h>
@@ -140,6 +168,15 @@ gchar *get_processor_name(void)
     }
 }
 
+#if defined(ARCH_i386) || defined(ARCH_x86_64)
+gchar *get_processor_flags(void)
+{
+    scan_processors(FALSE);
+
+    return ((Processor *) processors->data)->flags;
+}
+#endif	/* x86 or x86_64 */
+
 gchar *get_storage_devices(void)
 {
     scan_storage(FALSE);
@@ -161,13 +198,22 @@ gchar *get_input_devices(void)
     return input_list;
 }
 
+gchar *get_on_battery(void)
+{
+    return battery_is_discharging() ? "1" : "0";
+}
+
 ShellModuleMethod *hi_exported_methods(void)
 {
     static ShellModuleMethod m[] = {
 	{"getProcessorName", get_processor_name},
+#if defined(ARCH_i386) || defined(ARCH_x86_64)
+	{"getProcessorFlags", get_processor_flags},
+#endif	/* x86 or x86_64 */
 	{"getStorageDevices", get_storage_devices},
 	{"getPrinters", get_printers},
 	{"getInputDevices", get_input_devices},
+	{"isOnBattery", get_on_battery},
 	{NULL}
     };
 
@@ -176,9 +222,19 @@ ShellModuleMethod *hi_exported_methods(void)
 
 gchar *hi_more_info(gchar * entry)
 {
-    gchar *info = (gchar *) g_hash_table_lookup(moreinfo, entry);
+    DeviceRegistry *registries[] = {
+	processor_registry, pci_registry, usb_registry, input_registry,
+	scsi_registry, ide_registry
+    };
+    const gchar *info;
+    gint i;
 
-    if (info)
+    for (i = 0; i < G_N_ELEMENTS(registries); i++) {
+	if ((info = device_registry_get_detail(registries[i], entry)))
+	    return g_strdup(info);
+    }
+
+    if ((info = g_hash_table_lookup(moreinfo, entry)))
 	return g_strdup(info);
 
     return g_strdup("?");
@@ -194,6 +250,24 @@ gchar *hi_get_field(gchar * field)
     return g_strdup(field);
 }
 
+/*
+ * Only the memory page has fields that update; one read of /proc/meminfo
+ * per tick refreshes all of them, instead of showing the last rescan.
+ */
+gchar **hi_get_fields(gchar ** fields)
+{
+    gchar **values;
+    gint i;
+
+    __scan_memory();
+
+    values = g_new0(gchar *, g_strv_length(fields) + 1);
+    for (i = 0; fields[i]; i++)
+	values[i] = hi_get_field(fields[i]);
+
+    return values;
+}
+
 #if defined(ARCH_i386) || defined(ARCH_x86_64)
 void scan_dmi(gboolean reload)
 {
@@ -206,8 +280,12 @@ void scan_dmi(gboolean reload)
 void scan_processors(gboolean reload)
 {
     SCAN_START();
-    if (!processors)
+    if (!processors) {
 	processors = __scan_processors();
+
+	/* on hybrid x86 this moves the thread over every CPU: only once */
+	core_classes = coreclass_scan();
+    }
     SCAN_END();
 }
 
@@ -250,7 +328,9 @@ void scan_storage(gboolean reload)
 {
     SCAN_START();
     g_free(storage_list);
+    g_free(storage_icons);
     storage_list = g_strdup("");
+    storage_icons = g_strdup("");
 
     __scan_ide_devices();
     __scan_scsi_devices();
@@ -273,7 +353,15 @@ void scan_usb(gboolean reload)
 
 gchar *callback_processors()
 {
-    return processor_get_info(processors);
+    gchar *info, *class_info;
+
+    info = processor_get_info(processors);
+    class_info = coreclass_get_info(core_classes);
+    info = h_strconcat(info, class_info, NULL);
+
+    g_free(class_info);
+
+    return info;
 }
 
 #if defined(ARCH_i386) || defined(ARCH_x86_64)
@@ -378,6 +466,15 @@ void hi_module_init(void)
     }
 
     moreinfo = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    pci_registry = device_registry_new_lazy("PCI",
+				(DeviceFormatFunc) pci_device_get_detail,
+				(GDestroyNotify) pci_device_free);
+    usb_registry = device_registry_new_lazy("USB",
+				(DeviceFormatFunc) usb_device_get_detail,
+				(GDestroyNotify) usb_device_free);
+    input_registry = device_registry_new("INP");
+    scsi_registry = device_registry_new("SCSI");
+    ide_registry = device_registry_new("IDE");
     __init_memory_labels();
 }
 
@@ -27,18 +27,32 @@ typedef struct _ModuleAbout		ModuleAbout;
 typedef struct _FileTypes		FileTypes;
 typedef struct _ProgramParameters	ProgramParameters;
 
+typedef enum {
+    H_ESCAPE_NONE,
+    H_ESCAPE_MARKUP,		/* plain text into markup */
+    H_ESCAPE_FROM_MARKUP,	/* text that may be Pango markup into HTML */
+    H_ESCAPE_KEY_FILE_KEY,	/* the key of a "key=value" line */
+    H_ESCAPE_KEY_FILE_VALUE	/* the value of a "key=value" line */
+} HStringEscape;
+
 struct _ProgramParameters {
   gboolean create_report;
   gboolean show_version;
   gboolean gui_running;
   gboolean list_modules;
   gboolean autoload_deps;
+  gboolean benchmark_in_process;
+  gboolean profile_scans;
   
   gint     report_format;
   
   gchar  **use_modules;
   gchar   *path_lib;
   gchar   *path_data;
+  gchar   *benchmark_cpus;
+  gchar   *benchmark_filter;
+  gchar   *benchmark_group;
+  gchar   *benchmark_reference;
 };
 
 struct _FileTypes {
@@ -98,6 +112,8 @@ gchar        *seconds_to_string(unsigned int seconds);
 
 gchar        *h_strdup_cprintf(const gchar *format, gchar *source, ...);
 gchar	     *h_strconcat(gchar *string1, ...);
+void          h_string_append_escaped(GString *string, const gchar *text,
+                                      HStringEscape escape);
 void          h_hash_table_remove_all (GHashTable *hash_table);
 
 
@@ -106,6 +122,9 @@ void	      module_entry_scan_all(ModuleEntry *entries);
 void	      module_entry_reload(ShellModuleEntry *module_entry);
 void	      module_entry_scan(ShellModuleEntry *module_entry);
 gchar	     *module_entry_function(ShellModuleEntry *module_entry);
+Info	     *module_entry_get_info(ShellModuleEntry *module_entry);
+gchar	    **module_entry_get_fields(ShellModuleEntry *module_entry,
+				    gchar **fields);
 const gchar  *module_entry_get_note(ShellModuleEntry *module_entry);
 
 /* BinReloc stuff */
@@ -0,0 +1,442 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <string.h>
+#include <info.h>
+
+Info *info_new(void)
+{
+    Info *info = g_new0(Info, 1);
+
+    info->groups = g_ptr_array_new();
+    info->order_type = -1;
+
+    return info;
+}
+
+static void info_row_free(InfoRow * row)
+{
+    if (row->type == INFO_VALUE_STRING)
+	g_free(row->value.string);
+
+    g_free(row->name);
+    g_free(row->tag);
+    g_free(row->unit);
+    g_free(row->icon);
+    g_free(row);
+}
+
+void info_free(Info * info)
+{
+    guint i, j;
+
+    if (!info)
+	return;
+
+    for (i = 0; i < info->groups->len; i++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, i);
+
+	for (j = 0; j < group->rows->len; j++)
+	    info_row_free(g_ptr_array_index(group->rows, j));
+
+	g_ptr_array_free(group->rows, TRUE);
+	g_free(group->name);
+	g_free(group);
+    }
+
+    g_ptr_array_free(info->groups, TRUE);
+    g_free(info->load_graph_suffix);
+    g_free(info);
+}
+
+InfoGroup *info_add_group(Info * info, const gchar * name)
+{
+    InfoGroup *group = g_new0(InfoGroup, 1);
+
+    group->name = g_strdup(name);
+    group->rows = g_ptr_array_new();
+
+    g_ptr_array_add(info->groups, group);
+
+    return group;
+}
+
+static InfoRow *info_group_add_row(InfoGroup * group, const gchar * name,
+				   InfoValueType type)
+{
+    InfoRow *row = g_new0(InfoRow, 1);
+
+    row->name = g_strdup(name);
+    row->type = type;
+
+    g_ptr_array_add(group->rows, row);
+
+    return row;
+}
+
+InfoRow *info_group_add_string(InfoGroup * group, const gchar * name,
+			       const gchar * value)
+{
+    InfoRow *row = info_group_add_row(group, name, INFO_VALUE_STRING);
+
+    row->value.string = g_strdup(value ? value : "");
+
+    return row;
+}
+
+InfoRow *info_group_add_integer(InfoGroup * group, const gchar * name,
+				gint64 value, const gchar * unit)
+{
+    InfoRow *row = info_group_add_row(group, name, INFO_VALUE_INTEGER);
+
+    row->value.integer = value;
+    row->unit = g_strdup(unit);
+
+    return row;
+}
+
+InfoRow *info_group_add_double(InfoGroup * group, const gchar * name,
+			       gdouble value, const gchar * unit)
+{
+    InfoRow *row = info_group_add_row(group, name, INFO_VALUE_DOUBLE);
+
+    row->value.real = value;
+    row->unit = g_strdup(unit);
+
+    return row;
+}
+
+InfoRow *info_group_add_lazy(InfoGroup * group, const gchar * name)
+{
+    return info_group_add_row(group, name, INFO_VALUE_LAZY);
+}
+
+void info_row_set_tag(InfoRow * row, const gchar * tag)
+{
+    g_free(row->tag);
+    row->tag = g_strdup(tag);
+}
+
+void info_row_set_icon(InfoRow * row, const gchar * icon)
+{
+    g_free(row->icon);
+    row->icon = g_strdup(icon);
+}
+
+void info_row_set_update_interval(InfoRow * row, gint ms)
+{
+    row->update_interval = ms;
+}
+
+/* how UpdateInterval$, Icon$ and hi_get_field() name the row */
+gchar *info_row_get_field(InfoRow * row)
+{
+    if (row->tag)
+	return g_strdup_printf("%s$%s", row->tag, row->name);
+
+    return g_strdup(row->name);
+}
+
+gchar *info_row_get_value(InfoRow * row)
+{
+    gchar *value;
+
+    switch (row->type) {
+    case INFO_VALUE_STRING:
+	return g_strdup(row->value.string);
+    case INFO_VALUE_INTEGER:
+	value = g_strdup_printf("%" G_GINT64_FORMAT, row->value.integer);
+	break;
+    case INFO_VALUE_DOUBLE:
+	value = g_strdup_printf("%.2f", row->value.real);
+	break;
+    default:
+	return g_strdup("...");
+    }
+
+    if (row->unit) {
+	gchar *tmp = g_strconcat(value, " ", row->unit, NULL);
+
+	g_free(value);
+	value = tmp;
+    }
+
+    return value;
+}
+
+InfoRow *info_find_row(Info * info, const gchar * field)
+{
+    guint i, j;
+
+    for (i = 0; i < info->groups->len; i++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, i);
+
+	for (j = 0; j < group->rows->len; j++) {
+	    InfoRow *row = g_ptr_array_index(group->rows, j);
+	    gchar *row_field = info_row_get_field(row);
+	    gboolean found = g_str_equal(row_field, field);
+
+	    g_free(row_field);
+	    if (found)
+		return row;
+	}
+    }
+
+    return NULL;
+}
+
+/* keys and groups are made unique with a "#suffix" that is never shown */
+static gchar *info_strip_suffix(const gchar * name)
+{
+    gchar *tmp = g_strdup(name), *hash;
+
+    if ((hash = strchr(tmp, '#')))
+	*hash = '\0';
+
+    return tmp;
+}
+
+static void info_parse_group(Info * info, GKeyFile * key_file,
+			     const gchar * group_name)
+{
+    InfoGroup *group;
+    gchar **keys, *name;
+    gint i;
+
+    name = info_strip_suffix(group_name);
+    group = info_add_group(info, name);
+    g_free(name);
+
+    keys = g_key_file_get_keys(key_file, group_name, NULL, NULL);
+    for (i = 0; keys && keys[i]; i++) {
+	InfoRow *row;
+	gchar *value, *key;
+
+	value = g_key_file_get_value(key_file, group_name, keys[i], NULL);
+	if (!value)
+	    continue;
+
+	key = info_strip_suffix(keys[i]);
+
+	/* "$tag$Name" rows have more information to show when selected */
+	if (*key == '$') {
+	    gchar **tmp = g_strsplit(key + 1, "$", 2);
+
+	    if (g_str_equal(value, "..."))
+		row = info_group_add_lazy(group, tmp[1] ? tmp[1] : "");
+	    else
+		row = info_group_add_string(group, tmp[1] ? tmp[1] : "",
+					    value);
+	    info_row_set_tag(row, tmp[0]);
+
+	    g_strfreev(tmp);
+	} else if (g_str_equal(value, "...")) {
+	    info_group_add_lazy(group, key);
+	} else {
+	    info_group_add_string(group, key, value);
+	}
+
+	g_free(key);
+	g_free(value);
+    }
+
+    g_strfreev(keys);
+}
+
+static void info_parse_params(Info * info, GKeyFile * key_file,
+			      const gchar * group)
+{
+    gchar **keys;
+    gint i;
+
+    keys = g_key_file_get_keys(key_file, group, NULL, NULL);
+    for (i = 0; keys && keys[i]; i++) {
+	gchar *key = keys[i];
+	InfoRow *row;
+
+	if (g_str_has_prefix(key, "UpdateInterval$")) {
+	    if ((row = info_find_row(info, strchr(key, '$') + 1)))
+		row->update_interval =
+		    g_key_file_get_integer(key_file, group, key, NULL);
+	} else if (g_str_has_prefix(key, "Icon$")) {
+	    if ((row = info_find_row(info, strchr(key, '$') + 1))) {
+		g_free(row->icon);
+		row->icon = g_key_file_get_value(key_file, group, key, NULL);
+	    }
+	} else if (g_str_equal(key, "LoadGraphSuffix")) {
+	    g_free(info->load_graph_suffix);
+	    info->load_graph_suffix =
+		g_key_file_get_value(key_file, group, key, NULL);
+	} else if (g_str_equal(key, "ReloadInterval")) {
+	    info->reload_interval =
+		g_key_file_get_integer(key_file, group, key, NULL);
+	} else if (g_str_equal(key, "RescanInterval")) {
+	    info->rescan_interval =
+		g_key_file_get_integer(key_file, group, key, NULL);
+	} else if (g_str_equal(key, "OrderType")) {
+	    info->order_type =
+		g_key_file_get_integer(key_file, group, key, NULL);
+	} else if (g_str_equal(key, "ViewType")) {
+	    info->view_type =
+		g_key_file_get_integer(key_file, group, key, NULL);
+	} else if (g_str_equal(key, "Zebra")) {
+	    info->zebra = g_key_file_get_boolean(key_file, group, key, NULL);
+	}
+    }
+
+    g_strfreev(keys);
+}
+
+/*
+ * Reads the key file format modules used to return. Parameters may come
+ * before the rows they refer to, so they are applied last.
+ */
+Info *info_from_key_file(const gchar * text)
+{
+    GKeyFile *key_file = g_key_file_new();
+    Info *info = info_new();
+    gchar **groups;
+    gint i;
+
+    if (!text || !g_key_file_load_from_data(key_file, text, strlen(text),
+					    0, NULL)) {
+	g_key_file_free(key_file);
+	return info;
+    }
+
+    groups = g_key_file_get_groups(key_file, NULL);
+
+    for (i = 0; groups[i]; i++) {
+	if (*groups[i] != '$')
+	    info_parse_group(info, key_file, groups[i]);
+    }
+
+    for (i = 0; groups[i]; i++) {
+	if (g_str_equal(groups[i], "$ShellParam$"))
+	    info_parse_params(info, key_file, groups[i]);
+	else if (*groups[i] == '$')
+	    g_warning("Unknown parameter group: ``%s''", groups[i]);
+    }
+
+    g_strfreev(groups);
+    g_key_file_free(key_file);
+
+    return info;
+}
+
+/* the key file keeps only the first of equal names */
+static gchar *info_unique_name(GHashTable * seen, const gchar * name)
+{
+    gint count = GPOINTER_TO_INT(g_hash_table_lookup(seen, name));
+
+    g_hash_table_insert(seen, g_strdup(name), GINT_TO_POINTER(count + 1));
+
+    if (count)
+	return g_strdup_printf("%s#%d", name, count);
+
+    return g_strdup(name);
+}
+
+gchar *info_to_key_file(Info * info)
+{
+    GString *text = g_string_new("");
+    GHashTable *groups_seen;
+    guint i, j;
+
+    groups_seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					NULL);
+
+    for (i = 0; i < info->groups->len; i++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, i);
+	GHashTable *keys_seen;
+	gchar *name;
+
+	name = info_unique_name(groups_seen, group->name);
+	g_string_append_printf(text, "[%s]\n", name);
+	g_free(name);
+
+	keys_seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					  NULL);
+
+	for (j = 0; j < group->rows->len; j++) {
+	    InfoRow *row = g_ptr_array_index(group->rows, j);
+	    gchar *key, *value;
+
+	    if (row->tag) {
+		gchar *tmp = g_strdup_printf("$%s$%s", row->tag, row->name);
+
+		key = info_unique_name(keys_seen, tmp);
+		g_free(tmp);
+	    } else {
+		key = info_unique_name(keys_seen, row->name);
+	    }
+
+	    value = info_row_get_value(row);
+	    g_string_append_printf(text, "%s=%s\n", key, value);
+
+	    g_free(value);
+	    g_free(key);
+	}
+
+	g_hash_table_destroy(keys_seen);
+    }
+
+    g_hash_table_destroy(groups_seen);
+
+    /* after the rows, so readers that apply icons as they go find them */
+    g_string_append(text, "[$ShellParam$]\n");
+
+    if (info->view_type)
+	g_string_append_printf(text, "ViewType=%d\n", info->view_type);
+    if (info->order_type >= 0)
+	g_string_append_printf(text, "OrderType=%d\n", info->order_type);
+    if (info->zebra)
+	g_string_append(text, "Zebra=true\n");
+    if (info->reload_interval)
+	g_string_append_printf(text, "ReloadInterval=%d\n",
+			       info->reload_interval);
+    if (info->rescan_interval)
+	g_string_append_printf(text, "RescanInterval=%d\n",
+			       info->rescan_interval);
+    if (info->load_graph_suffix)
+	g_string_append_printf(text, "LoadGraphSuffix=%s\n",
+			       info->load_graph_suffix);
+
+    for (i = 0; i < info->groups->len; i++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, i);
+
+	for (j = 0; j < group->rows->len; j++) {
+	    InfoRow *row = g_ptr_array_index(group->rows, j);
+	    gchar *field;
+
+	    if (!row->update_interval && !row->icon)
+		continue;
+
+	    field = info_row_get_field(row);
+	    if (row->update_interval)
+		g_string_append_printf(text, "UpdateInterval$%s=%d\n", field,
+				       row->update_interval);
+	    if (row->icon)
+		g_string_append_printf(text, "Icon$%s=%s\n", field,
+				       row->icon);
+	    g_free(field);
+	}
+    }
+
+    return g_string_free(text, FALSE);
+}
@@ -0,0 +1,99 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __INFO_H__
+#define __INFO_H__
+
+#include <glib.h>
+
+/*
+ * What a module entry shows: groups of rows with typed values, plus the
+ * view parameters the shell used to read from [$ShellParam$]. Modules
+ * return one from hi_info(); the key file text they used to return is now
+ * just a serialization of it, still accepted from modules that have not
+ * been converted.
+ */
+
+typedef struct _Info		Info;
+typedef struct _InfoGroup	InfoGroup;
+typedef struct _InfoRow		InfoRow;
+
+typedef enum {
+    INFO_VALUE_STRING,
+    INFO_VALUE_INTEGER,
+    INFO_VALUE_DOUBLE,
+    INFO_VALUE_LAZY		/* "...": asked for with hi_get_field() */
+} InfoValueType;
+
+struct _InfoRow {
+    gchar		*name;
+    gchar		*tag;		/* passed to hi_more_info(), or NULL */
+
+    InfoValueType	 type;
+    union {
+	gchar		*string;
+	gint64		 integer;
+	gdouble		 real;
+    } value;
+    gchar		*unit;		/* appended to numbers, or NULL */
+
+    gchar		*icon;
+    gint		 update_interval;	/* in ms; 0 if never */
+};
+
+struct _InfoGroup {
+    gchar		*name;
+    GPtrArray		*rows;
+};
+
+struct _Info {
+    GPtrArray		*groups;
+
+    gint		 view_type;		/* a ShellViewType */
+    gint		 order_type;		/* a ShellOrderType; -1 if unset */
+    gboolean		 zebra;
+    gint		 reload_interval;	/* in ms; 0 if never */
+    gint		 rescan_interval;
+    gchar		*load_graph_suffix;
+};
+
+Info		*info_new(void);
+void		 info_free(Info *info);
+
+InfoGroup	*info_add_group(Info *info, const gchar *name);
+
+InfoRow		*info_group_add_string(InfoGroup *group, const gchar *name,
+				       const gchar *value);
+InfoRow		*info_group_add_integer(InfoGroup *group, const gchar *name,
+					gint64 value, const gchar *unit);
+InfoRow		*info_group_add_double(InfoGroup *group, const gchar *name,
+				       gdouble value, const gchar *unit);
+InfoRow		*info_group_add_lazy(InfoGroup *group, const gchar *name);
+
+void		 info_row_set_tag(InfoRow *row, const gchar *tag);
+void		 info_row_set_icon(InfoRow *row, const gchar *icon);
+void		 info_row_set_update_interval(InfoRow *row, gint ms);
+
+gchar		*info_row_get_field(InfoRow *row);
+gchar		*info_row_get_value(InfoRow *row);
+InfoRow		*info_find_row(Info *info, const gchar *field);
+
+Info		*info_from_key_file(const gchar *text);
+gchar		*info_to_key_file(Info *info);
+
+#endif	/* __INFO_H__ */
@@ -0,0 +1,738 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <string.h>
+
+#include <hardinfo.h>
+#include <shell.h>
+#include <iconcache.h>
+#include <infomodel.h>
+
+#define ITER_GROUP(iter)	GPOINTER_TO_UINT((iter)->user_data)
+#define ITER_POS(iter)		(GPOINTER_TO_INT((iter)->user_data2) - 1)
+#define ORDER(model, g)		((GArray *) g_ptr_array_index((model)->orders, (g)))
+
+typedef struct {
+    InfoModel *model;
+    InfoGroup *group;
+} InfoModelSort;
+
+static void info_model_tree_model_init(GtkTreeModelIface * iface);
+static void info_model_sortable_init(GtkTreeSortableIface * iface);
+
+G_DEFINE_TYPE_WITH_CODE(InfoModel, info_model, G_TYPE_OBJECT,
+			G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+					      info_model_tree_model_init)
+			G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_SORTABLE,
+					      info_model_sortable_init))
+
+static gboolean str_equal0(const gchar * a, const gchar * b)
+{
+    return a == b || (a && b && g_str_equal(a, b));
+}
+
+static InfoGroup *info_model_group(InfoModel * model, guint g)
+{
+    return g_ptr_array_index(model->info->groups, g);
+}
+
+/* NULL for a position the view still knows but that is already gone */
+static InfoRow *info_model_row(InfoModel * model, guint g, guint pos)
+{
+    GArray *order;
+
+    if (g >= model->orders->len)
+	return NULL;
+
+    order = ORDER(model, g);
+    if (pos >= order->len)
+	return NULL;
+
+    return g_ptr_array_index(info_model_group(model, g)->rows,
+			     g_array_index(order, guint, pos));
+}
+
+static guint info_model_n_top(InfoModel * model)
+{
+    if (model->grouped)
+	return model->n_groups;
+
+    return model->orders->len ? model->n_rows[0] : 0;
+}
+
+/* pos is -1 for the group itself */
+static void info_model_set_iter(InfoModel * model, GtkTreeIter * iter,
+				guint g, gint pos)
+{
+    iter->stamp = model->stamp;
+    iter->user_data = GUINT_TO_POINTER(g);
+    iter->user_data2 = GINT_TO_POINTER(pos + 1);
+    iter->user_data3 = NULL;
+}
+
+/* the rows the shell would skip, as their text cannot be shown */
+static gboolean info_model_row_visible(InfoRow * row)
+{
+    if (!g_utf8_validate(row->name, -1, NULL))
+	return FALSE;
+    if (row->unit && !g_utf8_validate(row->unit, -1, NULL))
+	return FALSE;
+    if (row->type == INFO_VALUE_STRING)
+	return row->value.string
+	    && g_utf8_validate(row->value.string, -1, NULL);
+
+    return TRUE;
+}
+
+static gboolean info_row_equal(InfoRow * a, InfoRow * b)
+{
+    if (!a || !b)
+	return a == b;
+
+    if (a->type != b->type || !str_equal0(a->name, b->name)
+	|| !str_equal0(a->tag, b->tag) || !str_equal0(a->unit, b->unit)
+	|| !str_equal0(a->icon, b->icon))
+	return FALSE;
+
+    switch (a->type) {
+    case INFO_VALUE_STRING:
+	return str_equal0(a->value.string, b->value.string);
+    case INFO_VALUE_INTEGER:
+	return a->value.integer == b->value.integer;
+    case INFO_VALUE_DOUBLE:
+	return a->value.real == b->value.real;
+    default:
+	return TRUE;
+    }
+}
+
+/* by name, or by value: numbers first and by magnitude, then strings */
+static gint info_model_compare(gconstpointer a, gconstpointer b,
+			       gpointer data)
+{
+    InfoModelSort *sort = (InfoModelSort *) data;
+    guint ia = *(const guint *) a, ib = *(const guint *) b;
+    InfoRow *ra = g_ptr_array_index(sort->group->rows, ia);
+    InfoRow *rb = g_ptr_array_index(sort->group->rows, ib);
+    gint column = sort->model->sort_column, result = 0;
+
+    if (column == INFO_TREE_COL_NAME) {
+	result = g_utf8_collate(ra->name, rb->name);
+    } else if (column == INFO_TREE_COL_VALUE) {
+	gboolean na = ra->type == INFO_VALUE_INTEGER
+	    || ra->type == INFO_VALUE_DOUBLE;
+	gboolean nb = rb->type == INFO_VALUE_INTEGER
+	    || rb->type == INFO_VALUE_DOUBLE;
+
+	if (na && nb) {
+	    gdouble da = ra->type == INFO_VALUE_INTEGER ?
+		(gdouble) ra->value.integer : ra->value.real;
+	    gdouble db = rb->type == INFO_VALUE_INTEGER ?
+		(gdouble) rb->value.integer : rb->value.real;
+
+	    result = da < db ? -1 : da > db;
+	} else if (na != nb) {
+	    result = na ? -1 : 1;
+	} else {
+	    result = g_utf8_collate(ra->value.string ? ra->value.string : "",
+				    rb->value.string ? rb->value.string : "");
+	}
+    }
+
+    /* ties keep the module's order */
+    if (result == 0)
+	result = ia < ib ? -1 : ia > ib;
+
+    if (column >= 0 && sort->model->sort_order == GTK_SORT_DESCENDING)
+	result = -result;
+
+    return result;
+}
+
+static void info_model_sort(InfoModel * model, InfoGroup * group,
+			    GArray * order)
+{
+    InfoModelSort sort = { model, group };
+
+    g_qsort_with_data(order->data, order->len, sizeof(guint),
+		      info_model_compare, &sort);
+}
+
+static GPtrArray *info_model_build_orders(InfoModel * model, Info * info)
+{
+    GPtrArray *orders = g_ptr_array_new();
+    guint g, i;
+
+    for (g = 0; g < info->groups->len; g++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, g);
+	GArray *order = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+					  group->rows->len);
+
+	for (i = 0; i < group->rows->len; i++) {
+	    if (info_model_row_visible(g_ptr_array_index(group->rows, i)))
+		g_array_append_val(order, i);
+	}
+
+	if (model->sort_column >= 0)
+	    info_model_sort(model, group, order);
+
+	g_ptr_array_add(orders, order);
+    }
+
+    return orders;
+}
+
+static void info_model_free_orders(GPtrArray * orders)
+{
+    guint g;
+
+    for (g = 0; g < orders->len; g++)
+	g_array_free(g_ptr_array_index(orders, g), TRUE);
+
+    g_ptr_array_free(orders, TRUE);
+}
+
+static GtkTreeModelFlags info_model_get_flags(GtkTreeModel * tree_model)
+{
+    return 0;
+}
+
+static gint info_model_get_n_columns(GtkTreeModel * tree_model)
+{
+    return INFO_TREE_NCOL;
+}
+
+static GType info_model_get_column_type(GtkTreeModel * tree_model,
+					gint index)
+{
+    switch (index) {
+    case INFO_TREE_COL_NAME:
+    case INFO_TREE_COL_VALUE:
+    case INFO_TREE_COL_DATA:
+	return G_TYPE_STRING;
+    case INFO_TREE_COL_PBUF:
+	return GDK_TYPE_PIXBUF;
+    case INFO_TREE_COL_PROGRESS:
+	return G_TYPE_FLOAT;
+    default:
+	return G_TYPE_INVALID;
+    }
+}
+
+static gboolean info_model_get_iter(GtkTreeModel * tree_model,
+				    GtkTreeIter * iter, GtkTreePath * path)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+    gint depth = gtk_tree_path_get_depth(path);
+    gint *indices = gtk_tree_path_get_indices(path);
+
+    if (depth < 1 || (guint) indices[0] >= info_model_n_top(model))
+	return FALSE;
+
+    if (!model->grouped) {
+	if (depth != 1)
+	    return FALSE;
+
+	info_model_set_iter(model, iter, 0, indices[0]);
+	return TRUE;
+    }
+
+    if (depth == 1) {
+	info_model_set_iter(model, iter, indices[0], -1);
+	return TRUE;
+    }
+
+    if (depth == 2 && (guint) indices[1] < model->n_rows[indices[0]]) {
+	info_model_set_iter(model, iter, indices[0], indices[1]);
+	return TRUE;
+    }
+
+    return FALSE;
+}
+
+static GtkTreePath *info_model_get_path(GtkTreeModel * tree_model,
+					GtkTreeIter * iter)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+    GtkTreePath *path;
+
+    g_return_val_if_fail(iter->stamp == model->stamp, NULL);
+
+    path = gtk_tree_path_new();
+    if (model->grouped)
+	gtk_tree_path_append_index(path, ITER_GROUP(iter));
+    if (ITER_POS(iter) >= 0)
+	gtk_tree_path_append_index(path, ITER_POS(iter));
+
+    return path;
+}
+
+static void info_model_get_value(GtkTreeModel * tree_model,
+				 GtkTreeIter * iter, gint column,
+				 GValue * value)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+    InfoRow *row;
+
+    g_value_init(value, info_model_get_column_type(tree_model, column));
+    g_return_if_fail(iter->stamp == model->stamp);
+
+    if (ITER_POS(iter) < 0) {
+	if (column == INFO_TREE_COL_NAME
+	    && ITER_GROUP(iter) < model->info->groups->len)
+	    g_value_set_string(value,
+			       info_model_group(model,
+						ITER_GROUP(iter))->name);
+	return;
+    }
+
+    if (!(row = info_model_row(model, ITER_GROUP(iter), ITER_POS(iter))))
+	return;
+
+    switch (column) {
+    case INFO_TREE_COL_NAME:
+	g_value_set_string(value, row->name);
+	break;
+    case INFO_TREE_COL_VALUE:
+	g_value_take_string(value, info_row_get_value(row));
+	break;
+    case INFO_TREE_COL_DATA:
+	g_value_set_string(value, row->tag);
+	break;
+    case INFO_TREE_COL_PBUF:
+	if (row->icon)
+	    g_value_take_object(value,
+				icon_cache_get_pixbuf_at_size(row->icon, 22,
+							      22));
+	break;
+    }
+}
+
+static gboolean info_model_iter_next(GtkTreeModel * tree_model,
+				     GtkTreeIter * iter)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+    guint g = ITER_GROUP(iter);
+    gint pos = ITER_POS(iter);
+
+    if (iter->stamp != model->stamp)
+	return FALSE;
+
+    if (pos < 0) {
+	if (g + 1 >= model->n_groups)
+	    return FALSE;
+
+	info_model_set_iter(model, iter, g + 1, -1);
+	return TRUE;
+    }
+
+    if ((guint) pos + 1 >= model->n_rows[g])
+	return FALSE;
+
+    info_model_set_iter(model, iter, g, pos + 1);
+    return TRUE;
+}
+
+static gboolean info_model_iter_nth_child(GtkTreeModel * tree_model,
+					  GtkTreeIter * iter,
+					  GtkTreeIter * parent, gint n)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+
+    if (n < 0)
+	return FALSE;
+
+    if (!parent) {
+	if ((guint) n >= info_model_n_top(model))
+	    return FALSE;
+
+	if (model->grouped)
+	    info_model_set_iter(model, iter, n, -1);
+	else
+	    info_model_set_iter(model, iter, 0, n);
+	return TRUE;
+    }
+
+    if (!model->grouped || ITER_POS(parent) >= 0
+	|| (guint) n >= model->n_rows[ITER_GROUP(parent)])
+	return FALSE;
+
+    info_model_set_iter(model, iter, ITER_GROUP(parent), n);
+    return TRUE;
+}
+
+static gboolean info_model_iter_children(GtkTreeModel * tree_model,
+					 GtkTreeIter * iter,
+					 GtkTreeIter * parent)
+{
+    return info_model_iter_nth_child(tree_model, iter, parent, 0);
+}
+
+static gboolean info_model_iter_has_child(GtkTreeModel * tree_model,
+					  GtkTreeIter * iter)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+
+    return model->grouped && ITER_POS(iter) < 0
+	&& model->n_rows[ITER_GROUP(iter)] > 0;
+}
+
+static gint info_model_iter_n_children(GtkTreeModel * tree_model,
+				       GtkTreeIter * iter)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+
+    if (!iter)
+	return info_model_n_top(model);
+
+    if (model->grouped && ITER_POS(iter) < 0)
+	return model->n_rows[ITER_GROUP(iter)];
+
+    return 0;
+}
+
+static gboolean info_model_iter_parent(GtkTreeModel * tree_model,
+				       GtkTreeIter * iter,
+				       GtkTreeIter * child)
+{
+    InfoModel *model = INFO_MODEL(tree_model);
+
+    if (!model->grouped || ITER_POS(child) < 0)
+	return FALSE;
+
+    info_model_set_iter(model, iter, ITER_GROUP(child), -1);
+    return TRUE;
+}
+
+static void info_model_tree_model_init(GtkTreeModelIface * iface)
+{
+    iface->get_flags = info_model_get_flags;
+    iface->get_n_columns = info_model_get_n_columns;
+    iface->get_column_type = info_model_get_column_type;
+    iface->get_iter = info_model_get_iter;
+    iface->get_path = info_model_get_path;
+    iface->get_value = info_model_get_value;
+    iface->iter_next = info_model_iter_next;
+    iface->iter_children = info_model_iter_children;
+    iface->iter_has_child = info_model_iter_has_child;
+    iface->iter_n_children = info_model_iter_n_children;
+    iface->iter_nth_child = info_model_iter_nth_child;
+    iface->iter_parent = info_model_iter_parent;
+}
+
+static gboolean info_model_get_sort_column_id(GtkTreeSortable * sortable,
+					      gint * sort_column_id,
+					      GtkSortType * order)
+{
+    InfoModel *model = INFO_MODEL(sortable);
+
+    if (sort_column_id)
+	*sort_column_id = model->sort_column;
+    if (order)
+	*order = model->sort_order;
+
+    return model->sort_column >= 0;
+}
+
+/* only the permutations change; the view is told how rows moved */
+static void info_model_set_sort_column_id(GtkTreeSortable * sortable,
+					  gint sort_column_id,
+					  GtkSortType order)
+{
+    InfoModel *model = INFO_MODEL(sortable);
+    GtkTreeIter iter;
+    GtkTreePath *path;
+    guint g, i, *positions;
+    gint *new_order;
+
+    if (model->sort_column == sort_column_id && model->sort_order == order)
+	return;
+
+    model->sort_column = sort_column_id;
+    model->sort_order = order;
+
+    for (g = 0; g < model->orders->len; g++) {
+	InfoGroup *group = info_model_group(model, g);
+	GArray *rows = ORDER(model, g);
+
+	if (rows->len < 2)
+	    continue;
+
+	positions = g_new(guint, group->rows->len);
+	for (i = 0; i < rows->len; i++)
+	    positions[g_array_index(rows, guint, i)] = i;
+
+	info_model_sort(model, group, rows);
+
+	new_order = g_new(gint, rows->len);
+	for (i = 0; i < rows->len; i++)
+	    new_order[i] = positions[g_array_index(rows, guint, i)];
+
+	if (model->grouped) {
+	    info_model_set_iter(model, &iter, g, -1);
+	    path = info_model_get_path(GTK_TREE_MODEL(model), &iter);
+	    gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, &iter,
+					  new_order);
+	} else {
+	    path = gtk_tree_path_new();
+	    gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, NULL,
+					  new_order);
+	}
+
+	gtk_tree_path_free(path);
+	g_free(new_order);
+	g_free(positions);
+    }
+
+    gtk_tree_sortable_sort_column_changed(sortable);
+}
+
+static void info_model_set_sort_func(GtkTreeSortable * sortable,
+				     gint sort_column_id,
+				     GtkTreeIterCompareFunc func,
+				     gpointer data, GtkDestroyNotify destroy)
+{
+    g_warning("InfoModel only sorts by name or value");
+}
+
+static void info_model_set_default_sort_func(GtkTreeSortable * sortable,
+					     GtkTreeIterCompareFunc func,
+					     gpointer data,
+					     GtkDestroyNotify destroy)
+{
+    g_warning("InfoModel only sorts by name or value");
+}
+
+static gboolean info_model_has_default_sort_func(GtkTreeSortable * sortable)
+{
+    return FALSE;
+}
+
+static void info_model_sortable_init(GtkTreeSortableIface * iface)
+{
+    iface->get_sort_column_id = info_model_get_sort_column_id;
+    iface->set_sort_column_id = info_model_set_sort_column_id;
+    iface->set_sort_func = info_model_set_sort_func;
+    iface->set_default_sort_func = info_model_set_default_sort_func;
+    iface->has_default_sort_func = info_model_has_default_sort_func;
+}
+
+static void info_model_init(InfoModel * model)
+{
+    model->stamp = g_random_int();
+    model->sort_column = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+    model->sort_order = GTK_SORT_ASCENDING;
+}
+
+static void info_model_finalize(GObject * object)
+{
+    InfoModel *model = INFO_MODEL(object);
+
+    info_free(model->info);
+    if (model->orders)
+	info_model_free_orders(model->orders);
+    g_free(model->n_rows);
+
+    G_OBJECT_CLASS(info_model_parent_class)->finalize(object);
+}
+
+static void info_model_class_init(InfoModelClass * klass)
+{
+    G_OBJECT_CLASS(klass)->finalize = info_model_finalize;
+}
+
+static void info_model_install(InfoModel * model, Info * info)
+{
+    guint g;
+
+    model->stamp++;
+    model->info = info;
+    model->grouped = info->groups->len > 1;
+    model->orders = info_model_build_orders(model, info);
+
+    g_free(model->n_rows);
+    model->n_rows = g_new0(guint, info->groups->len + 1);
+    for (g = 0; g < info->groups->len; g++)
+	model->n_rows[g] = ORDER(model, g)->len;
+    model->n_groups = info->groups->len;
+}
+
+/* takes the Info, which is freed with the model */
+InfoModel *info_model_new(Info * info)
+{
+    InfoModel *model = g_object_new(INFO_TYPE_MODEL, NULL);
+
+    info_model_install(model, info);
+
+    return model;
+}
+
+static gboolean info_model_same_groups(Info * a, Info * b)
+{
+    guint g;
+
+    if (a->groups->len != b->groups->len)
+	return FALSE;
+
+    for (g = 0; g < a->groups->len; g++) {
+	InfoGroup *ga = g_ptr_array_index(a->groups, g);
+	InfoGroup *gb = g_ptr_array_index(b->groups, g);
+
+	if (!str_equal0(ga->name, gb->name))
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* the model's view of the tree shrinks to nothing, one top row at a time */
+static void info_model_remove_all(InfoModel * model)
+{
+    GtkTreePath *path;
+    guint top;
+
+    for (top = info_model_n_top(model); top > 0; top--) {
+	if (model->grouped)
+	    model->n_groups = top - 1;
+	else
+	    model->n_rows[0] = top - 1;
+
+	path = gtk_tree_path_new_from_indices(top - 1, -1);
+	gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+	gtk_tree_path_free(path);
+    }
+}
+
+static void info_model_insert_all(InfoModel * model)
+{
+    GtkTreeIter iter;
+    GtkTreePath *path;
+    guint pos, top;
+
+    top = info_model_n_top(model);
+
+    /* grouped rows come in with their group */
+    if (model->grouped)
+	model->n_groups = 0;
+    else if (model->orders->len)
+	model->n_rows[0] = 0;
+
+    for (pos = 0; pos < top; pos++) {
+	if (model->grouped)
+	    model->n_groups = pos + 1;
+	else
+	    model->n_rows[0] = pos + 1;
+
+	path = gtk_tree_path_new_from_indices(pos, -1);
+	gtk_tree_model_get_iter(GTK_TREE_MODEL(model), &iter, path);
+	gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+	if (model->grouped && model->n_rows[pos])
+	    gtk_tree_model_row_has_child_toggled(GTK_TREE_MODEL(model), path,
+						 &iter);
+	gtk_tree_path_free(path);
+    }
+}
+
+static void info_model_update_group(InfoModel * model, guint g,
+				    InfoGroup * old_group, GArray * old_order)
+{
+    GtkTreeModel *tree_model = GTK_TREE_MODEL(model);
+    GtkTreeIter iter, parent;
+    GtkTreePath *path;
+    guint shown = model->n_rows[g], len = ORDER(model, g)->len, pos;
+
+    info_model_set_iter(model, &parent, g, -1);
+
+    /* rows that went away, from the end */
+    while (model->n_rows[g] > len) {
+	pos = --model->n_rows[g];
+
+	info_model_set_iter(model, &iter, g, pos);
+	path = info_model_get_path(tree_model, &iter);
+	gtk_tree_model_row_deleted(tree_model, path);
+	gtk_tree_path_free(path);
+    }
+
+    for (pos = 0; pos < model->n_rows[g]; pos++) {
+	InfoRow *old_row =
+	    g_ptr_array_index(old_group->rows,
+			      g_array_index(old_order, guint, pos));
+
+	if (info_row_equal(old_row, info_model_row(model, g, pos)))
+	    continue;
+
+	info_model_set_iter(model, &iter, g, pos);
+	path = info_model_get_path(tree_model, &iter);
+	gtk_tree_model_row_changed(tree_model, path, &iter);
+	gtk_tree_path_free(path);
+    }
+
+    while (model->n_rows[g] < len) {
+	pos = model->n_rows[g]++;
+
+	info_model_set_iter(model, &iter, g, pos);
+	path = info_model_get_path(tree_model, &iter);
+	gtk_tree_model_row_inserted(tree_model, path, &iter);
+	gtk_tree_path_free(path);
+    }
+
+    if (model->grouped && !shown != !len) {
+	path = info_model_get_path(tree_model, &parent);
+	gtk_tree_model_row_has_child_toggled(tree_model, path, &parent);
+	gtk_tree_path_free(path);
+    }
+}
+
+/*
+ * Replaces the rows with a new result, taking the Info. With the same
+ * groups, rows are compared position by position and the view only hears
+ * of those that changed, came or went, so it keeps its selection, scroll
+ * and expanded groups. Otherwise everything is replaced, and TRUE is
+ * returned.
+ */
+gboolean info_model_set_info(InfoModel * model, Info * info)
+{
+    Info *old_info = model->info;
+    GPtrArray *old_orders = model->orders;
+    guint g;
+
+    if (!info_model_same_groups(old_info, info)) {
+	info_model_remove_all(model);
+	info_model_install(model, info);
+	info_model_insert_all(model);
+
+	info_free(old_info);
+	info_model_free_orders(old_orders);
+
+	return TRUE;
+    }
+
+    model->stamp++;
+    model->info = info;
+    model->orders = info_model_build_orders(model, info);
+
+    for (g = 0; g < info->groups->len; g++)
+	info_model_update_group(model, g,
+				g_ptr_array_index(old_info->groups, g),
+				g_ptr_array_index(old_orders, g));
+
+    info_free(old_info);
+    info_model_free_orders(old_orders);
+
+    return FALSE;
+}
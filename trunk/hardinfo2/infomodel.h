@@ -0,0 +1,68 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __INFOMODEL_H__
+#define __INFOMODEL_H__
+
+#include <gtk/gtk.h>
+#include <info.h>
+
+/*
+ * A GtkTreeModel reading straight from an Info, for the lists that are too
+ * long to copy into a GtkTreeStore (kernel modules, users from a directory
+ * service). Nothing is stored per row: names, values and icons are produced
+ * when the view asks for them. Rows that cannot be shown are filtered out
+ * and sorting is done through a permutation of row indices, per group.
+ *
+ * Iters are positions, so they do not persist across changes.
+ */
+
+#define INFO_TYPE_MODEL		(info_model_get_type())
+#define INFO_MODEL(obj)		(G_TYPE_CHECK_INSTANCE_CAST((obj), \
+				 INFO_TYPE_MODEL, InfoModel))
+#define INFO_IS_MODEL(obj)	(G_TYPE_CHECK_INSTANCE_TYPE((obj), \
+				 INFO_TYPE_MODEL))
+
+typedef struct _InfoModel	InfoModel;
+typedef struct _InfoModelClass	InfoModelClass;
+
+struct _InfoModel {
+    GObject		 parent;
+
+    gint		 stamp;
+    Info		*info;
+    gboolean		 grouped;	/* more than one group: two levels */
+
+    GPtrArray		*orders;	/* per group, a GArray of row indices */
+    guint		 n_groups;	/* groups the view knows about */
+    guint		*n_rows;	/* rows of each group the view knows */
+
+    gint		 sort_column;
+    GtkSortType		 sort_order;
+};
+
+struct _InfoModelClass {
+    GObjectClass	 parent_class;
+};
+
+GType		 info_model_get_type(void);
+
+InfoModel	*info_model_new(Info *info);
+gboolean	 info_model_set_info(InfoModel *model, Info *info);
+
+#endif	/* __INFOMODEL_H__ */
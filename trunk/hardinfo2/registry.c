@@ -0,0 +1,223 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <string.h>
+
+#include <registry.h>
+
+struct _DeviceRegistry {
+    gchar *category;
+    gsize category_len;
+
+    GHashTable *records;	/* id -> DeviceRecord */
+    guint scan;
+
+    DeviceFormatFunc format;
+    GDestroyNotify destroy;
+};
+
+static void device_record_clear(DeviceRecord * record)
+{
+    if (record->data && record->registry->destroy)
+	record->registry->destroy(record->data);
+
+    g_free(record->detail);
+
+    record->detail = NULL;
+    record->data = NULL;
+}
+
+static void device_record_free(DeviceRecord * record)
+{
+    device_record_clear(record);
+
+    g_free(record->id);
+    g_free(record->tag);
+    g_free(record);
+}
+
+DeviceRegistry *device_registry_new(const gchar * category)
+{
+    DeviceRegistry *registry = g_new0(DeviceRegistry, 1);
+
+    registry->category = g_strdup(category);
+    registry->category_len = strlen(category);
+    registry->records = g_hash_table_new_full(g_str_hash, g_str_equal,
+					      NULL,
+					      (GDestroyNotify)
+					      device_record_free);
+
+    return registry;
+}
+
+/* destroy, if given, frees the data handed to device_registry_set_data() */
+DeviceRegistry *device_registry_new_lazy(const gchar * category,
+					 DeviceFormatFunc format,
+					 GDestroyNotify destroy)
+{
+    DeviceRegistry *registry = device_registry_new(category);
+
+    registry->format = format;
+    registry->destroy = destroy;
+
+    return registry;
+}
+
+void device_registry_free(DeviceRegistry * registry)
+{
+    if (!registry)
+	return;
+
+    g_hash_table_destroy(registry->records);
+    g_free(registry->category);
+    g_free(registry);
+}
+
+void device_registry_begin_scan(DeviceRegistry * registry)
+{
+    registry->scan++;
+}
+
+static DeviceRecord *device_registry_get_record(DeviceRegistry * registry,
+						const gchar * id,
+						gboolean * created)
+{
+    DeviceRecord *record;
+
+    if ((record = g_hash_table_lookup(registry->records, id))) {
+	*created = FALSE;
+    } else {
+	record = g_new0(DeviceRecord, 1);
+	record->id = g_strdup(id);
+	record->tag = g_strconcat(registry->category, id, NULL);
+	record->registry = registry;
+
+	g_hash_table_insert(registry->records, record->id, record);
+	*created = TRUE;
+    }
+
+    record->seen = registry->scan;
+
+    return record;
+}
+
+/* takes over detail; the record keeps its id and tag across scans */
+DeviceRecord *device_registry_set(DeviceRegistry * registry,
+				  const gchar * id, gchar * detail)
+{
+    DeviceRecord *record;
+    gboolean created;
+
+    record = device_registry_get_record(registry, id, &created);
+    record->changed = created || !record->detail || !detail ||
+	strcmp(record->detail, detail) != 0;
+
+    if (record->detail != detail) {
+	device_record_clear(record);
+	record->detail = detail;
+    }
+
+    return record;
+}
+
+/*
+ * Takes over data. A detail already formatted from the previous data is
+ * compared with the one the new data gives: the cached text is kept when
+ * they are the same, and replaced otherwise. Details nobody asked for yet
+ * are not formatted here.
+ */
+DeviceRecord *device_registry_set_data(DeviceRegistry * registry,
+				       const gchar * id, gpointer data)
+{
+    DeviceRecord *record;
+    gchar *detail = NULL;
+    gboolean created;
+
+    record = device_registry_get_record(registry, id, &created);
+    if (record->data == data) {
+	record->changed = created;
+	return record;
+    }
+
+    record->changed = TRUE;
+    if (record->detail && registry->format) {
+	detail = registry->format(data);
+
+	if (strcmp(record->detail, detail) == 0) {
+	    g_free(detail);
+	    detail = record->detail;
+	    record->detail = NULL;
+	    record->changed = FALSE;
+	}
+    }
+
+    device_record_clear(record);
+    record->data = data;
+    record->detail = detail;
+
+    return record;
+}
+
+static gboolean device_record_is_stale(gpointer key, gpointer value,
+				       gpointer data)
+{
+    return ((DeviceRecord *) value)->seen != GPOINTER_TO_UINT(data);
+}
+
+/* drops the devices this scan did not find; returns how many */
+guint device_registry_end_scan(DeviceRegistry * registry)
+{
+    return g_hash_table_foreach_remove(registry->records,
+				       device_record_is_stale,
+				       GUINT_TO_POINTER(registry->scan));
+}
+
+DeviceRecord *device_registry_lookup(DeviceRegistry * registry,
+				     const gchar * id)
+{
+    return g_hash_table_lookup(registry->records, id);
+}
+
+/* whether the current scan has already set this id */
+gboolean device_registry_seen(DeviceRegistry * registry, const gchar * id)
+{
+    DeviceRecord *record = g_hash_table_lookup(registry->records, id);
+
+    return record && record->seen == registry->scan;
+}
+
+/* the detail for a tag of this category, or NULL */
+const gchar *device_registry_get_detail(DeviceRegistry * registry,
+					const gchar * tag)
+{
+    DeviceRecord *record;
+
+    if (!registry || strncmp(tag, registry->category,
+			     registry->category_len) != 0)
+	return NULL;
+
+    record = g_hash_table_lookup(registry->records,
+				 tag + registry->category_len);
+    if (!record)
+	return NULL;
+
+    if (!record->detail && record->data && registry->format)
+	record->detail = registry->format(record->data);
+
+    return record->detail;
+}
@@ -0,0 +1,76 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __REGISTRY_H__
+#define __REGISTRY_H__
+
+#include <glib.h>
+
+/*
+ * The devices of one category (PCI, USB, ...), keyed by an id that stays
+ * the same across rescans: a bus address, a sysfs name. A rescan marks
+ * what it finds with device_registry_set(); device_registry_end_scan()
+ * then drops whatever was not seen, touching only this category.
+ *
+ * Records are tagged with the category followed by the id; that is the
+ * tag a module hands to the shell, and gets back in hi_more_info().
+ *
+ * A registry made with device_registry_new_lazy() can also be handed the
+ * raw facts about a device instead of its text: the text is formatted the
+ * first time it is asked for, and kept while rescans bring facts that
+ * format to the same text.
+ */
+
+typedef struct _DeviceRegistry	DeviceRegistry;
+typedef struct _DeviceRecord	DeviceRecord;
+
+typedef gchar *(*DeviceFormatFunc) (gpointer data);
+
+struct _DeviceRecord {
+    gchar		*id;
+    gchar		*tag;
+    gchar		*detail;	/* key file text for hi_more_info() */
+    gpointer		 data;		/* what detail is formatted from */
+
+    guint		 seen;		/* scan that last set it */
+    gboolean		 changed;	/* new, or its detail differs */
+
+    DeviceRegistry	*registry;
+};
+
+DeviceRegistry	*device_registry_new(const gchar *category);
+DeviceRegistry	*device_registry_new_lazy(const gchar *category,
+					  DeviceFormatFunc format,
+					  GDestroyNotify destroy);
+void		 device_registry_free(DeviceRegistry *registry);
+
+void		 device_registry_begin_scan(DeviceRegistry *registry);
+DeviceRecord	*device_registry_set(DeviceRegistry *registry,
+				     const gchar *id, gchar *detail);
+DeviceRecord	*device_registry_set_data(DeviceRegistry *registry,
+					  const gchar *id, gpointer data);
+guint		 device_registry_end_scan(DeviceRegistry *registry);
+
+DeviceRecord	*device_registry_lookup(DeviceRegistry *registry,
+					const gchar *id);
+gboolean	 device_registry_seen(DeviceRegistry *registry,
+				      const gchar *id);
+const gchar	*device_registry_get_detail(DeviceRegistry *registry,
+					    const gchar *tag);
+
+#endif	/* __REGISTRY_H__ */
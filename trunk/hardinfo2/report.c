@@ -64,7 +64,7 @@ void report_key_value(ReportContext * ctx, gchar * key, gchar * value)
     ctx->keyvalue(ctx, key, value);
 }
 
-void report_context_configure(ReportContext * ctx, GKeyFile * keyfile)
+void report_context_configure(ReportContext * ctx, Info * info)
 {
     /* FIXME: sometime in the future we'll save images in the report. this
        flag will be set if we should support that.
@@ -72,94 +72,58 @@ void report_context_configure(ReportContext * ctx, GKeyFile * keyfile)
        so i don't forget how to encode the images inside the html files:
        http://en.wikipedia.org/wiki/Data:_URI_scheme */
 
-    ctx->is_image_enabled = (g_key_file_get_boolean(keyfile,
-						    "$ShellParam$",
-						    "ViewType",
-						    NULL) ==
-			     SHELL_VIEW_PROGRESS);
+    ctx->is_image_enabled = info->view_type >= SHELL_VIEW_PROGRESS;
 }
 
-void report_table(ReportContext * ctx, gchar * text)
+void report_info(ReportContext * ctx, Info * info)
 {
-    GKeyFile *key_file = g_key_file_new();
-    gchar **groups;
-    gint i;
-
-    g_key_file_load_from_data(key_file, text, strlen(text), 0, NULL);
-    groups = g_key_file_get_groups(key_file, NULL);
-
-    for (i = 0; groups[i]; i++) {
-	gchar *group, *tmpgroup;
-	gchar **keys;
-	gint j;
-
-	if (groups[i][0] == '$') {
-	    report_context_configure(ctx, key_file);
-	    continue;
-	}
+    guint i, j;
 
-	group = groups[i];
+    report_context_configure(ctx, info);
 
-	tmpgroup = g_strdup(group);
-	strend(group, '#');
+    for (i = 0; i < info->groups->len; i++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, i);
 
-	report_subsubtitle(ctx, group);
+	report_subsubtitle(ctx, group->name);
 
-#if 0
-	if (ctx->is_image_enabled) {
-	    report_embed_image(ctx, key_file, group);
-	} else {
-#endif
-	    keys = g_key_file_get_keys(key_file, tmpgroup, NULL, NULL);
-	    for (j = 0; keys[j]; j++) {
-		gchar *key = keys[j];
-		gchar *value;
+	for (j = 0; j < group->rows->len; j++) {
+	    InfoRow *row = g_ptr_array_index(group->rows, j);
+	    gchar *value = NULL;
 
-		value =
-		    g_key_file_get_value(key_file, tmpgroup, key, NULL);
+	    if (row->type == INFO_VALUE_LAZY && ctx->entry->fieldfunc) {
+		gchar *field = info_row_get_field(row);
 
-		if (g_utf8_validate(key, -1, NULL)
-		    && g_utf8_validate(value, -1, NULL)) {
-		    strend(key, '#');
-
-		    if (g_str_equal(value, "...")) {
-			g_free(value);
-			if (!(value = ctx->entry->fieldfunc(key))) {
-			    value = g_strdup("...");
-			}
-		    }
-
-		    if (*key == '$') {
-			report_key_value(ctx, strchr(key + 1, '$') + 1,
-					 value);
-		    } else {
-			report_key_value(ctx, key, value);
-		    }
+		value = ctx->entry->fieldfunc(field);
+		g_free(field);
+	    }
 
-		}
+	    if (!value)
+		value = info_row_get_value(row);
 
-		g_free(value);
+	    if (g_utf8_validate(row->name, -1, NULL)
+		&& g_utf8_validate(value, -1, NULL)) {
+		report_key_value(ctx, row->name, value);
 	    }
 
-	    g_strfreev(keys);
-#if 0
+	    g_free(value);
 	}
-#endif
-	g_free(tmpgroup);
     }
+}
+
+/* for text in the key file format */
+void report_table(ReportContext * ctx, gchar * text)
+{
+    Info *info = info_from_key_file(text);
 
-    g_strfreev(groups);
-    g_key_file_free(key_file);
+    report_info(ctx, info);
+    info_free(info);
 }
 
 static void report_html_header(ReportContext * ctx)
 {
-    if (ctx->output)
-	g_free(ctx->output);
-
-    ctx->output =
-	g_strdup_printf
-	("<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.0 Final//EN\">\n"
+    g_string_truncate(ctx->output, 0);
+    g_string_append_printf(ctx->output,
+	 "<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.0 Final//EN\">\n"
 	 "<html><head>\n" "<title>HardInfo (%s) System Report</title>\n"
 	 "<meta http-equiv=\"Content-Type\" content=\"text/html; charset=utf-8\">\n"
 	 "<style>\n" "    body    { background: #fff }\n"
@@ -174,92 +138,85 @@ static void report_html_header(ReportContext * ctx)
 
 static void report_html_footer(ReportContext * ctx)
 {
-    ctx->output = h_strconcat(ctx->output,
-			      "</tbody></table></body></html>", NULL);
+    g_string_append(ctx->output, "</tbody></table></body></html>");
+}
+
+static void report_html_row(ReportContext * ctx, const gchar * class,
+			    gchar * text)
+{
+    g_string_append_printf(ctx->output,
+			   "<tr><td colspan=\"2\" class=\"%s\">", class);
+    h_string_append_escaped(ctx->output, text, H_ESCAPE_FROM_MARKUP);
+    g_string_append(ctx->output, "</td></tr>\n");
 }
 
 static void report_html_title(ReportContext * ctx, gchar * text)
 {
-    ctx->output = h_strdup_cprintf("<tr><td colspan=\"2\" class=\"titl"
-				  "e\">%s</td></tr>\n", ctx->output, text);
+    report_html_row(ctx, "title", text);
 }
 
 static void report_html_subtitle(ReportContext * ctx, gchar * text)
 {
-    ctx->output = h_strdup_cprintf("<tr><td colspan=\"2\" class=\"stit"
-				  "le\">%s</td></tr>\n",
-				  ctx->output,
-				  text);
+    report_html_row(ctx, "stitle", text);
 }
 
 static void report_html_subsubtitle(ReportContext * ctx, gchar * text)
 {
-    ctx->output = h_strdup_cprintf("<tr><td colspan=\"2\" class=\"ssti"
-				  "tle\">%s</td></tr>\n",
-				  ctx->output,
-				  text);
+    report_html_row(ctx, "sstitle", text);
 }
 
 static void
 report_html_key_value(ReportContext * ctx, gchar * key, gchar * value)
 {
-    ctx->output = h_strdup_cprintf("<tr><td class=\"field\">%s</td>"
-				  "<td class=\"value\">%s</td></tr>\n",
-				  ctx->output,
-				  key, value);
+    g_string_append(ctx->output, "<tr><td class=\"field\">");
+    h_string_append_escaped(ctx->output, key, H_ESCAPE_FROM_MARKUP);
+    g_string_append(ctx->output, "</td><td class=\"value\">");
+    h_string_append_escaped(ctx->output, value, H_ESCAPE_FROM_MARKUP);
+    g_string_append(ctx->output, "</td></tr>\n");
 }
 
 static void report_text_header(ReportContext * ctx)
 {
-    if (ctx->output)
-	g_free(ctx->output);
-
-    ctx->output = g_strdup("");
+    g_string_truncate(ctx->output, 0);
 }
 
 static void report_text_footer(ReportContext * ctx)
 {
 }
 
-static void report_text_title(ReportContext * ctx, gchar * text)
+static void report_text_underline(ReportContext * ctx, gchar * text,
+				  gchar chr)
 {
-    gchar *str = (gchar *) ctx->output;
-    int i = strlen(text);
+    gint i;
 
-    str = h_strdup_cprintf("\n%s\n", str, text);
-    for (; i; i--)
-	str = h_strconcat(str, "*", NULL);
+    g_string_append_printf(ctx->output, "\n%s\n", text);
+    for (i = strlen(text); i; i--)
+	g_string_append_c(ctx->output, chr);
+    g_string_append(ctx->output, "\n\n");
+}
 
-    str = h_strconcat(str, "\n\n", NULL);
-    ctx->output = str;
+static void report_text_title(ReportContext * ctx, gchar * text)
+{
+    report_text_underline(ctx, text, '*');
 }
 
 static void report_text_subtitle(ReportContext * ctx, gchar * text)
 {
-    gchar *str = ctx->output;
-    int i = strlen(text);
-
-    str = h_strdup_cprintf("\n%s\n", str, text);
-    for (; i; i--)
-	str = h_strconcat(str, "-", NULL);
-
-    str = h_strconcat(str, "\n\n", NULL);
-    ctx->output = str;
+    report_text_underline(ctx, text, '-');
 }
 
 static void report_text_subsubtitle(ReportContext * ctx, gchar * text)
 {
-    ctx->output = h_strdup_cprintf("-%s-\n", ctx->output, text);
+    g_string_append_printf(ctx->output, "-%s-\n", text);
 }
 
 static void
 report_text_key_value(ReportContext * ctx, gchar * key, gchar * value)
 {
     if (strlen(value))
-	ctx->output =
-	    h_strdup_cprintf("%s\t\t: %s\n", ctx->output, key, value);
+	g_string_append_printf(ctx->output, "%s\t\t: %s\n", key, value);
     else
-	ctx->output = h_strdup_cprintf("%s\n", ctx->output, key);
+	g_string_append_printf(ctx->output, "%s\n", key);
 }
 
 static GSList *report_create_module_list_from_dialog(ReportDialog * rd)
@@ -326,6 +283,7 @@ report_create_inner_from_module_list(ReportContext * ctx, GSList * modules)
 
 	for (entries = module->entries; entries; entries = entries->next) {
 	    ShellModuleEntry *entry = (ShellModuleEntry *) entries->data;
+	    Info *info;
 
 	    if (!params.gui_running)
 		fprintf(stderr, "\033[2K\033[40;32;1m %s\033[0m\n",
@@ -334,7 +292,10 @@ report_create_inner_from_module_list(ReportContext * ctx, GSList * modules)
 	    ctx->entry = entry;
 	    report_subtitle(ctx, entry->name);
 	    module_entry_scan(entry);
-	    report_table(ctx, module_entry_function(entry));
+
+	    info = module_entry_get_info(entry);
+	    report_info(ctx, info);
+	    info_free(info);
 	}
     }
 }
@@ -391,7 +352,7 @@ ReportContext *report_context_html_new()
     ctx->subsubtitle = report_html_subsubtitle;
     ctx->keyvalue = report_html_key_value;
 
-    ctx->output = g_strdup("");
+    ctx->output = g_string_new("");
     ctx->format = REPORT_FORMAT_HTML;
 
     return ctx;
@@ -409,7 +370,7 @@ ReportContext *report_context_text_new()
     ctx->subsubtitle = report_text_subsubtitle;
     ctx->keyvalue = report_text_key_value;
 
-    ctx->output = g_strdup("");
+    ctx->output = g_string_new("");
     ctx->format = REPORT_FORMAT_TEXT;
 
     return ctx;
@@ -417,7 +378,7 @@ ReportContext *report_context_text_new()
 
 void report_context_free(ReportContext * ctx)
 {
-    g_free(ctx->output);
+    g_string_free(ctx->output, TRUE);
     g_free(ctx);
 }
 
@@ -448,7 +409,7 @@ gchar *report_create_from_module_list_format(GSList * modules,
     ctx = create_context();
 
     report_create_from_module_list(ctx, modules);
-    retval = g_strdup(ctx->output);
+    retval = g_strdup(ctx->output->str);
 
     report_context_free(ctx);
 
@@ -483,7 +444,7 @@ static gboolean report_generate(ReportDialog * rd)
     modules = report_create_module_list_from_dialog(rd);
 
     report_create_from_module_list(ctx, modules);
-    fputs(ctx->output, stream);
+    fputs(ctx->output->str, stream);
     fclose(stream);
 
     if (ctx->format == REPORT_FORMAT_HTML) {
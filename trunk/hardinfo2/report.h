@@ -32,7 +32,7 @@ typedef struct _ReportContext	ReportContext;
 
 struct _ReportContext {
   ShellModuleEntry	*entry;
-  gchar			*output;
+  GString		*output;
   
   void (*header)      (ReportContext *ctx);
   void (*footer)      (ReportContext *ctx);
@@ -70,6 +70,7 @@ void 		 report_subtitle	(ReportContext *ctx, gchar *text);
 void 		 report_subsubtitle	(ReportContext *ctx, gchar *text);
 void		 report_key_value	(ReportContext *ctx, gchar *key, gchar *value);
 void		 report_table		(ReportContext *ctx, gchar *text);
+void		 report_info		(ReportContext *ctx, Info *info);
 
 void             report_create_from_module_list(ReportContext *ctx, GSList *modules);
 gchar           *report_create_from_module_list_format(GSList *modules, ReportFormat format);
@@ -26,6 +26,7 @@
 #include <shell.h>
 #include <syncmanager.h>
 #include <iconcache.h>
+#include <infomodel.h>
 #include <menu.h>
 #include <stock.h>
 
@@ -46,7 +47,11 @@ static void info_selected(GtkTreeSelection * ts, gpointer data);
 static void info_selected_show_extra(gchar * data);
 static gboolean reload_section(gpointer data);
 static gboolean rescan_section(gpointer data);
-static gboolean update_field(gpointer data);
+static gboolean update_fields(gpointer data);
+static gboolean window_state_changed(GtkWidget * widget,
+				     GdkEventWindowState * event,
+				     gpointer data);
+static gboolean power_check(gpointer data);
 
 /*
  * Globals ********************************************************************
@@ -54,7 +59,24 @@ static gboolean update_field(gpointer data);
 
 static Shell *shell = NULL;
 static GHashTable *update_tbl = NULL;
-static GSList *update_sfusrc = NULL;
+static GSList *field_updates = NULL;
+static gboolean info_tree_grouped = FALSE;
+
+/* module timers: none while the window is minimized, slower on battery */
+#define TIMERS_BATTERY_SCALE	4
+#define POWER_CHECK_INTERVAL	30000
+static gboolean timers_paused = FALSE;
+static gint timers_scale = 1;
+static guint power_check_source = 0;
+
+/* the reload and rescan timers of the selected entry */
+static ShellModuleEntry *section_entry = NULL;
+static gint section_reload_interval = 0, section_rescan_interval = 0;
+static guint section_reload_source = 0, section_rescan_source = 0;
+
+/* results this long are shown through an InfoModel, not copied */
+#define INFO_MODEL_MIN_ROWS	1000
+static InfoModel *info_model = NULL;
 
 /*
  * Code :) ********************************************************************
@@ -254,8 +276,8 @@ void shell_view_set_enabled(gboolean setting)
     shell_action_set_enabled("ReportAction", setting);
     shell_action_set_enabled("SyncManagerAction", setting && sync_manager_count_entries() > 0);
     shell_action_set_enabled("SaveGraphAction",
-			     setting ? shell->view_type ==
-			     SHELL_VIEW_PROGRESS : FALSE);
+			     setting ? (shell->view_type == SHELL_VIEW_PROGRESS ||
+					shell->view_type == SHELL_VIEW_PROGRESS_DUAL) : FALSE);
 }
 
 void shell_status_set_enabled(gboolean setting)
@@ -357,6 +379,8 @@ static void create_window(void)
     gtk_window_set_title(GTK_WINDOW(shell->window), "System Information");
     gtk_widget_set_size_request(shell->window, 600, 400);
     g_signal_connect(G_OBJECT(shell->window), "destroy", destroy_me, NULL);
+    g_signal_connect(G_OBJECT(shell->window), "window-state-event",
+		     G_CALLBACK(window_state_changed), NULL);
 
     vbox = gtk_vbox_new(FALSE, 0);
     gtk_widget_show(vbox);
@@ -598,84 +622,135 @@ void shell_init(GSList * modules)
 #else
     shell_action_set_enabled("SyncManagerAction", sync_manager_count_entries() > 0);
 #endif
+
+    power_check(NULL);
+    power_check_source = g_timeout_add(POWER_CHECK_INTERVAL, power_check,
+				       NULL);
 }
 
-static gboolean update_field(gpointer data)
+static guint timer_add(gint ms, GSourceFunc func, gpointer data)
 {
-    ShellFieldUpdate *fu;
+    if (timers_paused)
+	return 0;
+
+    return g_timeout_add(ms * timers_scale, func, data);
+}
+
+static void timer_remove(guint * source_id)
+{
+    if (*source_id) {
+	g_source_remove(*source_id);
+	*source_id = 0;
+    }
+}
+
+static void field_update_free(ShellFieldUpdate * fu)
+{
+    timer_remove(&fu->source_id);
+
+    g_strfreev(fu->fields);
+    g_free(fu);
+}
+
+static void field_updates_remove_all(void)
+{
+    GSList *l;
+
+    for (l = field_updates; l; l = l->next)
+	field_update_free((ShellFieldUpdate *) l->data);
+
+    g_slist_free(field_updates);
+    field_updates = NULL;
+}
+
+/*
+ * One tick for all the fields of an entry sharing an interval: a single
+ * call into the module, and only the cells whose value changed are set.
+ */
+static gboolean update_fields(gpointer data)
+{
+    ShellFieldUpdate *fu = (ShellFieldUpdate *) data;
+    GtkTreeModel *model = shell->info->model;
     GtkTreeIter *iter;
-    
-    fu = (ShellFieldUpdate *) data;
-    g_return_val_if_fail(fu != NULL, FALSE);
-    
-    iter = g_hash_table_lookup(update_tbl, fu->field_name);
-    g_return_val_if_fail(iter != NULL, FALSE);
+    gchar **values, *old;
+    gint i;
 
-    /* if the entry is still selected, update it */
-    if (iter && fu->entry->selected && fu->entry->fieldfunc) {
-	GtkTreeStore *store = GTK_TREE_STORE(shell->info->model);
-	gchar *value = fu->entry->fieldfunc(fu->field_name);
+    /* the entry is not shown anymore: this source goes away */
+    if (!fu->entry->selected) {
+	DEBUG("destroying ShellFieldUpdate for %d fields", fu->n_fields);
 
-	/*
-	 * this function is also used to feed the load graph when ViewType
-	 * is SHELL_VIEW_LOAD_GRAPH
-	 */
-	if (shell->view_type == SHELL_VIEW_LOAD_GRAPH &&
-	    gtk_tree_selection_iter_is_selected(shell->info->selection,
-						iter)) {
-	    load_graph_update(shell->loadgraph, atoi(value));
-	}
+	field_updates = g_slist_remove(field_updates, fu);
+	fu->source_id = 0;
+	field_update_free(fu);
 
-	gtk_tree_store_set(store, iter, INFO_TREE_COL_VALUE, value, -1);
+	return FALSE;
+    }
 
-	g_free(value);
+    if (!(values = module_entry_get_fields(fu->entry, fu->fields)))
 	return TRUE;
-    }
 
-    if (update_sfusrc) {
-	GSList *sfu;
+    for (i = 0; i < fu->n_fields && values[i]; i++) {
+	if (!(iter = g_hash_table_lookup(update_tbl, fu->fields[i])))
+	    continue;
 
-	for (sfu = update_sfusrc; sfu; sfu = sfu->next) {
-	    g_free(sfu->data);
+	/*
+	 * this is also used to feed the load graph when ViewType is
+	 * SHELL_VIEW_LOAD_GRAPH
+	 */
+	if (shell->view_type == SHELL_VIEW_LOAD_GRAPH &&
+	    gtk_tree_selection_iter_is_selected(shell->info->selection,
+						iter)) {
+	    load_graph_update(shell->loadgraph, atoi(values[i]));
 	}
 
-	g_slist_free(update_sfusrc);
-	update_sfusrc = NULL;
+	gtk_tree_model_get(model, iter, INFO_TREE_COL_VALUE, &old, -1);
+	if (!old || !g_str_equal(old, values[i]))
+	    gtk_tree_store_set(GTK_TREE_STORE(model), iter,
+			       INFO_TREE_COL_VALUE, values[i], -1);
+	g_free(old);
     }
 
-    DEBUG("destroying ShellFieldUpdate for field %s", fu->field_name);
-
-    /* otherwise, cleanup and destroy the timeout */
-    g_free(fu->field_name);
-    g_free(fu);
+    g_strfreev(values);
 
-    return FALSE;
+    return TRUE;
 }
 
 static gboolean reload_section(gpointer data)
 {
     ShellModuleEntry *entry = (ShellModuleEntry *) data;
 
+    /* this source is done either way */
+    section_reload_source = 0;
+
     /* if the entry is still selected, update it */
     if (entry->selected) {
 	GtkTreePath *path = NULL;
+	GtkTreeModel *model;
 	GtkTreeIter iter;
 
 	/* gets the current selected path */
 	if (gtk_tree_selection_get_selected
-	    (shell->info->selection, &shell->info->model, &iter))
-	    path = gtk_tree_model_get_path(shell->info->model, &iter);
+	    (shell->info->selection, &model, &iter))
+	    path = gtk_tree_model_get_path(model, &iter);
 
-	/* update the information, clear the treeview and populate it again */
+	/* update the information; rows still there keep their selection */
 	module_entry_reload(entry);
-	info_selected_show_extra(NULL);	/* clears the more info store */
 	module_selected_show_info(entry, TRUE);
 
-	/* if there was a selection, reselect it */
-	if (path) {
-	    gtk_tree_selection_select_path(shell->info->selection, path);
-	    gtk_tree_path_free(path);
+	if (gtk_tree_selection_get_selected
+	    (shell->info->selection, &model, &iter)) {
+	    /* its details may have changed as well */
+	    info_selected(shell->info->selection, shell->info);
+	} else {
+	    info_selected_show_extra(NULL);	/* clears the more info store */
+
+	    /* if there was a selection, reselect it */
+	    if (path)
+		gtk_tree_selection_select_path(shell->info->selection, path);
 	}
+
+	if (path)
+	    gtk_tree_path_free(path);
     }
 
     /* destroy the timeout: it'll be set up again */
@@ -686,9 +761,149 @@ static gboolean rescan_section(gpointer data)
 {
     ShellModuleEntry *entry = (ShellModuleEntry *) data;
 
+    if (!entry->selected) {
+	section_rescan_source = 0;
+	return FALSE;
+    }
+
     module_entry_reload(entry);
 
-    return entry->selected;
+    return TRUE;
+}
+
+/*
+ * The rescan timer keeps running across reloads of the same entry; the
+ * reload timer is set up again after every reload.
+ */
+static void section_timers_set(ShellModuleEntry * entry, gint reload_ms,
+			       gint rescan_ms)
+{
+    if (entry != section_entry || rescan_ms != section_rescan_interval
+	|| !section_rescan_source) {
+	timer_remove(&section_rescan_source);
+
+	if (rescan_ms)
+	    section_rescan_source = timer_add(rescan_ms, rescan_section,
+					      entry);
+    }
+
+    timer_remove(&section_reload_source);
+    if (reload_ms)
+	section_reload_source = timer_add(reload_ms, reload_section, entry);
+
+    section_entry = entry;
+    section_reload_interval = reload_ms;
+    section_rescan_interval = rescan_ms;
+}
+
+static void timers_stop(void)
+{
+    GSList *l;
+
+    for (l = field_updates; l; l = l->next)
+	timer_remove(&((ShellFieldUpdate *) l->data)->source_id);
+
+    timer_remove(&section_reload_source);
+    timer_remove(&section_rescan_source);
+}
+
+/* sets the timers up again; with refresh, everything is updated now */
+static void timers_start(gboolean refresh)
+{
+    ShellModuleEntry *entry = section_entry;
+    ShellFieldUpdate *fu;
+    GSList *l, *copy;
+
+    if (timers_paused)
+	return;
+
+    for (l = field_updates; l; l = l->next) {
+	fu = (ShellFieldUpdate *) l->data;
+
+	if (!fu->source_id)
+	    fu->source_id = timer_add(fu->interval, update_fields, fu);
+    }
+
+    if (!entry || !entry->selected)
+	return;
+
+    if (section_rescan_interval && !section_rescan_source)
+	section_rescan_source = timer_add(section_rescan_interval,
+					  rescan_section, entry);
+
+    if (section_reload_interval) {
+	if (refresh) {
+	    /* sets its own timer up again */
+	    reload_section(entry);
+	} else if (!section_reload_source) {
+	    section_reload_source = timer_add(section_reload_interval,
+					      reload_section, entry);
+	}
+
+	return;
+    }
+
+    if (refresh) {
+	if (section_rescan_interval)
+	    module_entry_reload(entry);
+
+	/* update_fields() may drop the update it is given */
+	copy = g_slist_copy(field_updates);
+	for (l = copy; l; l = l->next)
+	    update_fields(l->data);
+	g_slist_free(copy);
+    }
+}
+
+static gboolean power_check(gpointer data)
+{
+    gchar *on_battery;
+    gint scale;
+
+    on_battery = module_call_method("devices::isOnBattery");
+    scale = (on_battery && g_str_equal(on_battery, "1")) ?
+	TIMERS_BATTERY_SCALE : 1;
+    g_free(on_battery);
+
+    if (scale != timers_scale) {
+	DEBUG("module timers are now %d times slower", scale);
+
+	timers_stop();
+	timers_scale = scale;
+	timers_start(FALSE);
+    }
+
+    return TRUE;
+}
+
+static gboolean window_state_changed(GtkWidget * widget,
+				     GdkEventWindowState * event,
+				     gpointer data)
+{
+    gboolean hidden;
+
+    hidden = (event->new_window_state &
+	      (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN)) != 0;
+    if (hidden == timers_paused)
+	return FALSE;
+
+    if (hidden) {
+	DEBUG("window hidden, pausing module timers");
+
+	timers_stop();
+	timer_remove(&power_check_source);
+	timers_paused = TRUE;
+    } else {
+	DEBUG("window shown, resuming module timers");
+
+	timers_paused = FALSE;
+	power_check(NULL);
+	power_check_source = g_timeout_add(POWER_CHECK_INTERVAL,
+					   power_check, NULL);
+	timers_start(TRUE);
+    }
+
+    return FALSE;
 }
 
 gint
@@ -720,9 +935,10 @@ info_tree_compare_val_func(GtkTreeModel * model,
 
 static void set_view_type(ShellViewType viewtype)
 {
-    /* reset to the default model */
-    gtk_tree_view_set_model(GTK_TREE_VIEW(shell->info->view),
-			    shell->info->model);
+    /* reset to the default model, unless a long list is shown */
+    if (!info_model)
+	gtk_tree_view_set_model(GTK_TREE_VIEW(shell->info->view),
+				shell->info->model);
 
     /* reset to the default view columns */
     gtk_tree_view_column_set_visible(shell->info->col_progress, FALSE);
@@ -766,229 +982,455 @@ static void set_view_type(ShellViewType viewtype)
 	gtk_tree_view_column_set_visible(shell->info->col_value, FALSE);
 	gtk_widget_hide(shell->notebook);
 	break;
+    case SHELL_VIEW_PROGRESS_DUAL:
+	shell_action_set_enabled("SaveGraphAction", TRUE);
+	gtk_tree_view_column_set_visible(shell->info->col_progress, TRUE);
+	gtk_tree_view_column_set_visible(shell->info->col_value, FALSE);
+	gtk_notebook_set_page(GTK_NOTEBOOK(shell->notebook), 0);
+	gtk_widget_show(shell->notebook);
+	break;
     }
 }
 
-static void
-group_handle_special(GKeyFile * key_file, ShellModuleEntry * entry,
-		     gchar * group, gchar ** keys)
+static void info_handle_params(Info * info, ShellModuleEntry * entry)
 {
-    if (g_str_equal(group, "$ShellParam$")) {
-	gint i;
-
-	for (i = 0; keys[i]; i++) {
-	    gchar *key = keys[i];
-
-	    if (g_str_has_prefix(key, "UpdateInterval")) {
-		ShellFieldUpdate *fu = g_new0(ShellFieldUpdate, 1);
-		ShellFieldUpdateSource *sfutbl;
-		gint ms;
-
-		ms = g_key_file_get_integer(key_file, group, key, NULL);
-
-		fu->field_name = g_strdup(strchr(key, '$') + 1);
-		fu->entry = entry;
-
-		sfutbl = g_new0(ShellFieldUpdateSource, 1);
-		sfutbl->source_id = g_timeout_add(ms, update_field, fu);
-		sfutbl->sfu = fu;
-
-		update_sfusrc = g_slist_prepend(update_sfusrc, sfutbl);
-	    } else if (g_str_equal(key, "LoadGraphSuffix")) {
-		gchar *suffix =
-		    g_key_file_get_value(key_file, group, key, NULL);
-		load_graph_set_data_suffix(shell->loadgraph, suffix);
-		g_free(suffix);
-	    } else if (g_str_equal(key, "ReloadInterval")) {
-		gint ms;
-
-		ms = g_key_file_get_integer(key_file, group, key, NULL);
-
-		g_timeout_add(ms, reload_section, entry);
-	    } else if (g_str_equal(key, "RescanInterval")) {
-		gint ms;
-
-		ms = g_key_file_get_integer(key_file, group, key, NULL);
-
-		g_timeout_add(ms, rescan_section, entry);
-	    } else if (g_str_equal(key, "OrderType")) {
-		shell->_order_type = g_key_file_get_integer(key_file,
-							    group,
-							    key, NULL);
-	    } else if (g_str_equal(key, "ViewType")) {
-		set_view_type(g_key_file_get_integer(key_file, group,
-						     key, NULL));
-	    } else if (g_str_has_prefix(key, "Icon")) {
-		GtkTreeIter *iter = g_hash_table_lookup(update_tbl,
-							strchr(key,
-							       '$') + 1);
-
-		if (iter) {
-		    gchar *file =
-			g_key_file_get_value(key_file, group, key, NULL);
-		    gtk_tree_store_set(GTK_TREE_STORE(shell->info->model),
-				       iter, INFO_TREE_COL_PBUF,
-				       icon_cache_get_pixbuf_at_size(file,
-								     22,
-								     22),
-				       -1);
-		    g_free(file);
-		}
-	    } else if (g_str_equal(key, "Zebra")) {
-		gtk_tree_view_set_rules_hint(GTK_TREE_VIEW
-					     (shell->info->view),
-					     g_key_file_get_boolean
-					     (key_file, group, key, NULL));
-	    }
-	}
-    } else {
-	g_warning("Unknown parameter group: ``%s''", group);
+    if (info->load_graph_suffix)
+	load_graph_set_data_suffix(shell->loadgraph, info->load_graph_suffix);
+    section_timers_set(entry, info->reload_interval, info->rescan_interval);
+    if (info->order_type >= 0)
+	shell->_order_type = info->order_type;
+    if (info->view_type)
+	set_view_type(info->view_type);
+    if (info->zebra)
+	gtk_tree_view_set_rules_hint(GTK_TREE_VIEW(shell->info->view), TRUE);
+}
+
+/* fields are batched by entry and interval, with one source per batch */
+static void row_add_update_source(ShellModuleEntry * entry, gchar * field,
+				  gint ms)
+{
+    ShellFieldUpdate *fu = NULL;
+    GSList *l;
+
+    for (l = field_updates; l; l = l->next) {
+	fu = (ShellFieldUpdate *) l->data;
+
+	if (fu->entry == entry && fu->interval == ms)
+	    break;
+    }
+
+    if (!l) {
+	fu = g_new0(ShellFieldUpdate, 1);
+	fu->entry = entry;
+	fu->interval = ms;
+	fu->fields = g_new0(gchar *, 1);
+	fu->source_id = timer_add(ms, update_fields, fu);
+
+	field_updates = g_slist_prepend(field_updates, fu);
+    }
+
+    fu->fields = g_renew(gchar *, fu->fields, fu->n_fields + 2);
+    fu->fields[fu->n_fields++] = g_strdup(field);
+    fu->fields[fu->n_fields] = NULL;
+}
+
+/* the value shown for a row, or NULL if the row cannot be shown */
+static gchar *row_get_display_value(InfoRow * row, ShellModuleEntry * entry,
+				    gchar * field)
+{
+    gchar *value;
+
+    if (row->type == INFO_VALUE_LAZY && entry->fieldfunc)
+	value = entry->fieldfunc(field);
+    else
+	value = info_row_get_value(row);
+
+    if (value && (!g_utf8_validate(row->name, -1, NULL)
+		  || !g_utf8_validate(value, -1, NULL))) {
+	g_free(value);
+	return NULL;
     }
+
+    return value;
+}
+
+static void row_set_columns(GtkTreeStore * store, GtkTreeIter * iter,
+			    InfoRow * row, gchar * value)
+{
+    gtk_tree_store_set(store, iter,
+		       INFO_TREE_COL_VALUE, value,
+		       INFO_TREE_COL_NAME, row->name,
+		       INFO_TREE_COL_DATA, row->tag, -1);
+
+    if (row->icon)
+	gtk_tree_store_set(store, iter, INFO_TREE_COL_PBUF,
+			   icon_cache_get_pixbuf_at_size(row->icon, 22, 22),
+			   -1);
 }
 
 static void
-group_handle_normal(GKeyFile * key_file, ShellModuleEntry * entry,
-		    gchar * group, gchar ** keys, gsize ngroups)
+group_handle_normal(InfoGroup * group, ShellModuleEntry * entry,
+		    gsize ngroups)
 {
     GtkTreeIter parent;
     GtkTreeStore *store = GTK_TREE_STORE(shell->info->model);
-    gchar *tmp = g_strdup(group);
-    gint i;
+    guint i;
 
     if (ngroups > 1) {
 	gtk_tree_store_append(store, &parent, NULL);
-
-	strend(tmp, '#');
-	gtk_tree_store_set(store, &parent, INFO_TREE_COL_NAME, tmp, -1);
-	g_free(tmp);
+	gtk_tree_store_set(store, &parent, INFO_TREE_COL_NAME, group->name,
+			   -1);
     }
 
-    for (i = 0; keys[i]; i++) {
-	gchar *key = keys[i];
-	gchar *value;
+    for (i = 0; i < group->rows->len; i++) {
+	InfoRow *row = g_ptr_array_index(group->rows, i);
+	gchar *field, *value;
 	GtkTreeIter child;
 
-	value = g_key_file_get_value(key_file, group, key, NULL);
-	if (entry->fieldfunc && value && g_str_equal(value, "...")) {
-	    g_free(value);
-	    value = entry->fieldfunc(key);
-	}
+	field = info_row_get_field(row);
 
-	if ((key && value) &&
-	    g_utf8_validate(key, -1, NULL)
-	    && g_utf8_validate(value, -1, NULL)) {
+	if ((value = row_get_display_value(row, entry, field))) {
 	    if (ngroups == 1) {
 		gtk_tree_store_append(store, &child, NULL);
 	    } else {
 		gtk_tree_store_append(store, &child, &parent);
 	    }
-	    gtk_tree_store_set(store, &child, INFO_TREE_COL_VALUE, value,
-			       -1);
 
-	    strend(key, '#');
+	    row_set_columns(store, &child, row, value);
 
-	    if (*key == '$') {
-		gchar **tmp;
+	    g_hash_table_insert(update_tbl, g_strdup(field),
+				gtk_tree_iter_copy(&child));
+
+	    if (row->update_interval)
+		row_add_update_source(entry, field, row->update_interval);
+	}
+
+	g_free(value);
+	g_free(field);
+    }
+}
+
+/*
+ * On reload, rows already on screen are matched with the new ones by group
+ * and $KEY$ field: values are set only where they changed, and only rows
+ * that came or went are inserted or removed. Selection, scrolling and
+ * collapsed groups survive this; a rebuild loses them.
+ */
+static void info_tree_index_row(GHashTable * rows, GSList ** stale,
+				GtkTreeIter * iter, const gchar * group)
+{
+    GtkTreeModel *model = shell->info->model;
+    gchar *name, *tag, *key;
+
+    gtk_tree_model_get(model, iter, INFO_TREE_COL_NAME, &name,
+		       INFO_TREE_COL_DATA, &tag, -1);
+
+    if (tag)
+	key = g_strconcat(group, "\n", tag, "$", name, NULL);
+    else
+	key = g_strconcat(group, "\n", name, NULL);
 
-		tmp = g_strsplit(++key, "$", 0);
+    /* a key seen twice: keep the first row, the other goes */
+    if (g_hash_table_lookup(rows, key)) {
+	*stale = g_slist_prepend(*stale, gtk_tree_iter_copy(iter));
+	g_free(key);
+    } else {
+	g_hash_table_insert(rows, key, gtk_tree_iter_copy(iter));
+    }
 
-		gtk_tree_store_set(store, &child, INFO_TREE_COL_NAME,
-				   tmp[1], INFO_TREE_COL_DATA, tmp[0], -1);
+    g_free(name);
+    g_free(tag);
+}
+
+static void info_tree_index(GHashTable * groups, GHashTable * rows,
+			    GSList ** stale, gboolean grouped)
+{
+    GtkTreeModel *model = shell->info->model;
+    GtkTreeIter iter, child;
+    gchar *name;
+
+    if (!gtk_tree_model_get_iter_first(model, &iter))
+	return;
+
+    do {
+	if (!grouped) {
+	    info_tree_index_row(rows, stale, &iter, "");
+	    continue;
+	}
+
+	gtk_tree_model_get(model, &iter, INFO_TREE_COL_NAME, &name, -1);
+	if (!name || g_hash_table_lookup(groups, name)) {
+	    *stale = g_slist_prepend(*stale, gtk_tree_iter_copy(&iter));
+	    g_free(name);
+	    continue;
+	}
+
+	g_hash_table_insert(groups, name, gtk_tree_iter_copy(&iter));
+
+	if (gtk_tree_model_iter_children(model, &child, &iter)) {
+	    do {
+		info_tree_index_row(rows, stale, &child, name);
+	    } while (gtk_tree_model_iter_next(model, &child));
+	}
+    } while (gtk_tree_model_iter_next(model, &iter));
+}
+
+/* moves a row right after prev (or first, if NULL), unless it is there */
+static void info_tree_place(GtkTreeIter * iter, GtkTreeIter * parent,
+			    GtkTreeIter * prev)
+{
+    GtkTreeModel *model = shell->info->model;
+    GtkTreeIter next;
+    gboolean valid;
+
+    if (prev) {
+	next = *prev;
+	valid = gtk_tree_model_iter_next(model, &next);
+    } else {
+	valid = gtk_tree_model_iter_children(model, &next, parent);
+    }
 
-		g_strfreev(tmp);
+    /* tree store iters point at their node */
+    if (!valid || next.user_data != iter->user_data)
+	gtk_tree_store_move_after(GTK_TREE_STORE(model), iter, prev);
+}
+
+static void info_tree_remove(gpointer key, gpointer value, gpointer data)
+{
+    gtk_tree_store_remove(GTK_TREE_STORE(shell->info->model),
+			  (GtkTreeIter *) value);
+}
+
+static void info_tree_update(Info * info, ShellModuleEntry * entry)
+{
+    GtkTreeModel *model = shell->info->model;
+    GtkTreeStore *store = GTK_TREE_STORE(model);
+    GHashTable *groups, *rows;
+    GSList *stale = NULL, *l;
+    GtkTreeIter parent, child, prev_group, prev, *found;
+    gboolean grouped = info->groups->len > 1, sorted;
+    gboolean has_prev_group = FALSE, has_prev, inserted;
+    guint i, j;
+
+    groups = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+				   (GDestroyNotify) gtk_tree_iter_free);
+    rows = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+				 (GDestroyNotify) gtk_tree_iter_free);
+
+    info_tree_index(groups, rows, &stale, grouped);
+
+    for (l = stale; l; l = l->next) {
+	gtk_tree_store_remove(store, l->data);
+	gtk_tree_iter_free(l->data);
+    }
+    g_slist_free(stale);
+
+    /* a sorted store keeps its own order and refuses moves */
+    sorted = gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE(model),
+						  NULL, NULL);
+
+    for (i = 0; i < info->groups->len; i++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, i);
+	const gchar *group_key = grouped ? group->name : "";
+
+	inserted = FALSE;
+	has_prev = FALSE;
+
+	if (grouped) {
+	    if ((found = g_hash_table_lookup(groups, group->name))) {
+		parent = *found;
+		g_hash_table_remove(groups, group->name);
+
+		if (!sorted)
+		    info_tree_place(&parent, NULL,
+				    has_prev_group ? &prev_group : NULL);
+	    } else {
+		gtk_tree_store_insert_after(store, &parent, NULL,
+					    has_prev_group ? &prev_group :
+					    NULL);
+		gtk_tree_store_set(store, &parent, INFO_TREE_COL_NAME,
+				   group->name, -1);
+		inserted = TRUE;
+	    }
+
+	    prev_group = parent;
+	    has_prev_group = TRUE;
+	}
+
+	for (j = 0; j < group->rows->len; j++) {
+	    InfoRow *row = g_ptr_array_index(group->rows, j);
+	    gchar *field, *value, *key, *old;
+
+	    field = info_row_get_field(row);
+	    if (!(value = row_get_display_value(row, entry, field))) {
+		g_free(field);
+		continue;
+	    }
+
+	    key = g_strconcat(group_key, "\n", field, NULL);
+
+	    if ((found = g_hash_table_lookup(rows, key))) {
+		child = *found;
+		g_hash_table_remove(rows, key);
+
+		gtk_tree_model_get(model, &child, INFO_TREE_COL_VALUE, &old,
+				   -1);
+		if (!old || !g_str_equal(old, value))
+		    gtk_tree_store_set(store, &child, INFO_TREE_COL_VALUE,
+				       value, -1);
+		g_free(old);
+
+		if (!sorted)
+		    info_tree_place(&child, grouped ? &parent : NULL,
+				    has_prev ? &prev : NULL);
 	    } else {
-		gtk_tree_store_set(store, &child, INFO_TREE_COL_NAME, key,
-				   INFO_TREE_COL_DATA, NULL, -1);
+		gtk_tree_store_insert_after(store, &child,
+					    grouped ? &parent : NULL,
+					    has_prev ? &prev : NULL);
+		row_set_columns(store, &child, row, value);
 	    }
 
-	    g_hash_table_insert(update_tbl, g_strdup(key),
+	    prev = child;
+	    has_prev = TRUE;
+
+	    g_hash_table_insert(update_tbl, g_strdup(field),
 				gtk_tree_iter_copy(&child));
 
+	    if (row->update_interval)
+		row_add_update_source(entry, field, row->update_interval);
+
+	    g_free(key);
+	    g_free(value);
+	    g_free(field);
 	}
 
-	g_free(value);
+	if (inserted) {
+	    GtkTreePath *path = gtk_tree_model_get_path(model, &parent);
+
+	    gtk_tree_view_expand_row(GTK_TREE_VIEW(shell->info->view), path,
+				     TRUE);
+	    gtk_tree_path_free(path);
+	}
     }
+
+    /* whatever was not matched is gone; rows first, then their groups */
+    g_hash_table_foreach(rows, info_tree_remove, NULL);
+    g_hash_table_foreach(groups, info_tree_remove, NULL);
+
+    g_hash_table_destroy(rows);
+    g_hash_table_destroy(groups);
 }
 
-static void
-moreinfo_handle_normal(GKeyFile * key_file, gchar * group, gchar ** keys)
+static void moreinfo_handle_normal(InfoGroup * group)
 {
     GtkTreeIter parent;
     GtkTreeStore *store = GTK_TREE_STORE(shell->moreinfo->model);
-    gint i;
+    guint i;
 
     gtk_tree_store_append(store, &parent, NULL);
-    gtk_tree_store_set(store, &parent, INFO_TREE_COL_NAME, group, -1);
+    gtk_tree_store_set(store, &parent, INFO_TREE_COL_NAME, group->name, -1);
 
-    for (i = 0; keys[i]; i++) {
-	gchar *key = keys[i];
+    for (i = 0; i < group->rows->len; i++) {
+	InfoRow *row = g_ptr_array_index(group->rows, i);
 	GtkTreeIter child;
 	gchar *value;
 
-	value = g_key_file_get_value(key_file, group, key, NULL);
+	value = info_row_get_value(row);
 
-	if (g_utf8_validate(key, -1, NULL)
+	if (g_utf8_validate(row->name, -1, NULL)
 	    && g_utf8_validate(value, -1, NULL)) {
-	    strend(key, '#');
-
 	    gtk_tree_store_append(store, &child, &parent);
 	    gtk_tree_store_set(store, &child, INFO_TREE_COL_VALUE,
-			       value, INFO_TREE_COL_NAME, key, -1);
+			       value, INFO_TREE_COL_NAME, row->name, -1);
 	}
 
 	g_free(value);
     }
 }
 
-static void update_progress()
+typedef struct {
+    gdouble maxv, maxp;
+} ProgressScale;
+
+/* group headers, when results are grouped, have no value of their own */
+static gboolean progress_get_value(GtkTreeModel * model, GtkTreeIter * iter,
+				   gdouble * value)
 {
-    GtkTreeModel *model = shell->info->model;
-    GtkTreeStore *store = GTK_TREE_STORE(model);
-    GtkTreeIter iter, fiter;
     gchar *tmp;
-    gdouble maxv = 0, maxp = 0, cur;
 
-    gtk_tree_model_get_iter_first(model, &fiter);
+    if (gtk_tree_model_iter_has_child(model, iter))
+	return FALSE;
 
-    /* finds the maximum value */
-    iter = fiter;
-    do {
-	gtk_tree_model_get(model, &iter, INFO_TREE_COL_VALUE, &tmp, -1);
+    gtk_tree_model_get(model, iter, INFO_TREE_COL_VALUE, &tmp, -1);
+    if (!tmp)
+	return FALSE;
 
-	cur = atof(tmp);
-	maxv = MAX(maxv, cur);
+    *value = atof(tmp);
+    g_free(tmp);
 
-	g_free(tmp);
-    } while (gtk_tree_model_iter_next(model, &iter));
+    return TRUE;
+}
 
-    /* calculates the relative percentage and finds the maximum percentage */
-    if (shell->_order_type == SHELL_ORDER_ASCENDING) {
-	iter = fiter;
-	do {
-	    gtk_tree_model_get(model, &iter, INFO_TREE_COL_VALUE, &tmp,
-			       -1);
+static gboolean progress_find_max(GtkTreeModel * model, GtkTreePath * path,
+				  GtkTreeIter * iter, gpointer data)
+{
+    ProgressScale *scale = (ProgressScale *) data;
+    gdouble cur;
 
-	    cur = 100 - 100 * atof(tmp) / maxv;
-	    maxp = MAX(cur, maxp);
+    if (progress_get_value(model, iter, &cur))
+	scale->maxv = MAX(scale->maxv, cur);
 
-	    g_free(tmp);
-	} while (gtk_tree_model_iter_next(model, &iter));
+    return FALSE;
+}
 
-	maxp = 100 - maxp;
-    }
+static gboolean progress_find_max_relative(GtkTreeModel * model,
+					   GtkTreePath * path,
+					   GtkTreeIter * iter, gpointer data)
+{
+    ProgressScale *scale = (ProgressScale *) data;
+    gdouble cur;
 
-    /* fix the maximum relative percentage */
-    iter = fiter;
-    do {
-	gtk_tree_model_get(model, &iter, INFO_TREE_COL_VALUE, &tmp, -1);
+    if (progress_get_value(model, iter, &cur))
+	scale->maxp = MAX(scale->maxp, 100 - 100 * cur / scale->maxv);
+
+    return FALSE;
+}
 
-	cur = 100 * atof(tmp) / maxv;
-	if (shell->_order_type == SHELL_ORDER_ASCENDING)
-	    cur = 100 - cur + maxp;
+static gboolean progress_set(GtkTreeModel * model, GtkTreePath * path,
+			     GtkTreeIter * iter, gpointer data)
+{
+    ProgressScale *scale = (ProgressScale *) data;
+    gdouble cur;
 
-	gtk_tree_store_set(store, &iter, INFO_TREE_COL_PROGRESS, cur, -1);
-	g_free(tmp);
-    } while (gtk_tree_model_iter_next(model, &iter));
+    if (!progress_get_value(model, iter, &cur))
+	return FALSE;
+
+    cur = 100 * cur / scale->maxv;
+    if (shell->_order_type == SHELL_ORDER_ASCENDING)
+	cur = 100 - cur + scale->maxp;
+
+    gtk_tree_store_set(GTK_TREE_STORE(model), iter,
+		       INFO_TREE_COL_PROGRESS, cur, -1);
+
+    return FALSE;
+}
+
+static void update_progress()
+{
+    GtkTreeModel *model = shell->info->model;
+    ProgressScale scale = { 0, 0 };
+
+    /* finds the maximum value */
+    gtk_tree_model_foreach(model, progress_find_max, &scale);
+
+    /* calculates the relative percentage and finds the maximum percentage */
+    if (shell->_order_type == SHELL_ORDER_ASCENDING) {
+	gtk_tree_model_foreach(model, progress_find_max_relative, &scale);
+	scale.maxp = 100 - scale.maxp;
+    }
+
+    /* fix the maximum relative percentage */
+    gtk_tree_model_foreach(model, progress_set, &scale);
 
     /* now sort everything up. that wasn't as hard as i thought :) */
     GtkTreeSortable *sortable = GTK_TREE_SORTABLE(shell->info->model);
@@ -1018,17 +1460,62 @@ void shell_set_note_from_entry(ShellModuleEntry * entry)
     }
 }
 
+/*
+ * Long lists with nothing updated on their own (kernel modules, users)
+ * are handed to an InfoModel instead, which reads from the result itself.
+ * Progress and load graph views need the tree store.
+ */
+static gboolean info_is_long_list(Info * info)
+{
+    guint i, j, n = 0;
+
+    if (info->view_type != SHELL_VIEW_NORMAL
+	&& info->view_type != SHELL_VIEW_DUAL)
+	return FALSE;
+
+    for (i = 0; i < info->groups->len; i++) {
+	InfoGroup *group = g_ptr_array_index(info->groups, i);
+
+	for (j = 0; j < group->rows->len; j++) {
+	    InfoRow *row = g_ptr_array_index(group->rows, j);
+
+	    if (row->type == INFO_VALUE_LAZY || row->update_interval)
+		return FALSE;
+	}
+
+	n += group->rows->len;
+    }
+
+    return n >= INFO_MODEL_MIN_ROWS;
+}
+
+static void info_model_drop(void)
+{
+    if (!info_model)
+	return;
+
+    gtk_tree_view_set_model(GTK_TREE_VIEW(shell->info->view),
+			    shell->info->model);
+    g_object_unref(info_model);
+    info_model = NULL;
+}
+
 static void
 module_selected_show_info(ShellModuleEntry * entry, gboolean reload)
 {
-    GKeyFile *key_file = g_key_file_new();
     GtkTreeStore *store;
-    gchar *key_data, **groups;
-    gint i;
-    gsize ngroups;
+    ShellViewType view_type = shell->view_type;
+    gboolean grouped, long_list;
+    Info *info;
+    guint i;
 
     module_entry_scan(entry);
-    key_data = module_entry_function(entry);
+    info = module_entry_get_info(entry);
+
+    grouped = info->groups->len > 1;
+    long_list = info_is_long_list(info);
+    if (!long_list || !reload)
+	info_model_drop();
 
     /* reset the view type to normal */
     set_view_type(SHELL_VIEW_NORMAL);
@@ -1038,58 +1525,51 @@ module_selected_show_info(ShellModuleEntry * entry, gboolean reload)
         h_hash_table_remove_all(update_tbl);
     }
     
-    if (update_sfusrc) {
-	GSList *sfusrc;
-
-	for (sfusrc = update_sfusrc; sfusrc; sfusrc = sfusrc->next) {
-	    ShellFieldUpdateSource *src =
-		(ShellFieldUpdateSource *) sfusrc->data;
-
-	    g_source_remove(src->source_id);
-	    g_free(src->sfu->field_name);
-	    g_free(src->sfu);
-	    g_free(src);
-	}
-
-	g_slist_free(update_sfusrc);
-	update_sfusrc = NULL;
-    }
+    field_updates_remove_all();
 
     store = GTK_TREE_STORE(shell->info->model);
-    gtk_tree_store_clear(store);
 
-    g_key_file_load_from_data(key_file, key_data, strlen(key_data), 0,
-			      NULL);
-    groups = g_key_file_get_groups(key_file, &ngroups);
+    info_handle_params(info, entry);
 
-    for (i = 0; groups[i]; i++)
-	if (groups[i][0] == '$')
-	    ngroups--;
+    if (long_list) {
+	gtk_tree_store_clear(store);
+	h_hash_table_remove_all(update_tbl);
 
-    for (i = 0; groups[i]; i++) {
-	gchar *group = groups[i];
-	gchar **keys = g_key_file_get_keys(key_file, group, NULL, NULL);
-
-	if (*group == '$') {
-	    group_handle_special(key_file, entry, group, keys);
+	/* the model takes the result */
+	if (info_model) {
+	    if (info_model_set_info(info_model, info))
+		gtk_tree_view_expand_all(GTK_TREE_VIEW(shell->info->view));
 	} else {
-	    group_handle_normal(key_file, entry, group, keys, ngroups);
+	    info_model = info_model_new(info);
+	    gtk_tree_view_set_model(GTK_TREE_VIEW(shell->info->view),
+				    GTK_TREE_MODEL(info_model));
+	    gtk_tree_view_expand_all(GTK_TREE_VIEW(shell->info->view));
 	}
+	info = NULL;
+    } else if (reload && shell->view_type == view_type &&
+	       info_tree_grouped == grouped) {
+	h_hash_table_remove_all(update_tbl);
+	info_tree_update(info, entry);
+    } else {
+	gtk_tree_store_clear(store);
 
-	g_strfreev(keys);
+	for (i = 0; i < info->groups->len; i++)
+	    group_handle_normal(g_ptr_array_index(info->groups, i), entry,
+				info->groups->len);
+
+	gtk_tree_view_expand_all(GTK_TREE_VIEW(shell->info->view));
     }
 
-    gtk_tree_view_expand_all(GTK_TREE_VIEW(shell->info->view));
+    info_tree_grouped = grouped;
 
-    if (shell->view_type == SHELL_VIEW_PROGRESS) {
+    if (shell->view_type == SHELL_VIEW_PROGRESS ||
+	shell->view_type == SHELL_VIEW_PROGRESS_DUAL) {
 	update_progress();
     }
 
     shell_set_note_from_entry(entry);
 
-    g_strfreev(groups);
-    g_key_file_free(key_file);
-    g_free(key_data);
+    info_free(info);
 }
 
 static void info_selected_show_extra(gchar * data)
@@ -1103,27 +1583,16 @@ static void info_selected_show_extra(gchar * data)
 	return;
 
     if (data) {
-	GKeyFile *key_file = g_key_file_new();
 	gchar *key_data = shell->selected->morefunc(data);
-	gchar **groups;
-	gint i;
-
-	g_key_file_load_from_data(key_file, key_data, strlen(key_data), 0,
-				  NULL);
-	groups = g_key_file_get_groups(key_file, NULL);
+	Info *info = info_from_key_file(key_data);
+	guint i;
 
-	for (i = 0; groups[i]; i++) {
-	    gchar *group = groups[i];
-	    gchar **keys =
-		g_key_file_get_keys(key_file, group, NULL, NULL);
-
-	    moreinfo_handle_normal(key_file, group, keys);
-	}
+	for (i = 0; i < info->groups->len; i++)
+	    moreinfo_handle_normal(g_ptr_array_index(info->groups, i));
 
 	gtk_tree_view_expand_all(GTK_TREE_VIEW(shell->moreinfo->view));
 
-	g_strfreev(groups);
-	g_key_file_free(key_file);
+	info_free(info);
 	g_free(key_data);
     }
 }
@@ -1200,6 +1669,7 @@ static void module_selected(gpointer data)
 	shell_action_set_enabled("RefreshAction", FALSE);
 	shell_action_set_enabled("CopyAction", FALSE);
 
+	info_model_drop();
 	gtk_tree_store_clear(GTK_TREE_STORE(shell->info->model));
 	set_view_type(SHELL_VIEW_NORMAL);
     }
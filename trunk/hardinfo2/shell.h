@@ -20,6 +20,7 @@
 
 #include <gtk/gtk.h>
 #include <loadgraph.h>
+#include <info.h>
 
 typedef struct _Shell			Shell;
 typedef struct _ShellTree		ShellTree;
@@ -31,7 +32,6 @@ typedef struct _ShellModuleMethod	ShellModuleMethod;
 typedef struct _ShellModuleEntry	ShellModuleEntry;
 
 typedef struct _ShellFieldUpdate	ShellFieldUpdate;
-typedef struct _ShellFieldUpdateSource	ShellFieldUpdateSource;
 
 typedef enum {
     SHELL_ORDER_DESCENDING,
@@ -48,6 +48,7 @@ typedef enum {
     SHELL_VIEW_DUAL,
     SHELL_VIEW_LOAD_GRAPH,
     SHELL_VIEW_PROGRESS,
+    SHELL_VIEW_PROGRESS_DUAL,
     SHELL_VIEW_N_VIEWS
 } ShellViewType;
 
@@ -136,19 +137,20 @@ struct _ShellModuleEntry {
     gchar		*(*func) ();
     void		(*scan_func) ();
 
+    Info		*(*infofunc) (gint entry);
     gchar		*(*fieldfunc) (gchar * entry);
+    gchar	       **(*fieldsfunc) (gchar ** fields);
     gchar 		*(*morefunc) (gchar * entry);
     gchar		*(*notefunc) (gint entry);
 };
 
+/* the fields of an entry updated on the same interval, in one call */
 struct _ShellFieldUpdate {
     ShellModuleEntry	*entry;
-    gchar		*field_name;
-};
-
-struct _ShellFieldUpdateSource {
+    gint		 interval;
+    gchar	       **fields;
+    gint		 n_fields;
     guint		 source_id;
-    ShellFieldUpdate	*sfu;
 };
 
 void		shell_init(GSList *modules);
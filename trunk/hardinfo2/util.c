@@ -34,6 +34,7 @@
 #include <shell.h>
 #include <iconcache.h>
 #include <hardinfo.h>
+#include <arena.h>
 #include <gtk/gtk.h>
 
 #include <binreloc.h>
@@ -322,6 +323,12 @@ void parameters_init(int *argc, char ***argv, ProgramParameters * param)
     static gboolean show_version = FALSE;
     static gboolean list_modules = FALSE;
     static gboolean autoload_deps = FALSE;
+    static gboolean benchmark_in_process = FALSE;
+    static gboolean profile_scans = FALSE;
+    static gchar *benchmark_cpus = NULL;
+    static gchar *benchmark_filter = NULL;
+    static gchar *benchmark_group = NULL;
+    static gchar *benchmark_reference = NULL;
     static gchar *report_format = NULL;
     static gchar **use_modules = NULL;
 
@@ -356,6 +363,42 @@ void parameters_init(int *argc, char ***argv, ProgramParameters * param)
 	 .arg = G_OPTION_ARG_NONE,
 	 .arg_data = &autoload_deps,
 	 .description = "automatically load module dependencies"},
+	{
+	 .long_name = "benchmark-cpus",
+	 .short_name = 'c',
+	 .arg = G_OPTION_ARG_STRING,
+	 .arg_data = &benchmark_cpus,
+	 .description = "runs benchmarks only on the given CPUs (e.g. 0-3,8)"},
+	{
+	 .long_name = "benchmark-in-process",
+	 .short_name = 'i',
+	 .arg = G_OPTION_ARG_NONE,
+	 .arg_data = &benchmark_in_process,
+	 .description = "runs benchmarks inside HardInfo instead of a helper process"},
+	{
+	 .long_name = "benchmark-filter",
+	 .short_name = 'F',
+	 .arg = G_OPTION_ARG_STRING,
+	 .arg_data = &benchmark_filter,
+	 .description = "compares only with machines matching, e.g. \"Threads=4;CPU Model=*Xeon*\""},
+	{
+	 .long_name = "benchmark-group",
+	 .short_name = 'g',
+	 .arg = G_OPTION_ARG_STRING,
+	 .arg_data = &benchmark_group,
+	 .description = "groups compared machines by a key (e.g. Threads, Kernel)"},
+	{
+	 .long_name = "benchmark-reference",
+	 .short_name = 'R',
+	 .arg = G_OPTION_ARG_STRING,
+	 .arg_data = &benchmark_reference,
+	 .description = "reference machine for the composite score"},
+	{
+	 .long_name = "profile-scans",
+	 .short_name = 'p',
+	 .arg = G_OPTION_ARG_NONE,
+	 .arg_data = &profile_scans,
+	 .description = "prints the time and arena use of each scan"},
 	{
 	 .long_name = "version",
 	 .short_name = 'v',
@@ -387,6 +430,12 @@ void parameters_init(int *argc, char ***argv, ProgramParameters * param)
     param->list_modules = list_modules;
     param->use_modules = use_modules;
     param->autoload_deps = autoload_deps;
+    param->benchmark_cpus = benchmark_cpus;
+    param->benchmark_filter = benchmark_filter;
+    param->benchmark_group = benchmark_group;
+    param->benchmark_reference = benchmark_reference;
+    param->benchmark_in_process = benchmark_in_process;
+    param->profile_scans = profile_scans;
 
     if (report_format && g_str_equal(report_format, "html"))
 	param->report_format = REPORT_FORMAT_HTML;
@@ -550,10 +599,14 @@ static ShellModule *module_load(gchar * filename)
 		entry->icon = icon_cache_get_pixbuf(entries[i].icon);
 	    }
 
+	    g_module_symbol(module->dll, "hi_info",
+			    (gpointer) & (entry->infofunc));
 	    g_module_symbol(module->dll, "hi_more_info",
 			    (gpointer) & (entry->morefunc));
 	    g_module_symbol(module->dll, "hi_get_field",
 			    (gpointer) & (entry->fieldfunc));
+	    g_module_symbol(module->dll, "hi_get_fields",
+			    (gpointer) & (entry->fieldsfunc));
 	    g_module_symbol(module->dll, "hi_note_func",
 			    (gpointer) & (entry->notefunc));
 
@@ -915,6 +968,44 @@ gpointer __idle_free(gpointer ptr, gchar * f, gint l)
     return ptr;
 }
 
+/*
+ * With --profile-scans, reports how long a scan took and what it took
+ * from the scan arenas: how many allocations, and in how many blocks.
+ * Scanners that do not use an arena show up with time only.
+ */
+static void module_entry_scan_profiled(const gchar * name,
+				       void (*scan_func) (gboolean reload),
+				       gboolean reload)
+{
+    ArenaStats start, end;
+    GTimer *timer;
+
+    if (!params.profile_scans) {
+	scan_func(reload);
+	return;
+    }
+
+    arena_get_stats(&start);
+    timer = g_timer_new();
+
+    scan_func(reload);
+
+    g_timer_stop(timer);
+    arena_get_stats(&end);
+
+    g_printerr("scan %s%s: %.3f ms; arena: %" G_GUINT64_FORMAT
+	       " allocations in %" G_GUINT64_FORMAT " blocks (%"
+	       G_GUINT64_FORMAT " bytes), %" G_GUINT64_FORMAT " interned\n",
+	       name, reload ? " (reload)" : "",
+	       g_timer_elapsed(timer, NULL) * 1000.0,
+	       end.allocations - start.allocations,
+	       end.blocks - start.blocks,
+	       end.bytes - start.bytes,
+	       end.interned - start.interned);
+
+    g_timer_destroy(timer);
+}
+
 void module_entry_scan_all_except(ModuleEntry * entries, gint except_entry)
 {
     ModuleEntry entry;
@@ -933,7 +1024,7 @@ void module_entry_scan_all_except(ModuleEntry * entries, gint except_entry)
 	g_free(text);
 
 	if ((scan_callback = entry.scan_callback)) {
-	    scan_callback(FALSE);
+	    module_entry_scan_profiled(entry.name, scan_callback, FALSE);
 	}
     }
 
@@ -949,14 +1040,16 @@ void module_entry_scan_all(ModuleEntry * entries)
 void module_entry_reload(ShellModuleEntry * module_entry)
 {
     if (module_entry->scan_func) {
-	module_entry->scan_func(TRUE);
+	module_entry_scan_profiled(module_entry->name,
+				   module_entry->scan_func, TRUE);
     }
 }
 
 void module_entry_scan(ShellModuleEntry * module_entry)
 {
     if (module_entry->scan_func) {
-	module_entry->scan_func(FALSE);
+	module_entry_scan_profiled(module_entry->name,
+				   module_entry->scan_func, FALSE);
     }
 }
 
@@ -966,9 +1059,65 @@ gchar *module_entry_function(ShellModuleEntry * module_entry)
 	return g_strdup(module_entry->func());
     }
 
+    if (module_entry->infofunc) {
+	Info *info = module_entry->infofunc(module_entry->number);
+
+	if (info) {
+	    gchar *text = info_to_key_file(info);
+
+	    info_free(info);
+	    return text;
+	}
+    }
+
     return g_strdup("[Error]\n" "Invalid module=");
 }
 
+/*
+ * Values for a NULL-terminated list of fields, in one call to the module
+ * when it has hi_get_fields(); NULL if it cannot give any.
+ */
+gchar **module_entry_get_fields(ShellModuleEntry * module_entry,
+				gchar ** fields)
+{
+    gchar **values;
+    gint i;
+
+    if (module_entry->fieldsfunc)
+	return module_entry->fieldsfunc(fields);
+
+    if (!module_entry->fieldfunc)
+	return NULL;
+
+    values = g_new0(gchar *, g_strv_length(fields) + 1);
+    for (i = 0; fields[i]; i++) {
+	if (!(values[i] = module_entry->fieldfunc(fields[i])))
+	    values[i] = g_strdup("");
+    }
+
+    return values;
+}
+
+/*
+ * Entries that build their information with hi_info() hand it over as is;
+ * the others still return key file text, which is parsed here.
+ */
+Info *module_entry_get_info(ShellModuleEntry * module_entry)
+{
+    Info *info;
+    gchar *text;
+
+    if (module_entry->infofunc
+	&& (info = module_entry->infofunc(module_entry->number)))
+	return info;
+
+    text = module_entry_function(module_entry);
+    info = info_from_key_file(text);
+    g_free(text);
+
+    return info;
+}
+
 const gchar *module_entry_get_note(ShellModuleEntry * module_entry)
 {
     return module_entry->notefunc(module_entry->number);
@@ -1031,6 +1180,61 @@ gchar *h_strconcat(gchar * string1, ...)
     return concat;
 }
 
+/*
+ * h_strdup_cprintf() and h_strconcat() copy the whole string on each call,
+ * which makes loops over many items quadratic. Those are built in a GString
+ * instead, which grows by doubling; this appends text that must not break
+ * the format it goes into.
+ */
+void h_string_append_escaped(GString * string, const gchar * text,
+			     HStringEscape escape)
+{
+    gchar *escaped, *plain;
+
+    if (!text)
+	return;
+
+    switch (escape) {
+    case H_ESCAPE_MARKUP:
+	escaped = g_markup_escape_text(text, -1);
+	g_string_append(string, escaped);
+	g_free(escaped);
+	break;
+    case H_ESCAPE_FROM_MARKUP:
+	/* labels may carry Pango markup; keep only what it shows */
+	if (pango_parse_markup(text, -1, 0, NULL, &plain, NULL, NULL)) {
+	    escaped = g_markup_escape_text(plain, -1);
+	    g_free(plain);
+	} else {
+	    escaped = g_markup_escape_text(text, -1);
+	}
+	g_string_append(string, escaped);
+	g_free(escaped);
+	break;
+    case H_ESCAPE_KEY_FILE_KEY:
+    case H_ESCAPE_KEY_FILE_VALUE:
+	for (; *text; text++) {
+	    /* a line break would end the entry */
+	    if (*text == '\n' || *text == '\r') {
+		g_string_append_c(string, ' ');
+		continue;
+	    }
+
+	    /* in a key, '=' would end it and '#' starts the hidden
+	       uniqueness suffix: use the full-width forms instead */
+	    if (escape == H_ESCAPE_KEY_FILE_KEY && *text == '=')
+		g_string_append(string, "\xef\xbc\x9d");
+	    else if (escape == H_ESCAPE_KEY_FILE_KEY && *text == '#')
+		g_string_append(string, "\xef\xbc\x83");
+	    else
+		g_string_append_c(string, *text);
+	}
+	break;
+    default:
+	g_string_append(string, text);
+    }
+}
+
 static gboolean h_hash_table_remove_all_true(gpointer key, gpointer data, gpointer user_data)
 {
     return TRUE;
@@ -0,0 +1,310 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <string.h>
+#include <workpool.h>
+
+typedef struct _WorkPoolTask WorkPoolTask;
+
+struct _WorkPoolTask {
+    WorkPoolFunc func;
+    gpointer data;
+    WorkPoolGroup *group;
+};
+
+struct _WorkPoolWorker {
+    WorkPool *pool;
+    gint id;
+    GThread *thread;
+
+    /* the deque: tasks[top .. bottom - 1], stolen from the top */
+    GMutex *lock;
+    WorkPoolTask *tasks;
+    gint top, bottom, size;
+
+    guint32 seed;
+    guint64 steals, executed;
+};
+
+struct _WorkPool {
+    gint n_workers;
+    WorkPoolWorker *workers;
+
+    GMutex *lock;
+    GCond *cond;
+    gint generation;		/* bumped by every work_pool_run() */
+    gint active;		/* helper threads inside a run */
+    gboolean quit;
+
+    volatile gint running;
+};
+
+static gboolean work_pool_pop(WorkPoolWorker * worker, WorkPoolTask * task)
+{
+    gboolean found = FALSE;
+
+    g_mutex_lock(worker->lock);
+    if (worker->bottom > worker->top) {
+	*task = worker->tasks[--worker->bottom];
+	found = TRUE;
+    }
+    if (worker->bottom == worker->top)
+	worker->top = worker->bottom = 0;
+    g_mutex_unlock(worker->lock);
+
+    return found;
+}
+
+static gboolean work_pool_steal(WorkPoolWorker * thief, WorkPoolTask * task)
+{
+    WorkPool *pool = thief->pool;
+    gint i, victim;
+
+    if (pool->n_workers < 2)
+	return FALSE;
+
+    /* start with a random victim, so thieves don't all line up on one */
+    thief->seed = thief->seed * 1103515245 + 12345;
+    victim = (thief->seed >> 16) % pool->n_workers;
+
+    for (i = 0; i < pool->n_workers; i++, victim = (victim + 1) % pool->n_workers) {
+	WorkPoolWorker *w = &pool->workers[victim];
+	gboolean found = FALSE;
+
+	if (w == thief || w->bottom <= w->top)
+	    continue;
+
+	g_mutex_lock(w->lock);
+	if (w->bottom > w->top) {
+	    *task = w->tasks[w->top++];
+	    found = TRUE;
+	}
+	if (w->bottom == w->top)
+	    w->top = w->bottom = 0;
+	g_mutex_unlock(w->lock);
+
+	if (found) {
+	    thief->steals++;
+	    return TRUE;
+	}
+    }
+
+    return FALSE;
+}
+
+static void work_pool_execute(WorkPoolWorker * worker, WorkPoolTask * task)
+{
+    task->func(worker, task->data);
+    worker->executed++;
+
+    g_atomic_int_add(&task->group->pending, -1);
+}
+
+static gboolean work_pool_run_one(WorkPoolWorker * worker)
+{
+    WorkPoolTask task;
+
+    if (work_pool_pop(worker, &task) || work_pool_steal(worker, &task)) {
+	work_pool_execute(worker, &task);
+	return TRUE;
+    }
+
+    return FALSE;
+}
+
+static gpointer work_pool_helper(gpointer data)
+{
+    WorkPoolWorker *worker = (WorkPoolWorker *) data;
+    WorkPool *pool = worker->pool;
+    gint generation = 0;
+
+    g_mutex_lock(pool->lock);
+    for (;;) {
+	while (!pool->quit && pool->generation == generation)
+	    g_cond_wait(pool->cond, pool->lock);
+
+	if (pool->quit)
+	    break;
+
+	generation = pool->generation;
+	pool->active++;
+	g_mutex_unlock(pool->lock);
+
+	while (g_atomic_int_get(&pool->running)) {
+	    if (!work_pool_run_one(worker))
+		g_thread_yield();
+	}
+
+	g_mutex_lock(pool->lock);
+	pool->active--;
+	g_cond_broadcast(pool->cond);
+    }
+    g_mutex_unlock(pool->lock);
+
+    return NULL;
+}
+
+WorkPool *work_pool_new(gint n_workers)
+{
+    WorkPool *pool;
+    gint i;
+
+    pool = g_new0(WorkPool, 1);
+    pool->n_workers = MAX(n_workers, 1);
+    pool->workers = g_new0(WorkPoolWorker, pool->n_workers);
+    pool->lock = g_mutex_new();
+    pool->cond = g_cond_new();
+
+    for (i = 0; i < pool->n_workers; i++) {
+	WorkPoolWorker *worker = &pool->workers[i];
+
+	worker->pool = pool;
+	worker->id = i;
+	worker->lock = g_mutex_new();
+	worker->size = 64;
+	worker->tasks = g_new(WorkPoolTask, worker->size);
+	worker->seed = 0x9e3779b9 * (i + 1);
+    }
+
+    /* worker 0 is whoever calls work_pool_run() */
+    for (i = 1; i < pool->n_workers; i++) {
+	pool->workers[i].thread = g_thread_create(work_pool_helper,
+						  &pool->workers[i], TRUE,
+						  NULL);
+    }
+
+    return pool;
+}
+
+void work_pool_free(WorkPool * pool)
+{
+    gint i;
+
+    g_mutex_lock(pool->lock);
+    pool->quit = TRUE;
+    g_cond_broadcast(pool->cond);
+    g_mutex_unlock(pool->lock);
+
+    for (i = 0; i < pool->n_workers; i++) {
+	if (pool->workers[i].thread)
+	    g_thread_join(pool->workers[i].thread);
+
+	g_mutex_free(pool->workers[i].lock);
+	g_free(pool->workers[i].tasks);
+    }
+
+    g_cond_free(pool->cond);
+    g_mutex_free(pool->lock);
+    g_free(pool->workers);
+    g_free(pool);
+}
+
+/*
+ * Runs func on the calling thread, with the other workers stealing the
+ * tasks it spawns. func must sync on everything it spawns.
+ */
+void work_pool_run(WorkPool * pool, WorkPoolFunc func, gpointer data)
+{
+    gint i;
+
+    for (i = 0; i < pool->n_workers; i++)
+	pool->workers[i].steals = pool->workers[i].executed = 0;
+
+    g_mutex_lock(pool->lock);
+    pool->generation++;
+    g_atomic_int_set(&pool->running, TRUE);
+    g_cond_broadcast(pool->cond);
+    g_mutex_unlock(pool->lock);
+
+    func(&pool->workers[0], data);
+
+    g_atomic_int_set(&pool->running, FALSE);
+
+    g_mutex_lock(pool->lock);
+    while (pool->active > 0)
+	g_cond_wait(pool->cond, pool->lock);
+    g_mutex_unlock(pool->lock);
+}
+
+void work_pool_group_init(WorkPoolGroup * group)
+{
+    group->pending = 0;
+}
+
+void work_pool_spawn(WorkPoolWorker * worker, WorkPoolGroup * group,
+		     WorkPoolFunc func, gpointer data)
+{
+    WorkPoolTask *task;
+
+    g_atomic_int_add(&group->pending, 1);
+
+    g_mutex_lock(worker->lock);
+    if (worker->bottom == worker->size) {
+	if (worker->top > 0) {
+	    memmove(worker->tasks, worker->tasks + worker->top,
+		    (worker->bottom - worker->top) * sizeof(WorkPoolTask));
+	    worker->bottom -= worker->top;
+	    worker->top = 0;
+	} else {
+	    worker->size *= 2;
+	    worker->tasks = g_renew(WorkPoolTask, worker->tasks, worker->size);
+	}
+    }
+
+    task = &worker->tasks[worker->bottom++];
+    task->func = func;
+    task->data = data;
+    task->group = group;
+    g_mutex_unlock(worker->lock);
+}
+
+/* waits for every task spawned in group, running tasks meanwhile */
+void work_pool_sync(WorkPoolWorker * worker, WorkPoolGroup * group)
+{
+    while (g_atomic_int_get(&group->pending) > 0) {
+	if (!work_pool_run_one(worker))
+	    g_thread_yield();
+    }
+}
+
+gint work_pool_worker_get_id(WorkPoolWorker * worker)
+{
+    return worker->id;
+}
+
+guint64 work_pool_get_steals(WorkPool * pool)
+{
+    guint64 steals = 0;
+    gint i;
+
+    for (i = 0; i < pool->n_workers; i++)
+	steals += pool->workers[i].steals;
+
+    return steals;
+}
+
+guint64 work_pool_get_tasks(WorkPool * pool)
+{
+    guint64 tasks = 0;
+    gint i;
+
+    for (i = 0; i < pool->n_workers; i++)
+	tasks += pool->workers[i].executed;
+
+    return tasks;
+}
@@ -0,0 +1,55 @@
+/*
+ *    HardInfo - Displays System Information
+ *    Copyright (C) 2003-2007 Leandro A. F. Pereira <leandro@hardinfo.org>
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, version 2.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __WORKPOOL_H__
+#define __WORKPOOL_H__
+
+#include <glib.h>
+
+/*
+ * A small work-stealing scheduler. Each worker owns a deque: it pushes and
+ * pops tasks at the bottom, while idle workers steal from the top. Tasks
+ * are grouped so that a spawner can wait for its children (fork/join); a
+ * waiting worker keeps running tasks instead of blocking.
+ */
+
+typedef struct _WorkPool	WorkPool;
+typedef struct _WorkPoolWorker	WorkPoolWorker;
+typedef struct _WorkPoolGroup	WorkPoolGroup;
+
+typedef void (*WorkPoolFunc) (WorkPoolWorker *worker, gpointer data);
+
+struct _WorkPoolGroup {
+    volatile gint pending;
+};
+
+WorkPool	*work_pool_new(gint n_workers);
+void		 work_pool_free(WorkPool *pool);
+
+void		 work_pool_run(WorkPool *pool, WorkPoolFunc func, gpointer data);
+
+void		 work_pool_group_init(WorkPoolGroup *group);
+void		 work_pool_spawn(WorkPoolWorker *worker, WorkPoolGroup *group,
+				 WorkPoolFunc func, gpointer data);
+void		 work_pool_sync(WorkPoolWorker *worker, WorkPoolGroup *group);
+
+gint		 work_pool_worker_get_id(WorkPoolWorker *worker);
+guint64		 work_pool_get_steals(WorkPool *pool);
+guint64		 work_pool_get_tasks(WorkPool *pool);
+
+#endif	/* __WORKPOOL_H__ */